@@ -0,0 +1,700 @@
+#include "mesh_format.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/* asset_cooker : 离线网格烘焙工具
+ * Converts an OBJ mesh into the .mesh runtime layout of mesh_format.hpp:
+ * post-transform cache optimized indices, vertices reordered for fetch
+ * locality and quantized to 16 / 8 bit, grid clustered LOD chain and
+ * meshlets per LOD. Prints a JSON report with sizes, compression ratio and
+ * simulated vertex cache / fetch efficiency before and after cooking.
+ */
+
+struct cookOptions
+{
+    std::string input;
+    std::string output;
+    uint32_t maxLods = 4;             // including LOD0
+    uint32_t minLodTriangles = 64;    // stop simplifying below this
+    uint32_t meshletVertices = 64;
+    uint32_t meshletTriangles = 124;
+    uint32_t cacheSize = 32;          // optimizer cache model
+};
+
+struct sourceVertex
+{
+    float position[3];
+    float normal[3];
+    float uv[2];
+};
+
+struct sourceMesh
+{
+    std::vector<sourceVertex> vertices;
+    std::vector<uint32_t> indices;
+};
+
+struct cacheStats
+{
+    double acmr = 0.0;     // transformed vertices per triangle
+    double atvr = 0.0;     // transformed vertices per unique vertex
+    double hitRate = 0.0;  // index lookups served by the cache
+};
+
+// --- OBJ --- //
+static sourceMesh loadObj(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open mesh: " + path);
+    }
+    std::vector<std::array<float, 3>> positions, normals;
+    std::vector<std::array<float, 2>> uvs;
+    struct cornerKey
+    {
+        int position, uv, normal;
+        bool operator==(const cornerKey& other) const {
+            return position == other.position && uv == other.uv && normal == other.normal;
+        }
+    };
+    struct cornerHash
+    {
+        size_t operator()(const cornerKey& key) const {
+            return (static_cast<size_t>(key.position) * 73856093u) ^
+                   (static_cast<size_t>(key.uv) * 19349663u) ^ (static_cast<size_t>(key.normal) * 83492791u);
+        }
+    };
+    std::unordered_map<cornerKey, uint32_t, cornerHash> corners;
+    sourceMesh mesh;
+    bool hasNormals = true;
+
+    // OBJ indices are 1 based, negative ones count back from the end
+    auto resolve = [](int index, size_t count) -> int {
+        if (index > 0) return index - 1;
+        if (index < 0) return static_cast<int>(count) + index;
+        return -1;
+    };
+
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream stream(line);
+        std::string tag;
+        stream >> tag;
+        if (tag == "v") {
+            std::array<float, 3> p{};
+            stream >> p[0] >> p[1] >> p[2];
+            positions.push_back(p);
+        } else if (tag == "vn") {
+            std::array<float, 3> n{};
+            stream >> n[0] >> n[1] >> n[2];
+            normals.push_back(n);
+        } else if (tag == "vt") {
+            std::array<float, 2> t{};
+            stream >> t[0] >> t[1];
+            uvs.push_back(t);
+        } else if (tag == "f") {
+            std::vector<uint32_t> polygon;
+            std::string corner;
+            while (stream >> corner) {
+                int p = 0, t = 0, n = 0;
+                const char* cursor = corner.c_str();
+                p = std::atoi(cursor);
+                const char* slash = std::strchr(cursor, '/');
+                if (slash != nullptr) {
+                    if (slash[1] != '/') t = std::atoi(slash + 1);
+                    const char* second = std::strchr(slash + 1, '/');
+                    if (second != nullptr) n = std::atoi(second + 1);
+                }
+                cornerKey key{resolve(p, positions.size()), resolve(t, uvs.size()), resolve(n, normals.size())};
+                // a uv / normal index that is given (not 0) has to exist as well
+                if (key.position < 0 || key.position >= static_cast<int>(positions.size()) ||
+                    (t != 0 && (key.uv < 0 || key.uv >= static_cast<int>(uvs.size()))) ||
+                    (n != 0 && (key.normal < 0 || key.normal >= static_cast<int>(normals.size())))) {
+                    throw std::runtime_error("Invalid face index in " + path + ": " + line);
+                }
+                hasNormals = hasNormals && key.normal >= 0;
+                auto found = corners.find(key);
+                if (found == corners.end()) {
+                    sourceVertex vertex{};
+                    std::copy_n(positions[key.position].data(), 3, vertex.position);
+                    if (key.normal >= 0) std::copy_n(normals[key.normal].data(), 3, vertex.normal);
+                    if (key.uv >= 0) std::copy_n(uvs[key.uv].data(), 2, vertex.uv);
+                    found = corners.emplace(key, static_cast<uint32_t>(mesh.vertices.size())).first;
+                    mesh.vertices.push_back(vertex);
+                }
+                polygon.push_back(found->second);
+            }
+            for (size_t i = 2; i < polygon.size(); ++i) { // fan triangulation
+                mesh.indices.insert(mesh.indices.end(), {polygon[0], polygon[i - 1], polygon[i]});
+            }
+        }
+    }
+    if (mesh.indices.empty()) {
+        throw std::runtime_error("Mesh has no faces: " + path);
+    }
+
+    if (!hasNormals) {
+        // some corners have no normal : area weighted smooth normals for the whole mesh
+        for (sourceVertex& vertex : mesh.vertices) {
+            std::fill_n(vertex.normal, 3, 0.f);
+        }
+        for (size_t i = 0; i < mesh.indices.size(); i += 3) {
+            const float* a = mesh.vertices[mesh.indices[i]].position;
+            const float* b = mesh.vertices[mesh.indices[i + 1]].position;
+            const float* c = mesh.vertices[mesh.indices[i + 2]].position;
+            float e1[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+            float e2[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+            float n[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]};
+            for (size_t k = 0; k < 3; ++k) {
+                float* target = mesh.vertices[mesh.indices[i + k]].normal;
+                target[0] += n[0];
+                target[1] += n[1];
+                target[2] += n[2];
+            }
+        }
+    }
+    for (sourceVertex& vertex : mesh.vertices) {
+        float* n = vertex.normal;
+        float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if (length > 0.f) {
+            n[0] /= length;
+            n[1] /= length;
+            n[2] /= length;
+        } else {
+            n[2] = 1.f;
+        }
+    }
+    return mesh;
+}
+
+// --- Analysis --- //
+// FIFO post-transform cache, the model most hardware is closest to
+static cacheStats analyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize) {
+    std::vector<uint32_t> timestamps(vertexCount, 0);
+    uint32_t time = cacheSize + 1;
+    size_t misses = 0;
+    for (uint32_t index : indices) {
+        if (time - timestamps[index] > cacheSize) {
+            timestamps[index] = time++;
+            ++misses;
+        }
+    }
+    cacheStats stats;
+    stats.acmr = static_cast<double>(misses) / static_cast<double>(indices.size() / 3);
+    stats.atvr = static_cast<double>(misses) / static_cast<double>(vertexCount);
+    stats.hitRate = 1.0 - static_cast<double>(misses) / static_cast<double>(indices.size());
+    return stats;
+}
+
+// bytes pulled through a small FIFO of 64 byte lines / bytes of the vertex buffer
+static double analyzeVertexFetch(const std::vector<uint32_t>& indices, size_t vertexCount, size_t stride) {
+    constexpr size_t lineSize = 64;
+    constexpr uint32_t lineCount = 64;
+    std::vector<uint32_t> timestamps((vertexCount * stride + lineSize - 1) / lineSize + 1, 0);
+    uint32_t time = lineCount + 1;
+    size_t fetched = 0;
+    for (uint32_t index : indices) {
+        size_t first = index * stride / lineSize;
+        size_t last = (index * stride + stride - 1) / lineSize;
+        for (size_t line = first; line <= last; ++line) {
+            if (time - timestamps[line] > lineCount) {
+                timestamps[line] = time++;
+                fetched += lineSize;
+            }
+        }
+    }
+    return static_cast<double>(fetched) / static_cast<double>(vertexCount * stride);
+}
+
+// --- Vertex cache optimization (Forsyth, linear speed) --- //
+static float vertexScore(int cachePosition, uint32_t liveTriangles, uint32_t cacheSize) {
+    if (liveTriangles == 0) {
+        return -1.f;
+    }
+    float score = 0.f;
+    if (cachePosition >= 0) {
+        if (cachePosition < 3) {
+            score = 0.75f; // the last triangle's vertices, no bonus for reusing them immediately
+        } else {
+            float scaled = 1.f - static_cast<float>(cachePosition - 3) / static_cast<float>(cacheSize - 3);
+            score = std::pow(scaled, 1.5f);
+        }
+    }
+    return score + 2.f / std::sqrt(static_cast<float>(liveTriangles)); // favor finishing lonely vertices
+}
+
+static std::vector<uint32_t> optimizeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount,
+                                                 uint32_t cacheSize) {
+    const size_t triangleCount = indices.size() / 3;
+    std::vector<uint32_t> liveTriangles(vertexCount, 0);
+    for (uint32_t index : indices) {
+        ++liveTriangles[index];
+    }
+    std::vector<uint32_t> adjacencyOffset(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        adjacencyOffset[v + 1] = adjacencyOffset[v] + liveTriangles[v];
+    }
+    std::vector<uint32_t> adjacency(indices.size());
+    std::vector<uint32_t> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+    for (size_t i = 0; i < indices.size(); ++i) {
+        adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> scores(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        scores[v] = vertexScore(-1, liveTriangles[v], cacheSize);
+    }
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<uint32_t> cache, nextCache;
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+
+    size_t cursor = 0;   // fallback scan position for disconnected parts
+    int64_t best = -1;
+    for (size_t done = 0; done < triangleCount; ++done) {
+        if (best < 0) {
+            while (emitted[cursor]) ++cursor;
+            best = static_cast<int64_t>(cursor);
+        }
+        const uint32_t* triangle = &indices[best * 3];
+        emitted[best] = true;
+        result.insert(result.end(), triangle, triangle + 3);
+
+        // emitted vertices move to the front, the rest is pushed back
+        nextCache.assign(triangle, triangle + 3);
+        for (uint32_t v : cache) {
+            if (v != triangle[0] && v != triangle[1] && v != triangle[2]) {
+                nextCache.push_back(v);
+            }
+        }
+        for (size_t k = 0; k < 3; ++k) {
+            uint32_t v = triangle[k];
+            uint32_t* begin = &adjacency[adjacencyOffset[v]];
+            uint32_t* end = begin + liveTriangles[v];
+            std::swap(*std::find(begin, end, static_cast<uint32_t>(best)), *(end - 1));
+            --liveTriangles[v];
+        }
+        for (size_t position = cacheSize; position < nextCache.size(); ++position) {
+            cachePosition[nextCache[position]] = -1;
+            scores[nextCache[position]] = vertexScore(-1, liveTriangles[nextCache[position]], cacheSize);
+        }
+        if (nextCache.size() > cacheSize) {
+            nextCache.resize(cacheSize);
+        }
+        cache.swap(nextCache);
+
+        // rescore the cache and pick the best triangle touching it
+        best = -1;
+        float bestScore = -1.f;
+        for (size_t position = 0; position < cache.size(); ++position) {
+            uint32_t v = cache[position];
+            cachePosition[v] = static_cast<int>(position);
+            scores[v] = vertexScore(static_cast<int>(position), liveTriangles[v], cacheSize);
+        }
+        for (uint32_t v : cache) {
+            for (uint32_t a = 0; a < liveTriangles[v]; ++a) {
+                uint32_t t = adjacency[adjacencyOffset[v] + a];
+                float score = scores[indices[t * 3]] + scores[indices[t * 3 + 1]] + scores[indices[t * 3 + 2]];
+                if (score > bestScore) {
+                    bestScore = score;
+                    best = t;
+                }
+            }
+        }
+    }
+    return result;
+}
+
+// vertices in order of first use, the index stream then walks the vertex buffer forward
+static std::vector<uint32_t> fetchRemap(const std::vector<uint32_t>& indices, size_t vertexCount) {
+    std::vector<uint32_t> remap(vertexCount, UINT32_MAX);
+    uint32_t next = 0;
+    for (uint32_t index : indices) {
+        if (remap[index] == UINT32_MAX) {
+            remap[index] = next++;
+        }
+    }
+    for (uint32_t& target : remap) {
+        if (target == UINT32_MAX) target = next++; // unreferenced vertices go last
+    }
+    return remap;
+}
+
+// --- LOD --- //
+/* Vertex clustering on a uniform grid: every vertex snaps to the vertex closest
+ * to the mean of its cell, collapsed and duplicate triangles are dropped. The
+ * result indexes the original vertex array, so all LODs share one vertex buffer.
+ */
+static std::vector<uint32_t> clusterLod(const sourceMesh& mesh, const std::vector<uint32_t>& indices,
+                                        const float boundsMin[3], float cellSize) {
+    auto cellOf = [&](const float* p) {
+        uint64_t x = static_cast<uint64_t>((p[0] - boundsMin[0]) / cellSize);
+        uint64_t y = static_cast<uint64_t>((p[1] - boundsMin[1]) / cellSize);
+        uint64_t z = static_cast<uint64_t>((p[2] - boundsMin[2]) / cellSize);
+        return (x << 42) | (y << 21) | z;
+    };
+    struct cell
+    {
+        double sum[3] = {0.0, 0.0, 0.0};
+        uint32_t count = 0;
+        uint32_t representative = UINT32_MAX;
+        float distance = 0.f;
+    };
+    std::unordered_map<uint64_t, cell> cells;
+    std::vector<uint64_t> vertexCell(mesh.vertices.size(), 0);
+    std::vector<bool> used(mesh.vertices.size(), false);
+    for (uint32_t index : indices) {
+        used[index] = true;
+    }
+    for (uint32_t v = 0; v < mesh.vertices.size(); ++v) {
+        if (!used[v]) continue;
+        const float* p = mesh.vertices[v].position;
+        vertexCell[v] = cellOf(p);
+        cell& target = cells[vertexCell[v]];
+        for (int k = 0; k < 3; ++k) target.sum[k] += p[k];
+        ++target.count;
+    }
+    for (uint32_t v = 0; v < mesh.vertices.size(); ++v) {
+        if (!used[v]) continue;
+        cell& target = cells[vertexCell[v]];
+        const float* p = mesh.vertices[v].position;
+        float distance = 0.f;
+        for (int k = 0; k < 3; ++k) {
+            float d = p[k] - static_cast<float>(target.sum[k] / target.count);
+            distance += d * d;
+        }
+        if (target.representative == UINT32_MAX || distance < target.distance) {
+            target.representative = v;
+            target.distance = distance;
+        }
+    }
+
+    std::vector<uint32_t> result;
+    std::unordered_set<std::string> seen;
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        uint32_t a = cells[vertexCell[indices[i]]].representative;
+        uint32_t b = cells[vertexCell[indices[i + 1]]].representative;
+        uint32_t c = cells[vertexCell[indices[i + 2]]].representative;
+        if (a == b || b == c || a == c) {
+            continue;
+        }
+        // same triangle with any rotation is a duplicate, winding is kept
+        uint32_t rotated[3] = {a, b, c};
+        std::rotate(rotated, std::min_element(rotated, rotated + 3), rotated + 3);
+        std::string key(reinterpret_cast<const char*>(rotated), sizeof(rotated));
+        if (!seen.insert(key).second) {
+            continue;
+        }
+        result.insert(result.end(), {a, b, c});
+    }
+    return result;
+}
+
+// --- Meshlets --- //
+static void buildMeshlets(const sourceMesh& mesh, const std::vector<uint32_t>& indices, const cookOptions& options,
+                          std::vector<cookedMeshlet>& meshlets, std::vector<uint32_t>& meshletVertices,
+                          std::vector<uint8_t>& meshletTriangles) {
+    std::vector<uint8_t> local(mesh.vertices.size(), 0xff);
+    cookedMeshlet current{};
+    current.vertexOffset = static_cast<uint32_t>(meshletVertices.size());
+    current.triangleOffset = static_cast<uint32_t>(meshletTriangles.size());
+
+    auto flush = [&]() {
+        if (current.triangleCount == 0) return;
+        // bounding sphere : AABB center, farthest vertex
+        float lo[3] = {INFINITY, INFINITY, INFINITY}, hi[3] = {-INFINITY, -INFINITY, -INFINITY};
+        for (uint32_t i = 0; i < current.vertexCount; ++i) {
+            const float* p = mesh.vertices[meshletVertices[current.vertexOffset + i]].position;
+            for (int k = 0; k < 3; ++k) {
+                lo[k] = std::min(lo[k], p[k]);
+                hi[k] = std::max(hi[k], p[k]);
+            }
+        }
+        float radius = 0.f;
+        for (int k = 0; k < 3; ++k) current.center[k] = (lo[k] + hi[k]) * 0.5f;
+        for (uint32_t i = 0; i < current.vertexCount; ++i) {
+            uint32_t v = meshletVertices[current.vertexOffset + i];
+            const float* p = mesh.vertices[v].position;
+            float dx = p[0] - current.center[0], dy = p[1] - current.center[1], dz = p[2] - current.center[2];
+            radius = std::max(radius, std::sqrt(dx * dx + dy * dy + dz * dz));
+            local[v] = 0xff;
+        }
+        current.radius = radius;
+        meshlets.push_back(current);
+        while (meshletTriangles.size() % 4 != 0) meshletTriangles.push_back(0); // 4 byte aligned triangle runs
+
+        current = {};
+        current.vertexOffset = static_cast<uint32_t>(meshletVertices.size());
+        current.triangleOffset = static_cast<uint32_t>(meshletTriangles.size());
+    };
+
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        uint32_t extra = 0;
+        for (size_t k = 0; k < 3; ++k) {
+            if (local[indices[i + k]] == 0xff) ++extra;
+        }
+        if (current.vertexCount + extra > options.meshletVertices ||
+            current.triangleCount + 1u > options.meshletTriangles) {
+            flush();
+        }
+        for (size_t k = 0; k < 3; ++k) {
+            uint32_t v = indices[i + k];
+            if (local[v] == 0xff) {
+                local[v] = current.vertexCount++;
+                meshletVertices.push_back(v);
+            }
+            meshletTriangles.push_back(local[v]);
+        }
+        ++current.triangleCount;
+    }
+    flush();
+}
+
+// --- Quantization --- //
+static uint16_t quantizeUnorm16(float value, float lo, float hi) {
+    float range = hi - lo;
+    float normalized = range > 0.f ? (value - lo) / range : 0.f;
+    return static_cast<uint16_t>(std::lround(std::clamp(normalized, 0.f, 1.f) * 65535.f));
+}
+
+static void encodeOctahedral(const float n[3], int8_t out[2]) {
+    float sum = std::abs(n[0]) + std::abs(n[1]) + std::abs(n[2]);
+    float x = n[0] / sum, y = n[1] / sum;
+    if (n[2] < 0.f) {
+        float wrappedX = (1.f - std::abs(y)) * (x >= 0.f ? 1.f : -1.f);
+        float wrappedY = (1.f - std::abs(x)) * (y >= 0.f ? 1.f : -1.f);
+        x = wrappedX;
+        y = wrappedY;
+    }
+    out[0] = static_cast<int8_t>(std::lround(std::clamp(x, -1.f, 1.f) * 127.f));
+    out[1] = static_cast<int8_t>(std::lround(std::clamp(y, -1.f, 1.f) * 127.f));
+}
+
+static uint64_t alignSection(uint64_t offset) {
+    return (offset + cookedMeshAlignment - 1) & ~static_cast<uint64_t>(cookedMeshAlignment - 1);
+}
+
+// --- Cook --- //
+static std::string cook(const cookOptions& options) {
+    sourceMesh mesh = loadObj(options.input);
+    const size_t vertexCount = mesh.vertices.size();
+
+    cookedMeshHeader header{};
+    header.magic = cookedMeshMagic;
+    header.version = cookedMeshVersion;
+    for (int k = 0; k < 3; ++k) {
+        header.boundsMin[k] = INFINITY;
+        header.boundsMax[k] = -INFINITY;
+    }
+    for (int k = 0; k < 2; ++k) {
+        header.uvMin[k] = INFINITY;
+        header.uvMax[k] = -INFINITY;
+    }
+    for (const sourceVertex& vertex : mesh.vertices) {
+        for (int k = 0; k < 3; ++k) {
+            header.boundsMin[k] = std::min(header.boundsMin[k], vertex.position[k]);
+            header.boundsMax[k] = std::max(header.boundsMax[k], vertex.position[k]);
+        }
+        for (int k = 0; k < 2; ++k) {
+            header.uvMin[k] = std::min(header.uvMin[k], vertex.uv[k]);
+            header.uvMax[k] = std::max(header.uvMax[k], vertex.uv[k]);
+        }
+    }
+
+    cacheStats cacheBefore = analyzeVertexCache(mesh.indices, vertexCount, 16);
+    double fetchBefore = analyzeVertexFetch(mesh.indices, vertexCount, sizeof(sourceVertex));
+
+    // LOD chain, every level at least 25% smaller than the previous one
+    std::vector<std::vector<uint32_t>> lods = {mesh.indices};
+    std::vector<float> lodErrors = {0.f};
+    float extent = std::max({header.boundsMax[0] - header.boundsMin[0], header.boundsMax[1] - header.boundsMin[1],
+                             header.boundsMax[2] - header.boundsMin[2], 1e-6f});
+    for (uint32_t resolution = 256; resolution >= 2 && lods.size() < options.maxLods; resolution /= 2) {
+        const std::vector<uint32_t>& previous = lods.back();
+        if (previous.size() / 3 <= options.minLodTriangles) {
+            break;
+        }
+        float cellSize = extent / static_cast<float>(resolution) * 1.0001f;
+        std::vector<uint32_t> simplified = clusterLod(mesh, mesh.indices, header.boundsMin, cellSize);
+        if (simplified.empty() || simplified.size() > previous.size() * 3 / 4) {
+            continue;
+        }
+        lods.push_back(std::move(simplified));
+        lodErrors.push_back(cellSize);
+    }
+
+    for (std::vector<uint32_t>& lod : lods) {
+        lod = optimizeVertexCache(lod, vertexCount, options.cacheSize);
+    }
+
+    // one vertex order for every LOD, LOD0 decides it
+    std::vector<uint32_t> concatenated;
+    for (const std::vector<uint32_t>& lod : lods) {
+        concatenated.insert(concatenated.end(), lod.begin(), lod.end());
+    }
+    std::vector<uint32_t> remap = fetchRemap(concatenated, vertexCount);
+    sourceMesh ordered;
+    ordered.vertices.resize(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        ordered.vertices[remap[v]] = mesh.vertices[v];
+    }
+    for (std::vector<uint32_t>& lod : lods) {
+        for (uint32_t& index : lod) index = remap[index];
+    }
+    cacheStats cacheAfter = analyzeVertexCache(lods[0], vertexCount, 16);
+    double fetchAfter = analyzeVertexFetch(lods[0], vertexCount, sizeof(cookedVertex));
+
+    std::vector<cookedLod> lodTable;
+    std::vector<uint32_t> indices;
+    std::vector<cookedMeshlet> meshlets;
+    std::vector<uint32_t> meshletVertices;
+    std::vector<uint8_t> meshletTriangles;
+    for (size_t level = 0; level < lods.size(); ++level) {
+        cookedLod lod{};
+        lod.indexOffset = static_cast<uint32_t>(indices.size());
+        lod.indexCount = static_cast<uint32_t>(lods[level].size());
+        lod.meshletOffset = static_cast<uint32_t>(meshlets.size());
+        lod.error = lodErrors[level];
+        indices.insert(indices.end(), lods[level].begin(), lods[level].end());
+        buildMeshlets(ordered, lods[level], options, meshlets, meshletVertices, meshletTriangles);
+        lod.meshletCount = static_cast<uint32_t>(meshlets.size()) - lod.meshletOffset;
+        lodTable.push_back(lod);
+    }
+
+    std::vector<cookedVertex> vertices(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        const sourceVertex& source = ordered.vertices[v];
+        cookedVertex& target = vertices[v];
+        for (int k = 0; k < 3; ++k) {
+            target.position[k] = quantizeUnorm16(source.position[k], header.boundsMin[k], header.boundsMax[k]);
+        }
+        for (int k = 0; k < 2; ++k) {
+            target.uv[k] = quantizeUnorm16(source.uv[k], header.uvMin[k], header.uvMax[k]);
+        }
+        encodeOctahedral(source.normal, target.normal);
+    }
+
+    // --- Layout --- //
+    header.indexSize = vertexCount <= 0xffff ? 2 : 4;
+    header.lodCount = static_cast<uint32_t>(lodTable.size());
+    header.vertexCount = static_cast<uint32_t>(vertexCount);
+    header.indexCount = static_cast<uint32_t>(indices.size());
+    header.meshletCount = static_cast<uint32_t>(meshlets.size());
+    header.meshletVertexCount = static_cast<uint32_t>(meshletVertices.size());
+    header.meshletTriangleBytes = static_cast<uint32_t>(meshletTriangles.size());
+    uint64_t offset = sizeof(cookedMeshHeader);
+    header.vertexOffset = offset;
+    offset = alignSection(offset + vertices.size() * sizeof(cookedVertex));
+    header.indexOffset = offset;
+    offset = alignSection(offset + indices.size() * header.indexSize);
+    header.lodOffset = offset;
+    offset = alignSection(offset + lodTable.size() * sizeof(cookedLod));
+    header.meshletOffset = offset;
+    offset = alignSection(offset + meshlets.size() * sizeof(cookedMeshlet));
+    header.meshletVertexOffset = offset;
+    offset = alignSection(offset + meshletVertices.size() * sizeof(uint32_t));
+    header.meshletTriangleOffset = offset;
+    offset = alignSection(offset + meshletTriangles.size());
+    header.fileSize = offset;
+
+    std::vector<uint8_t> blob(header.fileSize, 0);
+    std::memcpy(blob.data(), &header, sizeof(header));
+    std::memcpy(blob.data() + header.vertexOffset, vertices.data(), vertices.size() * sizeof(cookedVertex));
+    if (header.indexSize == 2) {
+        uint16_t* target = reinterpret_cast<uint16_t*>(blob.data() + header.indexOffset);
+        for (size_t i = 0; i < indices.size(); ++i) target[i] = static_cast<uint16_t>(indices[i]);
+    } else {
+        std::memcpy(blob.data() + header.indexOffset, indices.data(), indices.size() * sizeof(uint32_t));
+    }
+    std::memcpy(blob.data() + header.lodOffset, lodTable.data(), lodTable.size() * sizeof(cookedLod));
+    std::memcpy(blob.data() + header.meshletOffset, meshlets.data(), meshlets.size() * sizeof(cookedMeshlet));
+    std::memcpy(blob.data() + header.meshletVertexOffset, meshletVertices.data(),
+                meshletVertices.size() * sizeof(uint32_t));
+    std::memcpy(blob.data() + header.meshletTriangleOffset, meshletTriangles.data(), meshletTriangles.size());
+
+    std::ofstream file(options.output, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open output: " + options.output);
+    }
+    file.write(reinterpret_cast<const char*>(blob.data()), static_cast<std::streamsize>(blob.size()));
+
+    // --- Report --- //
+    // compression : LOD0 vertex + index bytes against the float / uint32 layout it replaces
+    uint64_t sourceBytes = vertexCount * sizeof(sourceVertex) + mesh.indices.size() * sizeof(uint32_t);
+    uint64_t cookedBytes = vertexCount * sizeof(cookedVertex) + lods[0].size() * header.indexSize;
+    std::ostringstream json;
+    json << "{\"input\": \"" << options.input << "\", \"output\": \"" << options.output << "\""
+         << ", \"vertices\": " << vertexCount << ", \"triangles\": " << mesh.indices.size() / 3
+         << ", \"source_bytes\": " << sourceBytes << ", \"cooked_bytes\": " << cookedBytes
+         << ", \"compression_ratio\": " << static_cast<double>(sourceBytes) / static_cast<double>(cookedBytes)
+         << ", \"file_bytes\": " << header.fileSize
+         << ", \"vertex_cache\": {\"before\": {\"acmr\": " << cacheBefore.acmr << ", \"atvr\": " << cacheBefore.atvr
+         << ", \"hit_rate\": " << cacheBefore.hitRate << "}, \"after\": {\"acmr\": " << cacheAfter.acmr
+         << ", \"atvr\": " << cacheAfter.atvr << ", \"hit_rate\": " << cacheAfter.hitRate << "}}"
+         << ", \"vertex_fetch_overfetch\": {\"before\": " << fetchBefore << ", \"after\": " << fetchAfter << "}"
+         << ", \"meshlets\": " << meshlets.size() << ", \"lods\": [";
+    for (size_t level = 0; level < lodTable.size(); ++level) {
+        json << (level ? ", " : "") << "{\"triangles\": " << lodTable[level].indexCount / 3
+             << ", \"meshlets\": " << lodTable[level].meshletCount << ", \"error\": " << lodTable[level].error << "}";
+    }
+    json << "]}";
+    return json.str();
+}
+
+static void printUsage() {
+    std::cout << "usage: asset_cooker [--lods N] [--min-lod-triangles N] [--meshlet-vertices N]\n"
+                 "                    [--meshlet-triangles N] [--cache-size N] input.obj output.mesh" << std::endl;
+}
+
+static cookOptions parseOptions(int argc, char** argv) {
+    cookOptions options{};
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> uint32_t {
+            if (i + 1 >= argc) {
+                throw std::runtime_error("Missing value for " + arg);
+            }
+            return static_cast<uint32_t>(std::stoul(argv[++i]));
+        };
+        if (arg == "--lods") options.maxLods = std::max(value(), 1u);
+        else if (arg == "--min-lod-triangles") options.minLodTriangles = value();
+        else if (arg == "--meshlet-vertices") options.meshletVertices = std::clamp(value(), 3u, 255u);
+        else if (arg == "--meshlet-triangles") options.meshletTriangles = std::clamp(value(), 1u, 255u);
+        else if (arg == "--cache-size") options.cacheSize = std::max(value(), 4u);
+        else if (arg == "--help" || arg == "-h") {
+            printUsage();
+            std::exit(0);
+        }
+        else if (!arg.empty() && arg[0] == '-') throw std::runtime_error("Unknown argument: " + arg);
+        else positional.push_back(arg);
+    }
+    if (positional.size() != 2) {
+        printUsage();
+        throw std::runtime_error("Expected an input and an output path");
+    }
+    options.input = positional[0];
+    options.output = positional[1];
+    return options;
+}
+
+int main(int argc, char** argv) {
+    try {
+        std::cout << cook(parseOptions(argc, argv)) << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "asset_cooker: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,521 @@
+#include "asset_pack.hpp"
+#include "job_system.hpp"
+#include "lz4_block.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <cerrno>
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+#ifdef __linux__
+    #include <linux/io_uring.h>
+    #include <sys/syscall.h>
+#endif
+
+namespace {
+
+constexpr uint64_t mergeGap = 64 * 1024;            // read through holes smaller than this
+constexpr uint64_t maxReadSize = 4 * 1024 * 1024;   // one request
+constexpr unsigned ringDepth = 32;                  // requests in flight
+constexpr uint32_t decodeGrain = 4;                 // blocks per job
+
+// [offset, offset + size) of the file into destination
+struct ioRange
+{
+    uint64_t offset;
+    uint64_t size;
+    uint8_t* destination;
+};
+
+// end <= limit without overflowing
+bool fits(uint64_t offset, uint64_t size, uint64_t limit) {
+    return offset <= limit && size <= limit - offset;
+}
+
+} // namespace
+
+// --- io_uring --- //
+#ifdef __linux__
+// the kernel interface without liburing : three mapped rings, two syscalls
+struct AssetPack::IoRing
+{
+    int fd = -1;
+    void* sqRing = MAP_FAILED;
+    void* cqRing = MAP_FAILED;
+    void* sqeArray = MAP_FAILED;
+    size_t sqRingBytes = 0;
+    size_t cqRingBytes = 0;
+    size_t sqeBytes = 0;
+    unsigned* sqTail = nullptr;
+    unsigned sqMask = 0;
+    unsigned* sqIndices = nullptr;
+    io_uring_sqe* sqes = nullptr;
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned cqMask = 0;
+    io_uring_cqe* cqes = nullptr;
+
+    bool init(unsigned depth) {
+        io_uring_params params{};
+        fd = static_cast<int>(syscall(__NR_io_uring_setup, depth, &params));
+        // IORING_OP_READ is 5.6, FAST_POLL (5.7) is the closest feature bit
+        if (fd < 0 || !(params.features & IORING_FEAT_FAST_POLL)) {
+            return false;
+        }
+        sqRingBytes = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingBytes = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        sqeBytes = params.sq_entries * sizeof(io_uring_sqe);
+        sqRing = mmap(nullptr, sqRingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        cqRing = mmap(nullptr, cqRingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        sqeArray = mmap(nullptr, sqeBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+        if (sqRing == MAP_FAILED || cqRing == MAP_FAILED || sqeArray == MAP_FAILED) {
+            return false;
+        }
+        auto at = [](void* ring, uint32_t offset) {
+            return reinterpret_cast<unsigned*>(static_cast<uint8_t*>(ring) + offset);
+        };
+        sqTail = at(sqRing, params.sq_off.tail);
+        sqMask = *at(sqRing, params.sq_off.ring_mask);
+        sqIndices = at(sqRing, params.sq_off.array);
+        sqes = static_cast<io_uring_sqe*>(sqeArray);
+        cqHead = at(cqRing, params.cq_off.head);
+        cqTail = at(cqRing, params.cq_off.tail);
+        cqMask = *at(cqRing, params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(static_cast<uint8_t*>(cqRing) + params.cq_off.cqes);
+        return true;
+    }
+
+    ~IoRing() {
+        if (sqeArray != MAP_FAILED) munmap(sqeArray, sqeBytes);
+        if (cqRing != MAP_FAILED) munmap(cqRing, cqRingBytes);
+        if (sqRing != MAP_FAILED) munmap(sqRing, sqRingBytes);
+        if (fd >= 0) ::close(fd);
+    }
+
+    // the caller keeps at most `depth` requests in flight, the queue never overflows
+    void push(int file, const ioRange& range, uint64_t userData) {
+        unsigned tail = *sqTail;    // only this thread writes the tail
+        unsigned index = tail & sqMask;
+        io_uring_sqe& sqe = sqes[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_READ;
+        sqe.fd = file;
+        sqe.addr = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(range.destination));
+        sqe.len = static_cast<uint32_t>(range.size);
+        sqe.off = range.offset;
+        sqe.user_data = userData;
+        sqIndices[index] = index;
+        std::atomic_ref<unsigned>(*sqTail).store(tail + 1, std::memory_order_release);
+    }
+
+    // submits `count` queued requests, blocks until at least one completed
+    void enter(unsigned count) {
+        while (true) {
+            long submitted = syscall(__NR_io_uring_enter, fd, count, 1u, IORING_ENTER_GETEVENTS, nullptr, 0);
+            if (submitted >= 0) {
+                count -= static_cast<unsigned>(submitted);
+                if (count == 0) return;
+            } else if (errno != EINTR && errno != EAGAIN) {
+                throw std::runtime_error("io_uring_enter failed: " + std::string(std::strerror(errno)));
+            }
+        }
+    }
+
+    bool pop(uint64_t& userData, int& result) {
+        unsigned head = *cqHead;    // only this thread writes the head
+        if (head == std::atomic_ref<unsigned>(*cqTail).load(std::memory_order_acquire)) {
+            return false;
+        }
+        const io_uring_cqe& cqe = cqes[head & cqMask];
+        userData = cqe.user_data;
+        result = cqe.res;
+        std::atomic_ref<unsigned>(*cqHead).store(head + 1, std::memory_order_release);
+        return true;
+    }
+};
+#else
+struct AssetPack::IoRing {};
+#endif
+
+// --- Open / close --- //
+AssetPack::AssetPack() = default;
+
+AssetPack::~AssetPack() {
+    close();
+}
+
+bool AssetPack::open(const std::string& packPath, bool useIoUring) {
+    close();
+    path = packPath;
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        DWORD error = GetLastError();
+        if (error == ERROR_FILE_NOT_FOUND || error == ERROR_PATH_NOT_FOUND) return false;
+        throw std::runtime_error("Failed to open asset pack: " + path);
+    }
+    file = handle;
+    LARGE_INTEGER size{};
+    GetFileSizeEx(handle, &size);
+    mappingSize = static_cast<uint64_t>(size.QuadPart);
+    if (mappingSize > 0) {
+        fileMapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (fileMapping != nullptr) {
+            mapping = static_cast<const uint8_t*>(MapViewOfFile(fileMapping, FILE_MAP_READ, 0, 0, 0));
+        }
+    }
+#else
+    file = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file < 0) {
+        if (errno == ENOENT) return false;
+        throw std::runtime_error("Failed to open asset pack: " + path);
+    }
+    struct stat info{};
+    fstat(file, &info);
+    mappingSize = static_cast<uint64_t>(info.st_size);
+    if (mappingSize > 0) {
+        void* mapped = mmap(nullptr, mappingSize, PROT_READ, MAP_PRIVATE, file, 0);
+        mapping = mapped == MAP_FAILED ? nullptr : static_cast<const uint8_t*>(mapped);
+    }
+#endif
+    if (mapping == nullptr) {
+        close();
+        throw std::runtime_error("Failed to map asset pack: " + path);
+    }
+
+    header = reinterpret_cast<const assetPackHeader*>(mapping);
+    try {
+        validate();
+    } catch (...) {
+        close();
+        throw;
+    }
+    table = reinterpret_cast<const assetPackEntry*>(mapping + header->entryOffset);
+    blocks = reinterpret_cast<const assetPackBlock*>(mapping + header->blockOffset);
+    names = reinterpret_cast<const char*>(mapping + header->nameOffset);
+    counters = {};
+
+#ifdef __linux__
+    if (useIoUring) {
+        ring = std::make_unique<IoRing>();
+        if (!ring->init(ringDepth)) {
+            ring.reset();   // ENOSYS / EPERM : mapped reads
+        }
+    }
+#else
+    (void)useIoUring;
+#endif
+    return true;
+}
+
+void AssetPack::close() {
+    ring.reset();
+#ifdef _WIN32
+    if (mapping != nullptr) UnmapViewOfFile(mapping);
+    if (fileMapping != nullptr) CloseHandle(fileMapping);
+    if (file != nullptr) CloseHandle(file);
+    fileMapping = nullptr;
+    file = nullptr;
+#else
+    if (mapping != nullptr) munmap(const_cast<uint8_t*>(mapping), mappingSize);
+    if (file >= 0) ::close(file);
+    file = -1;
+#endif
+    mapping = nullptr;
+    mappingSize = 0;
+    header = nullptr;
+    table = nullptr;
+    blocks = nullptr;
+    names = nullptr;
+}
+
+// every offset / size checked once here, reads trust the tables afterwards
+void AssetPack::validate() const {
+    auto corrupt = [this](const char* what) {
+        return std::runtime_error("Corrupt asset pack (" + std::string(what) + "): " + path);
+    };
+    if (mappingSize < sizeof(assetPackHeader) || header->magic != assetPackMagic) throw corrupt("magic");
+    if (header->version != assetPackVersion) throw corrupt("version");
+    if (header->fileSize != mappingSize) throw corrupt("size");
+    if (header->blockSize == 0 || header->blockSize > assetPackBlockSize) throw corrupt("block size");
+    if (header->entryOffset % alignof(assetPackEntry) || header->blockOffset % alignof(assetPackBlock) ||
+        !fits(header->entryOffset, uint64_t(header->entryCount) * sizeof(assetPackEntry), mappingSize) ||
+        !fits(header->blockOffset, uint64_t(header->blockCount) * sizeof(assetPackBlock), mappingSize) ||
+        !fits(header->nameOffset, header->nameBytes, mappingSize)) {
+        throw corrupt("tables");
+    }
+
+    auto* entryTable = reinterpret_cast<const assetPackEntry*>(mapping + header->entryOffset);
+    auto* blockTable = reinterpret_cast<const assetPackBlock*>(mapping + header->blockOffset);
+    auto* nameTable = reinterpret_cast<const char*>(mapping + header->nameOffset);
+    for (uint32_t i = 0; i < header->entryCount; ++i) {
+        const assetPackEntry& entry = entryTable[i];
+        if (!fits(entry.nameOffset, entry.nameLength, header->nameBytes)) throw corrupt("name");
+        if (!fits(entry.dataOffset, entry.storedSize, mappingSize)) throw corrupt("data");
+        std::string_view entryName(nameTable + entry.nameOffset, entry.nameLength);
+        if (i > 0) {
+            const assetPackEntry& previous = entryTable[i - 1];
+            std::string_view previousName(nameTable + previous.nameOffset, previous.nameLength);
+            if (!assetEntryLess(previous.nameHash, previousName, entry.nameHash, entryName)) throw corrupt("order");
+        }
+        if (entry.blockCount == 0) {
+            if (entry.storedSize != entry.size) throw corrupt("stored size");
+            continue;
+        }
+        if (!fits(entry.firstBlock, entry.blockCount, header->blockCount)) throw corrupt("blocks");
+        uint64_t raw = 0;
+        for (uint32_t b = entry.firstBlock; b < entry.firstBlock + entry.blockCount; ++b) {
+            const assetPackBlock& block = blockTable[b];
+            if (block.rawSize == 0 || block.rawSize > header->blockSize || block.storedSize > block.rawSize ||
+                block.offset < entry.dataOffset ||
+                !fits(block.offset - entry.dataOffset, block.storedSize, entry.storedSize)) {
+                throw corrupt("block");
+            }
+            raw += block.rawSize;
+        }
+        if (raw != entry.size) throw corrupt("block sizes");
+    }
+}
+
+// --- Lookup --- //
+const assetPackEntry* AssetPack::find(std::string_view entryName) const {
+    if (table == nullptr) return nullptr;
+    uint64_t hash = assetNameHash(entryName);
+    const assetPackEntry* end = table + header->entryCount;
+    const assetPackEntry* found = std::lower_bound(table, end, entryName,
+        [&](const assetPackEntry& entry, std::string_view key) {
+            return assetEntryLess(entry.nameHash, name(entry), hash, key);
+        });
+    if (found == end || found->nameHash != hash || name(*found) != entryName) {
+        return nullptr;
+    }
+    return found;
+}
+
+std::string_view AssetPack::name(const assetPackEntry& entry) const {
+    return std::string_view(names + entry.nameOffset, entry.nameLength);
+}
+
+const void* AssetPack::view(const assetPackEntry& entry) const {
+    return entry.blockCount == 0 ? mapping + entry.dataOffset : nullptr;
+}
+
+// --- Reads --- //
+std::vector<char> AssetPack::read(const assetPackEntry& entry, JobSystem* jobs) {
+    std::vector<char> data(static_cast<size_t>(entry.size));
+    if (const void* mapped = view(entry)) {
+        if (!data.empty()) std::memcpy(data.data(), mapped, data.size());
+        return data;
+    }
+    assetRead request{&entry, data.data()};
+    read(&request, 1, jobs);
+    return data;
+}
+
+void AssetPack::read(const assetRead* reads, size_t count, JobSystem* jobs) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<decodeTask> tasks;
+    if (ring) {
+        readRanges(reads, count, tasks);
+    } else {
+        mappedRanges(reads, count, tasks);
+    }
+
+    // LZ4 blocks are independent : spread them over the workers
+    std::atomic<bool> corrupt{false};
+    auto decode = [&](uint32_t first, uint32_t last) {
+        for (uint32_t i = first; i < last; ++i) {
+            const decodeTask& task = tasks[i];
+            if (task.storedSize == task.rawSize) {
+                std::memcpy(task.destination, task.source, task.rawSize);
+            } else if (!lz4Decompress(task.source, task.storedSize, task.destination, task.rawSize)) {
+                corrupt.store(true, std::memory_order_relaxed);
+            }
+        }
+    };
+    uint32_t taskCount = static_cast<uint32_t>(tasks.size());
+    if (jobs != nullptr && taskCount > decodeGrain) {
+        jobs->parallelFor(taskCount, decodeGrain, decode);
+    } else {
+        decode(0, taskCount);
+    }
+    if (corrupt.load()) {
+        throw std::runtime_error("Corrupt asset pack block: " + path);
+    }
+
+    counters.batches++;
+    counters.entries += count;
+    for (size_t i = 0; i < count; ++i) {
+        if (reads[i].entry->blockCount > 0) counters.bytesDecompressed += reads[i].entry->size;
+    }
+    counters.lastBatchMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// io_uring : uncompressed entries straight into their destination, compressed ones merged into readBuffer
+void AssetPack::readRanges(const assetRead* reads, size_t count, std::vector<decodeTask>& tasks) {
+#ifdef __linux__
+    std::vector<ioRange> spans;
+    std::vector<size_t> compressed;
+    for (size_t i = 0; i < count; ++i) {
+        const assetPackEntry& entry = *reads[i].entry;
+        if (entry.blockCount == 0) {
+            if (entry.size > 0) {
+                spans.push_back({entry.dataOffset, entry.size, static_cast<uint8_t*>(reads[i].destination)});
+            }
+        } else {
+            compressed.push_back(i);
+        }
+    }
+
+    // neighbours within mergeGap become one read, sources are placed once readBuffer has its final size
+    std::sort(compressed.begin(), compressed.end(), [&](size_t a, size_t b) {
+        return reads[a].entry->dataOffset < reads[b].entry->dataOffset;
+    });
+    struct bufferSpan
+    {
+        uint64_t offset;
+        uint64_t size;
+        uint64_t bufferOffset;
+    };
+    std::vector<bufferSpan> merged;
+    std::vector<size_t> spanOf(count);
+    uint64_t bufferSize = 0;
+    for (size_t i : compressed) {
+        const assetPackEntry& entry = *reads[i].entry;
+        uint64_t end = entry.dataOffset + entry.storedSize;
+        if (!merged.empty()) {
+            bufferSpan& last = merged.back();
+            uint64_t lastEnd = last.offset + last.size;
+            if (entry.dataOffset <= lastEnd + mergeGap && end - last.offset <= maxReadSize) {
+                uint64_t grown = std::max(lastEnd, end) - last.offset;
+                bufferSize += grown - last.size;
+                last.size = grown;
+                spanOf[i] = merged.size() - 1;
+                continue;
+            }
+        }
+        merged.push_back({entry.dataOffset, entry.storedSize, bufferSize});
+        bufferSize += entry.storedSize;
+        spanOf[i] = merged.size() - 1;
+    }
+    if (readBuffer.size() < bufferSize) {
+        readBuffer.resize(static_cast<size_t>(bufferSize));
+    }
+    for (const bufferSpan& span : merged) {
+        spans.push_back({span.offset, span.size, readBuffer.data() + span.bufferOffset});
+    }
+    for (size_t i : compressed) {
+        const assetPackEntry& entry = *reads[i].entry;
+        const bufferSpan& span = merged[spanOf[i]];
+        const uint8_t* source = readBuffer.data() + span.bufferOffset + (entry.dataOffset - span.offset);
+        uint8_t* destination = static_cast<uint8_t*>(reads[i].destination);
+        for (uint32_t b = entry.firstBlock; b < entry.firstBlock + entry.blockCount; ++b) {
+            const assetPackBlock& block = blocks[b];
+            tasks.push_back({source + (block.offset - entry.dataOffset), destination, block.storedSize, block.rawSize});
+            destination += block.rawSize;
+        }
+    }
+
+    // in file order, at most maxReadSize per request
+    std::sort(spans.begin(), spans.end(), [](const ioRange& a, const ioRange& b) { return a.offset < b.offset; });
+    std::vector<ioRange> requests;
+    for (const ioRange& span : spans) {
+        for (uint64_t done = 0; done < span.size; done += maxReadSize) {
+            requests.push_back({span.offset + done, std::min(maxReadSize, span.size - done), span.destination + done});
+            counters.bytesRead += requests.back().size;
+        }
+    }
+
+    // short reads go back into the queue with what is left. After a failure nothing new is queued but the
+    // requests in flight are drained first : the kernel still writes into readBuffer / the destinations and
+    // their completions would be matched to the next batch's requests
+    std::vector<size_t> queue(requests.size());
+    for (size_t i = 0; i < requests.size(); ++i) queue[i] = requests.size() - 1 - i;   // popped from the back
+    unsigned inFlight = 0;
+    std::string error;
+    while (!queue.empty() || inFlight > 0) {
+        unsigned queued = 0;
+        while (!queue.empty() && inFlight < ringDepth) {
+            ring->push(file, requests[queue.back()], queue.back());
+            queue.pop_back();
+            ++queued;
+            ++inFlight;
+        }
+        counters.ioRequests += queued;
+        ring->enter(queued);
+        uint64_t index;
+        int result;
+        while (ring->pop(index, result)) {
+            --inFlight;
+            ioRange& request = requests[index];
+            if (!error.empty()) {
+                continue;
+            }
+            if (result == -EINTR || result == -EAGAIN) {
+                queue.push_back(index);
+                continue;
+            }
+            if (result <= 0) {
+                error = "Failed to read asset pack: " + path +
+                        (result < 0 ? ": " + std::string(std::strerror(-result)) : ": truncated");
+                queue.clear();
+                continue;
+            }
+            if (static_cast<uint64_t>(result) < request.size) {
+                request.offset += result;
+                request.size -= result;
+                request.destination += result;
+                queue.push_back(index);
+            }
+        }
+    }
+    if (!error.empty()) {
+        throw std::runtime_error(error);
+    }
+#else
+    (void)reads;
+    (void)count;
+    (void)tasks;
+#endif
+}
+
+// no io_uring : blocks decompress from the mapping, the page cache is filled ahead with one hint per entry
+void AssetPack::mappedRanges(const assetRead* reads, size_t count, std::vector<decodeTask>& tasks) {
+    for (size_t i = 0; i < count; ++i) {
+        const assetPackEntry& entry = *reads[i].entry;
+        uint8_t* destination = static_cast<uint8_t*>(reads[i].destination);
+#ifndef _WIN32
+        if (entry.storedSize > 0) {
+            uintptr_t pageSize = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+            uintptr_t first = reinterpret_cast<uintptr_t>(mapping + entry.dataOffset) & ~(pageSize - 1);
+            uintptr_t last = reinterpret_cast<uintptr_t>(mapping + entry.dataOffset + entry.storedSize);
+            madvise(reinterpret_cast<void*>(first), last - first, MADV_WILLNEED);
+        }
+#endif
+        counters.bytesRead += entry.storedSize;
+        if (entry.blockCount == 0) {
+            // copied in blockSize pieces so large entries spread over the workers too
+            for (uint64_t done = 0; done < entry.size; done += header->blockSize) {
+                uint32_t size = static_cast<uint32_t>(std::min<uint64_t>(header->blockSize, entry.size - done));
+                tasks.push_back({mapping + entry.dataOffset + done, destination + done, size, size});
+            }
+            continue;
+        }
+        for (uint32_t b = entry.firstBlock; b < entry.firstBlock + entry.blockCount; ++b) {
+            const assetPackBlock& block = blocks[b];
+            tasks.push_back({mapping + block.offset, destination, block.storedSize, block.rawSize});
+            destination += block.rawSize;
+        }
+    }
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "pack_format.hpp"
+
+class JobSystem;
+
+/* Read side of the asset pack (pack_format.hpp).
+ * The whole file is mapped read-only : the table of contents and the
+ * uncompressed entries are used in place. Batches of entries are read with
+ * io_uring on Linux : requests sorted by offset, neighbours merged into large
+ * reads, uncompressed entries read straight into their destination and LZ4
+ * blocks decompressed from the read buffer on the job system. Without
+ * io_uring (other platforms, old kernels, seccomp) the blocks decompress
+ * from the mapping instead, the ranges are prefetched first.
+ */
+
+// one entry of a batch : `destination` holds entry->size bytes, e.g. mapped staging memory
+struct assetRead
+{
+    const assetPackEntry* entry = nullptr;
+    void* destination = nullptr;
+};
+
+struct assetPackStats
+{
+    uint64_t batches = 0;
+    uint64_t entries = 0;
+    uint64_t ioRequests = 0;        // reads submitted to io_uring, 0 on the mapped path
+    uint64_t bytesRead = 0;         // from the file, gaps merged into a read included
+    uint64_t bytesDecompressed = 0;
+    double lastBatchMs = 0.0;
+};
+
+class AssetPack
+{
+public:
+    AssetPack();
+    ~AssetPack();
+    AssetPack(const AssetPack&) = delete;
+    AssetPack& operator=(const AssetPack&) = delete;
+
+    // false if there is no such file, throws on a corrupt pack
+    bool open(const std::string& path, bool useIoUring = true);
+    void close();
+    bool isOpen() const { return mapping != nullptr; }
+    bool usesIoUring() const { return ring != nullptr; }
+
+    const assetPackEntry* find(std::string_view name) const;    // nullptr if missing
+    std::string_view name(const assetPackEntry& entry) const;
+    uint32_t entryCount() const { return header ? header->entryCount : 0; }
+    const assetPackEntry* entries() const { return table; }
+    // uncompressed entries, in the mapping; nullptr for compressed ones
+    const void* view(const assetPackEntry& entry) const;
+
+    // every entry decompressed / copied into its destination when this returns; jobs may be null
+    void read(const assetRead* reads, size_t count, JobSystem* jobs);
+    std::vector<char> read(const assetPackEntry& entry, JobSystem* jobs = nullptr);
+    const assetPackStats& stats() const { return counters; }
+private:
+    struct IoRing;                  // io_uring through raw syscalls, asset_pack.cpp
+    struct decodeTask
+    {
+        const uint8_t* source;
+        uint8_t* destination;
+        uint32_t storedSize;
+        uint32_t rawSize;           // == storedSize : copy
+    };
+    void validate() const;
+    void readRanges(const assetRead* reads, size_t count, std::vector<decodeTask>& tasks);
+    void mappedRanges(const assetRead* reads, size_t count, std::vector<decodeTask>& tasks);
+private:
+    std::string path;
+#ifdef _WIN32
+    void* file = nullptr;           // HANDLE
+    void* fileMapping = nullptr;
+#else
+    int file = -1;
+#endif
+    const uint8_t* mapping = nullptr;
+    uint64_t mappingSize = 0;
+    const assetPackHeader* header = nullptr;
+    const assetPackEntry* table = nullptr;
+    const assetPackBlock* blocks = nullptr;
+    const char* names = nullptr;
+    std::unique_ptr<IoRing> ring;
+    std::vector<uint8_t> readBuffer;    // merged reads of compressed entries, reused between batches
+    assetPackStats counters{};
+};
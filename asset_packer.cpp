@@ -0,0 +1,218 @@
+#include "pack_format.hpp"
+#include "lz4_block.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+/* asset_packer : 资源打包工具
+ * Packs files into the .pak layout of pack_format.hpp. Entries keep the
+ * command line order in the data section (assets loaded together should be
+ * listed together), the table of contents is sorted for the binary search.
+ * Each entry is cut into LZ4 blocks; an entry that saves less than
+ * --min-saving is stored uncompressed so the runtime can use it mapped.
+ * Prints a JSON report with the raw / stored sizes per entry.
+ */
+
+struct packOptions
+{
+    std::string output;
+    std::vector<std::string> inputs;
+    bool compress = true;           // --store : everything uncompressed
+    double minSaving = 0.125;       // fraction of the entry compression has to save
+};
+
+struct packedEntry
+{
+    std::string name;               // file name without the directory
+    std::vector<char> data;         // as written to the pack
+    uint64_t size = 0;
+    std::vector<assetPackBlock> blocks;   // offsets relative to the entry until the layout is known
+};
+
+static uint64_t alignSection(uint64_t offset) {
+    return (offset + assetPackAlignment - 1) / assetPackAlignment * assetPackAlignment;
+}
+
+static std::vector<char> readInput(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open input: " + path);
+    }
+    return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+static packedEntry packEntry(const std::string& path, const packOptions& options) {
+    packedEntry entry{};
+    size_t slash = path.find_last_of("/\\");
+    entry.name = slash == std::string::npos ? path : path.substr(slash + 1);
+    std::vector<char> raw = readInput(path);
+    entry.size = raw.size();
+    if (!options.compress || raw.empty()) {
+        entry.data = std::move(raw);
+        return entry;
+    }
+
+    std::vector<char> block(lz4CompressBound(assetPackBlockSize));
+    for (size_t offset = 0; offset < raw.size(); offset += assetPackBlockSize) {
+        uint32_t rawSize = static_cast<uint32_t>(std::min<size_t>(assetPackBlockSize, raw.size() - offset));
+        // a block that doesn't shrink is stored raw
+        size_t stored = lz4Compress(raw.data() + offset, rawSize, block.data(), rawSize - 1);
+        const char* source = stored > 0 ? block.data() : raw.data() + offset;
+        uint32_t storedSize = stored > 0 ? static_cast<uint32_t>(stored) : rawSize;
+        entry.blocks.push_back({entry.data.size(), storedSize, rawSize});
+        entry.data.insert(entry.data.end(), source, source + storedSize);
+    }
+    if (entry.data.size() > entry.size * (1.0 - options.minSaving)) {
+        entry.blocks.clear();
+        entry.data = std::move(raw);
+    }
+    return entry;
+}
+
+static std::string pack(const packOptions& options) {
+    std::vector<packedEntry> entries;
+    std::unordered_set<std::string> seen;
+    for (const std::string& input : options.inputs) {
+        entries.push_back(packEntry(input, options));
+        if (!seen.insert(entries.back().name).second) {
+            throw std::runtime_error("Duplicate entry name: " + entries.back().name);
+        }
+    }
+
+    // --- Layout --- //
+    uint32_t blockCount = 0;
+    uint32_t nameBytes = 0;
+    for (const packedEntry& entry : entries) {
+        blockCount += static_cast<uint32_t>(entry.blocks.size());
+        nameBytes += static_cast<uint32_t>(entry.name.size());
+    }
+    assetPackHeader header{};
+    header.magic = assetPackMagic;
+    header.version = assetPackVersion;
+    header.entryCount = static_cast<uint32_t>(entries.size());
+    header.blockCount = blockCount;
+    header.blockSize = assetPackBlockSize;
+    header.nameBytes = nameBytes;
+    header.entryOffset = sizeof(assetPackHeader);
+    header.blockOffset = alignSection(header.entryOffset + entries.size() * sizeof(assetPackEntry));
+    header.nameOffset = alignSection(header.blockOffset + blockCount * sizeof(assetPackBlock));
+    header.dataOffset = alignSection(header.nameOffset + nameBytes);
+
+    // data in command line order, blocks and names follow it
+    std::vector<assetPackEntry> table;
+    std::vector<assetPackBlock> blocks;
+    std::string names;
+    std::vector<uint64_t> dataOffsets;
+    uint64_t offset = header.dataOffset;
+    for (const packedEntry& entry : entries) {
+        assetPackEntry record{};
+        record.nameHash = assetNameHash(entry.name);
+        record.nameOffset = static_cast<uint32_t>(names.size());
+        record.nameLength = static_cast<uint32_t>(entry.name.size());
+        record.dataOffset = offset;
+        record.size = entry.size;
+        record.storedSize = entry.data.size();
+        record.firstBlock = static_cast<uint32_t>(blocks.size());
+        record.blockCount = static_cast<uint32_t>(entry.blocks.size());
+        for (assetPackBlock block : entry.blocks) {
+            block.offset += offset;
+            blocks.push_back(block);
+        }
+        names += entry.name;
+        table.push_back(record);
+        dataOffsets.push_back(offset);
+        offset = alignSection(offset + entry.data.size());
+    }
+    header.fileSize = offset;
+    std::sort(table.begin(), table.end(), [&](const assetPackEntry& a, const assetPackEntry& b) {
+        return assetEntryLess(a.nameHash, std::string_view(names).substr(a.nameOffset, a.nameLength),
+                              b.nameHash, std::string_view(names).substr(b.nameOffset, b.nameLength));
+    });
+
+    std::vector<char> blob(header.fileSize, 0);
+    std::memcpy(blob.data(), &header, sizeof(header));
+    std::memcpy(blob.data() + header.entryOffset, table.data(), table.size() * sizeof(assetPackEntry));
+    std::memcpy(blob.data() + header.blockOffset, blocks.data(), blocks.size() * sizeof(assetPackBlock));
+    std::memcpy(blob.data() + header.nameOffset, names.data(), names.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        std::copy(entries[i].data.begin(), entries[i].data.end(), blob.begin() + static_cast<std::ptrdiff_t>(dataOffsets[i]));
+    }
+
+    std::ofstream file(options.output, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open output: " + options.output);
+    }
+    file.write(blob.data(), static_cast<std::streamsize>(blob.size()));
+    bool written = file.good();
+    file.close();
+    if (!written || file.fail()) {
+        throw std::runtime_error("Failed to write output: " + options.output);
+    }
+
+    // --- Report --- //
+    uint64_t rawBytes = 0;
+    uint64_t storedBytes = 0;
+    std::ostringstream json;
+    json << "{\"output\": \"" << options.output << "\", \"entries\": [";
+    for (size_t i = 0; i < entries.size(); ++i) {
+        rawBytes += entries[i].size;
+        storedBytes += entries[i].data.size();
+        json << (i ? ", " : "") << "{\"name\": \"" << entries[i].name << "\", \"bytes\": " << entries[i].size
+             << ", \"stored_bytes\": " << entries[i].data.size()
+             << ", \"blocks\": " << entries[i].blocks.size() << "}";
+    }
+    json << "], \"raw_bytes\": " << rawBytes << ", \"stored_bytes\": " << storedBytes
+         << ", \"compression_ratio\": " << (storedBytes > 0 ? static_cast<double>(rawBytes) / storedBytes : 1.0)
+         << ", \"file_bytes\": " << header.fileSize << "}";
+    return json.str();
+}
+
+static void printUsage() {
+    std::cout << "usage: asset_packer [--store] [--min-saving FRACTION] output.pak input..." << std::endl;
+}
+
+static packOptions parseOptions(int argc, char** argv) {
+    packOptions options{};
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--store") options.compress = false;
+        else if (arg == "--min-saving") {
+            if (i + 1 >= argc) {
+                throw std::runtime_error("Missing value for " + arg);
+            }
+            options.minSaving = std::clamp(std::stod(argv[++i]), 0.0, 1.0);
+        }
+        else if (arg == "--help" || arg == "-h") {
+            printUsage();
+            std::exit(0);
+        }
+        else if (!arg.empty() && arg[0] == '-') throw std::runtime_error("Unknown argument: " + arg);
+        else positional.push_back(arg);
+    }
+    if (positional.size() < 2) {
+        printUsage();
+        throw std::runtime_error("Expected an output and at least one input path");
+    }
+    options.output = positional[0];
+    options.inputs.assign(positional.begin() + 1, positional.end());
+    return options;
+}
+
+int main(int argc, char** argv) {
+    try {
+        std::cout << pack(parseOptions(argc, argv)) << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "asset_packer: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
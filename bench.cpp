@@ -0,0 +1,605 @@
+#include "test_vulkan.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+#ifdef _WIN32
+    #include <windows.h>
+    #include <psapi.h>
+#else
+    #include <cerrno>
+    #include <sys/resource.h>
+    #include <sys/wait.h>
+    #include <unistd.h>
+#endif
+
+/* vulkan_bench : 固定场景的端到端性能测试
+ * Runs named scenarios for a fixed frame count (or duration) and prints one
+ * JSON object per scenario with FPS, CPU / GPU frame time percentiles and the
+ * peak memory. --headless renders offscreen so it runs on lavapipe. With more
+ * than one scenario each runs in its own process, the peak is per scenario.
+ */
+
+struct benchScenario
+{
+    std::string name;
+    renderSettings settings;
+};
+
+struct benchOptions
+{
+    std::string scenario = "all";
+    uint32_t frames = 1000;
+    double duration = 0.0;     // seconds, overrides frames when > 0
+    uint32_t warmup = 30;
+    bool headless = false;
+    int width = 1280;
+    int height = 1080;
+    uint32_t instances = 10000;
+    std::string output;        // empty : stdout, diagnostics go to stderr
+    std::string capture;       // capture file, empty : no capture
+    bool captureY4M = false;
+    uint32_t sceneObjects = 100000;
+    double sceneDirty = 0.01;  // fraction of the hierarchies moved per frame
+    int workers = -1;          // job system workers, -1 : one per hardware thread minus the main thread
+    uint32_t statisticsGroups = 0;
+    bool overdraw = false;
+    double fpsCap = 0.0;       // frame limiter, 0 : uncapped
+    bool justInTimeInput = false;
+    bool sortDraws = true;     // --no-sort : record the draw packets in submission order
+    bool commandCache = true;  // --no-cache : re-record the main pass every frame
+    uint32_t dispatchCalls = 200000;   // pipelines scenario : loader trampoline vs vkd table, 0 : skip
+};
+
+struct percentiles
+{
+    double p50 = 0.0;
+    double p90 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+};
+
+// capture.raw -> capture.<scenario>.raw : each scenario process writes its own file
+static std::string scenarioCapturePath(const std::string& path, const std::string& scenario) {
+    size_t separator = path.find_last_of("/\\");
+    size_t name = separator == std::string::npos ? 0 : separator + 1;
+    size_t dot = path.rfind('.');
+    if (dot == std::string::npos || dot <= name) {     // no extension (or a dot file)
+        return path + "." + scenario;
+    }
+    return path.substr(0, dot) + "." + scenario + path.substr(dot);
+}
+
+static std::vector<benchScenario> makeScenarios(const benchOptions& options) {
+    renderSettings base{};
+    base.headless = options.headless;
+    base.vsync = false;
+    base.gpuTiming = true;
+    base.capturePath = options.capture;
+    base.captureY4M = options.captureY4M;
+    base.workerThreads = options.workers;
+    base.statisticsGroups = options.statisticsGroups;
+    base.overdraw = options.overdraw;
+    base.pacing.fpsCap = options.fpsCap;
+    base.pacing.justInTimeInput = options.justInTimeInput;
+    base.sortDraws = options.sortDraws;
+    base.commandCache = options.commandCache;
+
+    std::vector<benchScenario> scenarios;
+    benchScenario triangle{"triangle", base};
+    scenarios.push_back(triangle);
+
+    benchScenario instanced{"instanced", base};
+    instanced.settings.instanceCount = options.instances;
+    scenarios.push_back(instanced);
+
+    benchScenario fillrate{"fillrate", base};   // heavy blended overdraw
+    fillrate.settings.drawCount = 256;
+    scenarios.push_back(fillrate);
+
+    benchScenario pipelines{"pipelines", base}; // bind a different pipeline per draw
+    pipelines.settings.drawCount = 1024;
+    pipelines.settings.pipelineCount = 64;
+    scenarios.push_back(pipelines);
+
+    benchScenario postprocess{"postprocess", base}; // fillrate + tonemap / blur on the async compute queue
+    postprocess.settings.drawCount = 256;
+    postprocess.settings.computePost = true;
+    scenarios.push_back(postprocess);
+
+    benchScenario scene{"scene", base};         // partial instance uploads of an animated hierarchy
+    scene.settings.sceneCapacity = options.sceneObjects;
+    scenarios.push_back(scene);
+
+    if (!options.headless) {
+        benchScenario idle{"idle", base};       // static window through the real main loop : CPU while idle
+        scenarios.push_back(idle);
+    }
+    if (options.scenario == "all" && !options.capture.empty()) {
+        for (benchScenario& scenario : scenarios) {
+            scenario.settings.capturePath = scenarioCapturePath(options.capture, scenario.name);
+        }
+    }
+    return scenarios;
+}
+
+static percentiles computePercentiles(std::vector<double> samples) {
+    percentiles result{};
+    if (samples.empty()) {
+        return result;
+    }
+    std::sort(samples.begin(), samples.end());
+    auto at = [&](double p) {
+        size_t index = static_cast<size_t>(p * (samples.size() - 1) + 0.5);
+        return samples[std::min(index, samples.size() - 1)];
+    };
+    result.p50 = at(0.50);
+    result.p90 = at(0.90);
+    result.p99 = at(0.99);
+    result.max = samples.back();
+    return result;
+}
+
+static std::string jsonEscape(const std::string& text) {
+    std::string result;
+    result.reserve(text.size());
+    for (char c : text) {
+        switch (c) {
+        case '"':  result += "\\\""; break;
+        case '\\': result += "\\\\"; break;
+        case '\n': result += "\\n"; break;
+        case '\r': result += "\\r"; break;
+        case '\t': result += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char code[8];
+                std::snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned char>(c));
+                result += code;
+            } else {
+                result += c;
+            }
+        }
+    }
+    return result;
+}
+
+static uint64_t peakMemoryBytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return counters.PeakWorkingSetSize;
+    }
+    return 0;
+#else
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024; // Linux reports KiB
+#endif
+}
+
+// user + kernel time of the whole process, seconds
+static double processCpuSeconds() {
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+        return 0.0;
+    }
+    auto toSeconds = [](const FILETIME& time) {
+        return ((static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime) * 1e-7;
+    };
+    return toSeconds(kernel) + toSeconds(user);
+#else
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1e-6;
+#endif
+}
+
+static void writePercentiles(std::ostream& out, const char* key, const std::vector<double>& samples) {
+    out << "\"" << key << "\": ";
+    if (samples.empty()) {
+        out << "null";
+        return;
+    }
+    percentiles p = computePercentiles(samples);
+    out << "{\"p50\": " << p.p50 << ", \"p90\": " << p.p90
+        << ", \"p99\": " << p.p99 << ", \"max\": " << p.max << "}";
+}
+
+// hierarchies of one root and seven children, the roots are moved round robin
+struct sceneAnimation
+{
+    static constexpr uint32_t groupSize = 8;
+    std::vector<sceneHandle> roots;
+    uint32_t next = 0;
+
+    void build(SceneStore& scene, uint32_t objects) {
+        for (uint32_t i = 0; i + groupSize <= objects; i += groupSize) {
+            sceneHandle root = scene.create();
+            roots.push_back(root);
+            for (uint32_t child = 1; child < groupSize; ++child) {
+                mat4 local = {{1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f,
+                               static_cast<float>(child), 0.f, 0.f, 1.f}};
+                scene.setLocalTransform(scene.create(root), local);
+            }
+        }
+    }
+
+    void animate(SceneStore& scene, double dirtyFraction, uint64_t frame) {
+        if (roots.empty()) return;
+        uint32_t count = std::max(1u, static_cast<uint32_t>(roots.size() * dirtyFraction));
+        float offset = static_cast<float>(std::sin(frame * 0.01));
+        for (uint32_t i = 0; i < count; ++i) {
+            uint32_t index = (next + i) % static_cast<uint32_t>(roots.size());
+            mat4 local = {{1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f,
+                           static_cast<float>(index % 256), offset, static_cast<float>(index / 256), 1.f}};
+            scene.setLocalTransform(roots[index], local);
+        }
+        next = (next + count) % static_cast<uint32_t>(roots.size());
+    }
+};
+
+// perspective camera (90 degrees, z in [0, 1], near 0.1, far 256) at (x, y, z) looking down -z
+static mat4 sceneCamera(float x, float y, float z) {
+    const float n = 0.1f, f = 256.f;
+    mat4 projection{};
+    projection.m[0] = 1.f;
+    projection.m[5] = -1.f;
+    projection.m[10] = f / (n - f);
+    projection.m[11] = -1.f;
+    projection.m[14] = n * f / (n - f);
+    mat4 view = {{1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, -x, -y, -z, 1.f}};
+    return multiply(projection, view);
+}
+
+static std::string runScenario(const benchScenario& scenario, const benchOptions& options) {
+    using clock = std::chrono::steady_clock;
+    windowInfo info{options.width, options.height, "vulkan_bench: " + scenario.name};
+    test renderer(info, scenario.settings);
+    const bool animated = scenario.settings.sceneCapacity > 0;
+    sceneAnimation animation;
+    if (animated) {
+        animation.build(renderer.scene(), scenario.settings.sceneCapacity);
+        // runs on the job system, overlapping the previous frame's recording and submission
+        renderer.setSceneUpdate([&](SceneStore& scene, uint64_t frame) {
+            animation.animate(scene, options.sceneDirty, frame);
+        });
+        // over the middle of the grid, part of it outside the view : culled in the prepare jobs too
+        renderer.setSceneView(sceneCamera(128.f, 16.f, 64.f));
+    }
+
+    for (uint32_t i = 0; i < options.warmup && !renderer.windowClosed(); ++i) {
+        renderer.renderFrame();
+    }
+
+    std::vector<double> cpuTimes;
+    std::vector<double> gpuTimes;
+    cpuTimes.reserve(options.frames);
+    gpuTimes.reserve(options.frames);
+    uint64_t uploadBytes = 0;
+    uint64_t uploadRegions = 0;
+    std::vector<double> sortTimes;
+    uint64_t pipelineBinds = 0;
+    uint64_t redundantBinds = 0;
+    uint64_t unsortedBinds = 0;
+    uint64_t mainPassRecordings = 0;
+    uint64_t visibleInstances = 0;
+    uint64_t drawListVersion = renderer.drawListVersion();
+    double cpuStart = processCpuSeconds();
+    uint64_t pacedStart = renderer.pacingStatistics().frames;
+    auto start = clock::now();
+    auto done = [&]() {
+        if (renderer.windowClosed()) return true;
+        if (options.duration > 0.0) {
+            return std::chrono::duration<double>(clock::now() - start).count() >= options.duration;
+        }
+        return cpuTimes.size() >= options.frames;
+    };
+    if (scenario.name == "idle") {
+        // nothing changes after the warmup : the main loop should block on events instead of drawing
+        renderer.mainLoop(options.duration > 0.0 ? options.duration : 5.0);
+    }
+    while (scenario.name != "idle" && !done()) {
+        auto frameStart = clock::now();
+        renderer.renderFrame();
+        cpuTimes.push_back(std::chrono::duration<double, std::milli>(clock::now() - frameStart).count());
+        uploadBytes += renderer.instanceUploads().bytes;
+        uploadRegions += renderer.instanceUploads().regions;
+        const drawQueueStats& queue = renderer.drawQueueStatistics();
+        if (renderer.drawListVersion() != drawListVersion) {   // rebuilt and sorted this frame
+            drawListVersion = renderer.drawListVersion();
+            sortTimes.push_back(queue.sortMs);
+        }
+        // a reused cached pass binds nothing this frame, the queue still holds its last recording's counts
+        if (renderer.mainPassRecorded()) {
+            ++mainPassRecordings;
+            pipelineBinds += queue.pipelineBinds + queue.descriptorBinds;
+            redundantBinds += queue.redundantBinds;
+            unsortedBinds += queue.unsortedBinds;
+        }
+        visibleInstances += renderer.visibleSceneInstances().size();
+        // GPU time of the frame that just retired (one frame in flight)
+        if (renderer.lastGpuFrameTime() >= 0.0) {
+            gpuTimes.push_back(renderer.lastGpuFrameTime());
+        }
+    }
+    renderer.waitIdle();
+    double elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    double cpuSeconds = processCpuSeconds() - cpuStart;
+    const pacerStats& pacing = renderer.pacingStatistics();
+    uint64_t frames = pacing.frames - pacedStart;
+
+    std::ostringstream json;
+    json << "{\"scenario\": \"" << scenario.name << "\""
+         << ", \"device\": \"" << jsonEscape(renderer.deviceName()) << "\""
+         << ", \"headless\": " << (scenario.settings.headless ? "true" : "false")
+         << ", \"width\": " << options.width << ", \"height\": " << options.height
+         << ", \"draws\": " << scenario.settings.drawCount
+         << ", \"instances\": " << scenario.settings.instanceCount
+         << ", \"pipelines\": " << scenario.settings.pipelineCount
+         << ", \"frames\": " << frames
+         << ", \"seconds\": " << elapsed
+         << ", \"fps\": " << (elapsed > 0.0 ? frames / elapsed : 0.0) << ", ";
+    writePercentiles(json, "cpu_frame_ms", cpuTimes);
+    json << ", ";
+    writePercentiles(json, "gpu_frame_ms", gpuTimes);
+    json << ", \"peak_memory_bytes\": " << peakMemoryBytes();
+    json << ", \"pacing\": {\"fps_cap\": " << options.fpsCap
+         << ", \"just_in_time_input\": " << (options.justInTimeInput ? "true" : "false")
+         << ", \"cpu_percent\": " << (elapsed > 0.0 ? 100.0 * cpuSeconds / elapsed : 0.0)
+         << ", \"idle_waits\": " << pacing.idleWaits
+         << ", \"limiter_sleep_seconds\": " << pacing.sleptSeconds
+         << ", \"input_to_present_ms\": " << pacing.inputAgeMs << "}";
+    if (!scenario.settings.capturePath.empty()) {
+        captureStats capture = renderer.captureStatistics();
+        json << ", \"capture\": {\"format\": \"" << (scenario.settings.captureY4M ? "y4m" : "raw") << "\""
+             << ", \"captured\": " << capture.captured
+             << ", \"dropped\": " << capture.dropped
+             << ", \"written\": " << capture.written
+             << ", \"bytes\": " << capture.bytesWritten
+             << ", \"failed\": " << (capture.failed ? "true" : "false")
+             << ", \"writer_mb_per_s\": " << capture.throughputMBps() << "}";
+    }
+    if (!cpuTimes.empty()) {
+        double recorded = static_cast<double>(cpuTimes.size());
+        json << ", \"draw_queue\": {\"sorted\": " << (options.sortDraws ? "true" : "false")
+             << ", \"recordings\": " << mainPassRecordings
+             << ", \"binds_per_frame\": " << pipelineBinds / recorded
+             << ", \"redundant_binds_per_frame\": " << redundantBinds / recorded
+             << ", \"unsorted_binds_per_frame\": " << unsortedBinds / recorded << ", ";
+        writePercentiles(json, "sort_ms", sortTimes);
+        json << "}";
+        const commandCacheStats& cache = renderer.commandCacheStatistics();
+        json << ", \"command_cache\": {\"enabled\": " << (options.commandCache ? "true" : "false")
+             << ", \"records\": " << cache.records
+             << ", \"reuses\": " << cache.reuses
+             << ", \"last_record_ms\": " << cache.lastRecordMs << "}";
+    }
+    if (scenario.name == "pipelines" && options.dispatchCalls > 0) {
+        dispatchCost dispatch = renderer.measureDispatch(options.dispatchCalls);
+        json << ", \"dispatch\": {\"calls\": " << options.dispatchCalls << ", \"trampoline_ns_per_call\": ";
+        if (dispatch.trampolineNs >= 0.0) json << dispatch.trampolineNs;
+        else json << "null";
+        json << ", \"direct_ns_per_call\": " << dispatch.directNs << "}";
+    }
+    const std::vector<drawGroupStats>& statistics = renderer.drawStatistics();
+    if (!statistics.empty()) {
+        json << ", \"pipeline_statistics\": [";
+        for (size_t i = 0; i < statistics.size(); ++i) {
+            json << (i ? ", " : "") << "{\"group\": \"" << statistics[i].name << "\""
+                 << ", \"vertex_invocations\": " << statistics[i].vertexInvocations
+                 << ", \"clipping_primitives\": " << statistics[i].clippingPrimitives
+                 << ", \"fragment_invocations\": " << statistics[i].fragmentInvocations << "}";
+        }
+        json << "]";
+    }
+    if (animated) {
+        double frames = std::max<double>(1.0, static_cast<double>(cpuTimes.size()));
+        jobStats jobs = renderer.jobSystem().stats();
+        json << ", \"scene\": {\"objects\": " << renderer.scene().size()
+             << ", \"workers\": " << renderer.jobSystem().workerCount()
+             << ", \"jobs_executed\": " << jobs.executed
+             << ", \"jobs_stolen\": " << jobs.stolen
+             << ", \"dirty_fraction\": " << options.sceneDirty
+             << ", \"visible_per_frame\": " << visibleInstances / frames
+             << ", \"upload_bytes_per_frame\": " << uploadBytes / frames
+             << ", \"upload_regions_per_frame\": " << uploadRegions / frames
+             << ", \"full_upload_bytes\": " << renderer.scene().size() * InstanceBuffers::instanceSize << "}";
+    }
+    json << "}";
+    return json.str();
+}
+
+// --- Scenario processes --- //
+// ru_maxrss / PeakWorkingSetSize only ever grow : a scenario in its own process reports its own peak
+#ifdef _WIN32
+static std::string runScenarioProcess(const benchScenario& scenario, const benchOptions&) {
+    char directory[MAX_PATH];
+    char report[MAX_PATH];
+    if (!GetTempPathA(MAX_PATH, directory) || !GetTempFileNameA(directory, "vkb", 0, report)) {
+        throw std::runtime_error("Failed to create a temporary file for scenario " + scenario.name);
+    }
+    // the last --scenario / --output / --capture win, the child runs this scenario only and writes the report file
+    std::string command = std::string(GetCommandLineA()) + " --scenario " + scenario.name + " --output \"" + report + "\"";
+    if (!scenario.settings.capturePath.empty()) {
+        command += " --capture \"" + scenario.settings.capturePath + "\"";
+    }
+    STARTUPINFOA startup{};
+    startup.cb = sizeof(startup);
+    PROCESS_INFORMATION process{};
+    if (!CreateProcessA(nullptr, command.data(), nullptr, nullptr, FALSE, 0, nullptr, nullptr, &startup, &process)) {
+        DeleteFileA(report);
+        throw std::runtime_error("Failed to start scenario " + scenario.name);
+    }
+    WaitForSingleObject(process.hProcess, INFINITE);
+    DWORD exitCode = 1;
+    GetExitCodeProcess(process.hProcess, &exitCode);
+    CloseHandle(process.hThread);
+    CloseHandle(process.hProcess);
+
+    std::ifstream file(report);
+    std::string json((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    file.close();
+    DeleteFileA(report);
+    // {"results": [\n  <scenario>\n]}\n
+    size_t first = json.find("[\n  ");
+    size_t last = json.rfind("\n]}");
+    if (exitCode != 0 || first == std::string::npos || last == std::string::npos || last < first + 4) {
+        throw std::runtime_error("Scenario " + scenario.name + " failed");
+    }
+    return json.substr(first + 4, last - first - 4);
+}
+#else
+static std::string runScenarioProcess(const benchScenario& scenario, const benchOptions& options) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        throw std::runtime_error("Failed to create a pipe for scenario " + scenario.name);
+    }
+    std::cerr.flush();
+    pid_t child = fork();
+    if (child < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        throw std::runtime_error("Failed to fork scenario " + scenario.name);
+    }
+    if (child == 0) {
+        // nothing of Vulkan / GLFW is initialized in the parent, the child starts clean
+        close(fds[0]);
+        int status = 0;
+        try {
+            std::string json = runScenario(scenario, options);
+            for (size_t written = 0; written < json.size();) {
+                ssize_t n = write(fds[1], json.data() + written, json.size() - written);
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) {
+                    status = 1;
+                    break;
+                }
+                written += static_cast<size_t>(n);
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "vulkan_bench: " << e.what() << std::endl;
+            status = 1;
+        }
+        std::cerr.flush();
+        _exit(status);
+    }
+
+    close(fds[1]);
+    std::string json;
+    char buffer[4096];
+    for (;;) {
+        ssize_t n = read(fds[0], buffer, sizeof(buffer));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        json.append(buffer, static_cast<size_t>(n));
+    }
+    close(fds[0]);
+    int status = 0;
+    while (waitpid(child, &status, 0) < 0 && errno == EINTR) {}
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || json.empty()) {
+        throw std::runtime_error("Scenario " + scenario.name + " failed");
+    }
+    return json;
+}
+#endif
+
+static void printUsage() {
+    std::cout << "usage: vulkan_bench [--scenario all|triangle|instanced|fillrate|pipelines|postprocess|scene|idle]\n"
+                 "                    [--frames N] [--duration SECONDS] [--warmup N]\n"
+                 "                    [--headless] [--width W] [--height H] [--instances N]\n"
+                 "                    [--output FILE] [--capture FILE] [--capture-format raw|y4m]\n"
+                 "                    [--scene-objects N] [--scene-dirty FRACTION] [--workers N]\n"
+                 "                    [--statistics GROUPS] [--overdraw] [--fps-cap FPS] [--jit-input]\n"
+                 "                    [--no-sort] [--no-cache] [--dispatch-calls N]" << std::endl;
+}
+
+static benchOptions parseOptions(int argc, char** argv) {
+    benchOptions options{};
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::runtime_error("Missing value for " + arg);
+            }
+            return argv[++i];
+        };
+        if (arg == "--scenario") options.scenario = value();
+        else if (arg == "--frames") options.frames = static_cast<uint32_t>(std::stoul(value()));
+        else if (arg == "--duration") options.duration = std::stod(value());
+        else if (arg == "--warmup") options.warmup = static_cast<uint32_t>(std::stoul(value()));
+        else if (arg == "--headless") options.headless = true;
+        else if (arg == "--width") options.width = std::stoi(value());
+        else if (arg == "--height") options.height = std::stoi(value());
+        else if (arg == "--instances") options.instances = static_cast<uint32_t>(std::stoul(value()));
+        else if (arg == "--output") options.output = value();
+        else if (arg == "--capture") options.capture = value();
+        else if (arg == "--capture-format") options.captureY4M = value() == "y4m";
+        else if (arg == "--scene-objects") options.sceneObjects = static_cast<uint32_t>(std::stoul(value()));
+        else if (arg == "--scene-dirty") options.sceneDirty = std::stod(value());
+        else if (arg == "--workers") options.workers = std::stoi(value());
+        else if (arg == "--statistics") options.statisticsGroups = static_cast<uint32_t>(std::stoul(value()));
+        else if (arg == "--overdraw") options.overdraw = true;
+        else if (arg == "--fps-cap") options.fpsCap = std::stod(value());
+        else if (arg == "--jit-input") options.justInTimeInput = true;
+        else if (arg == "--no-sort") options.sortDraws = false;
+        else if (arg == "--no-cache") options.commandCache = false;
+        else if (arg == "--dispatch-calls") options.dispatchCalls = static_cast<uint32_t>(std::stoul(value()));
+        else if (arg == "--help" || arg == "-h") {
+            printUsage();
+            std::exit(0);
+        }
+        else throw std::runtime_error("Unknown argument: " + arg);
+    }
+    return options;
+}
+
+int main(int argc, char** argv) {
+    try {
+        benchOptions options = parseOptions(argc, argv);
+        std::vector<std::string> results;
+        // stdout carries the JSON report only : the renderer logs to stderr, anything else
+        // written to std::cout while the scenarios run is sent there as well
+        std::streambuf* report = std::cout.rdbuf(std::cerr.rdbuf());
+        for (const benchScenario& scenario : makeScenarios(options)) {
+            if (options.scenario != "all" && options.scenario != scenario.name) {
+                continue;
+            }
+            // a single scenario is alone in this process already
+            results.push_back(options.scenario == "all" ? runScenarioProcess(scenario, options)
+                                                        : runScenario(scenario, options));
+        }
+        std::cout.rdbuf(report);
+        if (results.empty()) {
+            throw std::runtime_error("Unknown scenario: " + options.scenario);
+        }
+
+        std::ostringstream json;
+        json << "{\"results\": [\n";
+        for (size_t i = 0; i < results.size(); ++i) {
+            json << "  " << results[i] << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        json << "]}\n";
+        if (options.output.empty()) {
+            std::cout << json.str();
+        } else {
+            std::ofstream file(options.output);
+            if (!file.is_open()) {
+                throw std::runtime_error("Failed to open output: " + options.output);
+            }
+            file << json.str();
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "vulkan_bench: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include "command_cache.hpp"
+#include "vk_dispatch.hpp"
+#include <chrono>
+#include <stdexcept>
+
+void CommandCache::init(VkDevice c_device, const VkAllocationCallbacks* allocator, uint32_t queueFamily, uint32_t slotCount) {
+    device = c_device;
+    hostAllocator = allocator;
+
+    // 每个缓冲单独重置，只重录脏的 slot
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    poolInfo.queueFamilyIndex = queueFamily;
+    if (vkd.vkCreateCommandPool(device, &poolInfo, hostAllocator, &pool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create command cache pool!");
+    }
+
+    std::vector<VkCommandBuffer> buffers(slotCount);
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = pool;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+    allocInfo.commandBufferCount = slotCount;
+    if (vkd.vkAllocateCommandBuffers(device, &allocInfo, buffers.data()) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate cached command buffers!");
+    }
+    slots.assign(slotCount, Slot{});
+    for (uint32_t i = 0; i < slotCount; ++i) {
+        slots[i].buffer = buffers[i];
+    }
+}
+
+VkCommandBuffer CommandCache::get(uint32_t slot, const commandCacheKey& key, VkRenderPass renderPass, uint32_t subpass,
+                                  const std::function<void(VkCommandBuffer)>& record) {
+    Slot& cached = slots.at(slot);
+    if (cached.valid && cached.key == key) {
+        ++counters.reuses;
+        return cached.buffer;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    vkd.vkResetCommandBuffer(cached.buffer, 0);
+    VkCommandBufferInheritanceInfo inheritance{};
+    inheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritance.renderPass = renderPass;
+    inheritance.subpass = subpass;
+    inheritance.framebuffer = key.framebuffer;
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+    beginInfo.pInheritanceInfo = &inheritance;
+    if (vkd.vkBeginCommandBuffer(cached.buffer, &beginInfo) != VK_SUCCESS) {
+        throw std::runtime_error("failed to begin cached command buffer!");
+    }
+    record(cached.buffer);
+    if (vkd.vkEndCommandBuffer(cached.buffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to record cached command buffer!");
+    }
+    cached.key = key;
+    cached.valid = true;
+    ++counters.records;
+    counters.lastRecordMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return cached.buffer;
+}
+
+void CommandCache::invalidate() {
+    for (Slot& slot : slots) {
+        slot.valid = false;
+    }
+}
+
+void CommandCache::destroy() {
+    if (pool != VK_NULL_HANDLE) {
+        // the pool frees its buffers
+        vkd.vkDestroyCommandPool(device, pool, hostAllocator);
+        pool = VK_NULL_HANDLE;
+    }
+    slots.clear();
+}
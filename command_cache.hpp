@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+/* Pre-recorded secondary command buffers for one render pass.
+ * One buffer per slot (swap chain image / framebuffer). A slot is recorded
+ * again only when its key changed : the pipelines, the framebuffer, the
+ * extent or the draw list version it was recorded with. In a steady scene
+ * the primary buffer only begins the pass and executes the cached buffer.
+ * Frame dependent commands (queries resets, uploads, copies) stay in the
+ * primary buffer.
+ */
+
+struct commandCacheKey
+{
+    uint64_t pipelines = 0;         // hash of the bound pipeline handles / layout
+    VkFramebuffer framebuffer = VK_NULL_HANDLE;
+    VkExtent2D extent{};
+    uint64_t drawListVersion = 0;
+    bool operator==(const commandCacheKey& other) const {
+        return pipelines == other.pipelines && framebuffer == other.framebuffer &&
+               extent.width == other.extent.width && extent.height == other.extent.height &&
+               drawListVersion == other.drawListVersion;
+    }
+};
+
+struct commandCacheStats
+{
+    uint64_t records = 0;           // slots (re)recorded
+    uint64_t reuses = 0;            // frames that executed a cached buffer as is
+    double lastRecordMs = 0.0;
+};
+
+class CommandCache
+{
+public:
+    void init(VkDevice device, const VkAllocationCallbacks* allocator, uint32_t queueFamily, uint32_t slotCount);
+    void destroy();
+    bool enabled() const { return pool != VK_NULL_HANDLE; }
+
+    // the buffer of `slot`, recorded through `record` first if the key changed.
+    // Must not be called while a submission using the slot is pending.
+    VkCommandBuffer get(uint32_t slot, const commandCacheKey& key, VkRenderPass renderPass, uint32_t subpass,
+                        const std::function<void(VkCommandBuffer)>& record);
+    void invalidate();              // every slot records again on its next use
+    const commandCacheStats& stats() const { return counters; }
+private:
+    struct Slot
+    {
+        VkCommandBuffer buffer = VK_NULL_HANDLE;
+        commandCacheKey key{};
+        bool valid = false;
+    };
+private:
+    VkDevice device = VK_NULL_HANDLE;
+    const VkAllocationCallbacks* hostAllocator = nullptr;
+    VkCommandPool pool = VK_NULL_HANDLE;
+    std::vector<Slot> slots;
+    commandCacheStats counters{};
+};
+
+// FNV-1a over handles, for commandCacheKey::pipelines
+template <typename Handle>
+uint64_t hashHandles(const Handle* handles, size_t count, uint64_t hash = 14695981039346656037ull) {
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t value = 0;     // pointers on 64-bit, uint64_t on 32-bit builds
+        std::memcpy(&value, &handles[i], sizeof(Handle));
+        hash = (hash ^ value) * 1099511628211ull;
+    }
+    return hash;
+}
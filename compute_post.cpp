@@ -0,0 +1,375 @@
+#include "compute_post.hpp"
+#include "vk_dispatch.hpp"
+#include <stdexcept>
+
+namespace {
+
+VkImageMemoryBarrier imageBarrier(VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout,
+                                  VkAccessFlags srcAccess, VkAccessFlags dstAccess,
+                                  uint32_t srcFamily = VK_QUEUE_FAMILY_IGNORED,
+                                  uint32_t dstFamily = VK_QUEUE_FAMILY_IGNORED) {
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = srcAccess;
+    barrier.dstAccessMask = dstAccess;
+    barrier.oldLayout = oldLayout;
+    barrier.newLayout = newLayout;
+    barrier.srcQueueFamilyIndex = srcFamily;
+    barrier.dstQueueFamilyIndex = dstFamily;
+    barrier.image = image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+    return barrier;
+}
+
+} // namespace
+
+compositeMode ComputePost::chooseComposite(VkPhysicalDevice physicalDevice, VkFormat target) {
+    VkFormatProperties source{};
+    VkFormatProperties destination{};
+    vkd.vkGetPhysicalDeviceFormatProperties(physicalDevice, outputFormat, &source);
+    vkd.vkGetPhysicalDeviceFormatProperties(physicalDevice, target, &destination);
+    if ((source.optimalTilingFeatures & VK_FORMAT_FEATURE_BLIT_SRC_BIT) != 0 &&
+            (destination.optimalTilingFeatures & VK_FORMAT_FEATURE_BLIT_DST_BIT) != 0) {
+        return compositeMode::Blit;
+    }
+    // 复制不做格式转换：只接受与输出相同的 RGBA8 布局（SRGB 目标不会再编码一次）
+    if (target == VK_FORMAT_R8G8B8A8_UNORM || target == VK_FORMAT_R8G8B8A8_SRGB) {
+        return compositeMode::Copy;
+    }
+    throw std::runtime_error("Swap chain format supports neither blit nor copy from the post output, compute post unsupported!");
+}
+
+void ComputePost::init(VkPhysicalDevice c_physicalDevice, VkDevice c_device, const VkAllocationCallbacks* allocator,
+                       VkExtent2D c_extent, uint32_t c_graphicsFamily, uint32_t c_computeFamily, uint32_t slotCount,
+                       compositeMode c_composite, const std::vector<char>& tonemapCode, const std::vector<char>& blurCode) {
+    physicalDevice = c_physicalDevice;
+    device = c_device;
+    hostAllocator = allocator;
+    extent = c_extent;
+    graphicsFamily = c_graphicsFamily;
+    computeFamily = c_computeFamily;
+    compositing = c_composite;
+    frames.resize(slotCount);
+
+    for (Frame& frame : frames) {
+        frame.scene = createImage(sceneFormat, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_STORAGE_BIT);
+        frame.tonemapped = createImage(outputFormat, VK_IMAGE_USAGE_STORAGE_BIT);
+        frame.output = createImage(outputFormat, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT);
+    }
+
+    // 两个存储图像：binding 0 输入，binding 1 输出
+    VkDescriptorSetLayoutBinding bindings[2]{};
+    for (uint32_t i = 0; i < 2; ++i) {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = 2;
+    layoutInfo.pBindings = bindings;
+    if (vkd.vkCreateDescriptorSetLayout(device, &layoutInfo, hostAllocator, &setLayout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create post descriptor set layout!");
+    }
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &setLayout;
+    if (vkd.vkCreatePipelineLayout(device, &pipelineLayoutInfo, hostAllocator, &pipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create post pipeline layout!");
+    }
+    // workgroup size and exposure are specialized, the dispatch size follows the chosen key
+    tonemapModule = createShaderModule(tonemapCode);
+    blurModule = createShaderModule(blurCode);
+    std::vector<specConstant> workgroup = {{"WORKGROUP_X", 0, 8}, {"WORKGROUP_Y", 1, 8}};
+    std::vector<specConstant> tonemapConstants = workgroup;
+    tonemapConstants.push_back({"EXPOSURE", 2, specFloat(1.f)});
+    tonemapVariants = ShaderVariants(tonemapConstants, [this](const variantKey&, const VkSpecializationInfo& specialization) {
+        return createPipeline(tonemapModule, specialization);
+    });
+    blurVariants = ShaderVariants(workgroup, [this](const variantKey&, const VkSpecializationInfo& specialization) {
+        return createPipeline(blurModule, specialization);
+    });
+    variantKey tonemapKey = tonemapVariants.defaults();
+    variantKey blurKey = blurVariants.defaults();
+    workgroupX = blurVariants.value(blurKey, "WORKGROUP_X");
+    workgroupY = blurVariants.value(blurKey, "WORKGROUP_Y");
+    tonemapPipeline = tonemapVariants.get(tonemapKey);
+    blurPipeline = blurVariants.get(blurKey);
+    createDescriptors();
+
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.queueFamilyIndex = computeFamily;
+    if (vkd.vkCreateCommandPool(device, &poolInfo, hostAllocator, &commandPool) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create compute command pool!");
+    }
+    std::vector<VkCommandBuffer> commandBuffers(frames.size());
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = commandPool;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = static_cast<uint32_t>(commandBuffers.size());
+    if (vkd.vkAllocateCommandBuffers(device, &allocInfo, commandBuffers.data()) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate compute command buffers!");
+    }
+
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    for (size_t i = 0; i < frames.size(); ++i) {
+        Frame& frame = frames[i];
+        frame.commandBuffer = commandBuffers[i];
+        if (vkd.vkCreateSemaphore(device, &semaphoreInfo, hostAllocator, &frame.sceneReady) != VK_SUCCESS ||
+                vkd.vkCreateSemaphore(device, &semaphoreInfo, hostAllocator, &frame.postReady) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create post semaphores!");
+        }
+        // the chain never changes, record once and resubmit every frame
+        recordCompute(frame);
+    }
+}
+
+ComputePost::Image ComputePost::createImage(VkFormat format, VkImageUsageFlags usage) {
+    Image result{};
+    VkImageCreateInfo imageInfo{};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = format;
+    imageInfo.extent = {extent.width, extent.height, 1};
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = usage;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE; // ownership is transferred explicitly
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    if (vkd.vkCreateImage(device, &imageInfo, hostAllocator, &result.image) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create post image!");
+    }
+
+    VkMemoryRequirements memRequirements;
+    vkd.vkGetImageMemoryRequirements(device, result.image, &memRequirements);
+    VkPhysicalDeviceMemoryProperties memProperties;
+    vkd.vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
+    uint32_t typeIndex = UINT32_MAX;
+    for (uint32_t i = 0; i < memProperties.memoryTypeCount; ++i) {
+        if ((memRequirements.memoryTypeBits & (1u << i)) &&
+            (memProperties.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)) {
+            typeIndex = i;
+            break;
+        }
+    }
+    if (typeIndex == UINT32_MAX) {
+        throw std::runtime_error("Failed to find device local memory for post image!");
+    }
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = memRequirements.size;
+    allocInfo.memoryTypeIndex = typeIndex;
+    if (vkd.vkAllocateMemory(device, &allocInfo, hostAllocator, &result.memory) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate post image memory!");
+    }
+    vkd.vkBindImageMemory(device, result.image, result.memory, 0);
+
+    VkImageViewCreateInfo viewInfo{};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = result.image;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = format;
+    viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    viewInfo.subresourceRange.baseMipLevel = 0;
+    viewInfo.subresourceRange.levelCount = 1;
+    viewInfo.subresourceRange.baseArrayLayer = 0;
+    viewInfo.subresourceRange.layerCount = 1;
+    if (vkd.vkCreateImageView(device, &viewInfo, hostAllocator, &result.view) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create post image view!");
+    }
+    return result;
+}
+
+VkShaderModule ComputePost::createShaderModule(const std::vector<char>& code) {
+    VkShaderModuleCreateInfo moduleInfo{};
+    moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    moduleInfo.codeSize = code.size();
+    moduleInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+    VkShaderModule shaderModule;
+    if (vkd.vkCreateShaderModule(device, &moduleInfo, hostAllocator, &shaderModule) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create compute shader module!");
+    }
+    return shaderModule;
+}
+
+VkPipeline ComputePost::createPipeline(VkShaderModule shaderModule, const VkSpecializationInfo& specialization) {
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = shaderModule;
+    pipelineInfo.stage.pName = "main";
+    pipelineInfo.stage.pSpecializationInfo = &specialization;
+    pipelineInfo.layout = pipelineLayout;
+    VkPipeline pipeline;
+    if (vkd.vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, hostAllocator, &pipeline) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create compute pipeline!");
+    }
+    return pipeline;
+}
+
+void ComputePost::createDescriptors() {
+    VkDescriptorPoolSize poolSize{};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    poolSize.descriptorCount = static_cast<uint32_t>(frames.size()) * 4;
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.maxSets = static_cast<uint32_t>(frames.size()) * 2;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    if (vkd.vkCreateDescriptorPool(device, &poolInfo, hostAllocator, &descriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create post descriptor pool!");
+    }
+
+    for (Frame& frame : frames) {
+        VkDescriptorSetLayout layouts[2] = {setLayout, setLayout};
+        VkDescriptorSet sets[2];
+        VkDescriptorSetAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = descriptorPool;
+        allocInfo.descriptorSetCount = 2;
+        allocInfo.pSetLayouts = layouts;
+        if (vkd.vkAllocateDescriptorSets(device, &allocInfo, sets) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to allocate post descriptor sets!");
+        }
+        frame.tonemapSet = sets[0];
+        frame.blurSet = sets[1];
+
+        VkDescriptorImageInfo imageInfos[4]{};
+        VkImageView views[4] = {frame.scene.view, frame.tonemapped.view, frame.tonemapped.view, frame.output.view};
+        VkWriteDescriptorSet writes[4]{};
+        for (uint32_t i = 0; i < 4; ++i) {
+            imageInfos[i].imageView = views[i];
+            imageInfos[i].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+            writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[i].dstSet = i < 2 ? frame.tonemapSet : frame.blurSet;
+            writes[i].dstBinding = i % 2;
+            writes[i].descriptorCount = 1;
+            writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+            writes[i].pImageInfo = &imageInfos[i];
+        }
+        vkd.vkUpdateDescriptorSets(device, 4, writes, 0, nullptr);
+    }
+}
+
+// --- Command recording --- //
+void ComputePost::recordCompute(Frame& frame) {
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    if (vkd.vkBeginCommandBuffer(frame.commandBuffer, &beginInfo) != VK_SUCCESS) {
+        throw std::runtime_error("failed to begin recording compute command buffer!");
+    }
+
+    // acquire the scene from the graphics family (same layouts as its release), discard the old
+    // contents of the intermediates but wait for the previous compute work still reading them
+    std::vector<VkImageMemoryBarrier> acquire;
+    if (ownershipTransfer()) {
+        acquire.push_back(imageBarrier(frame.scene.image, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL,
+                                       0, VK_ACCESS_SHADER_READ_BIT, graphicsFamily, computeFamily));
+    }
+    acquire.push_back(imageBarrier(frame.tonemapped.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+                                   0, VK_ACCESS_SHADER_WRITE_BIT));
+    acquire.push_back(imageBarrier(frame.output.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+                                   0, VK_ACCESS_SHADER_WRITE_BIT));
+    vkd.vkCmdPipelineBarrier(frame.commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(acquire.size()), acquire.data());
+
+    uint32_t groupsX = (extent.width + workgroupX - 1) / workgroupX;
+    uint32_t groupsY = (extent.height + workgroupY - 1) / workgroupY;
+    vkd.vkCmdBindPipeline(frame.commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, tonemapPipeline);
+    vkd.vkCmdBindDescriptorSets(frame.commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &frame.tonemapSet, 0, nullptr);
+    vkd.vkCmdDispatch(frame.commandBuffer, groupsX, groupsY, 1);
+
+    VkImageMemoryBarrier tonemapDone = imageBarrier(frame.tonemapped.image, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL,
+                                                    VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+    vkd.vkCmdPipelineBarrier(frame.commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &tonemapDone);
+
+    vkd.vkCmdBindPipeline(frame.commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, blurPipeline);
+    vkd.vkCmdBindDescriptorSets(frame.commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &frame.blurSet, 0, nullptr);
+    vkd.vkCmdDispatch(frame.commandBuffer, groupsX, groupsY, 1);
+
+    // release the result to the graphics family, it is blitted / copied from TRANSFER_SRC_OPTIMAL
+    VkImageMemoryBarrier release = imageBarrier(frame.output.image, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                                VK_ACCESS_SHADER_WRITE_BIT, 0,
+                                                ownershipTransfer() ? computeFamily : VK_QUEUE_FAMILY_IGNORED,
+                                                ownershipTransfer() ? graphicsFamily : VK_QUEUE_FAMILY_IGNORED);
+    vkd.vkCmdPipelineBarrier(frame.commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &release);
+
+    if (vkd.vkEndCommandBuffer(frame.commandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to record compute command buffer!");
+    }
+}
+
+void ComputePost::recordComposite(VkCommandBuffer commandBuffer, uint32_t slot, VkImage dst) const {
+    const Frame& frame = frames[slot];
+    if (ownershipTransfer()) {
+        VkImageMemoryBarrier acquire = imageBarrier(frame.output.image, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                                    0, VK_ACCESS_TRANSFER_READ_BIT, computeFamily, graphicsFamily);
+        vkd.vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                 0, 0, nullptr, 0, nullptr, 1, &acquire);
+    }
+
+    if (compositing == compositeMode::Copy) {
+        VkImageCopy region{};
+        region.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.srcSubresource.layerCount = 1;
+        region.dstSubresource = region.srcSubresource;
+        region.extent = {extent.width, extent.height, 1};
+        vkd.vkCmdCopyImage(commandBuffer, frame.output.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                           dst, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+        return;
+    }
+    VkImageBlit region{};
+    region.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.srcSubresource.layerCount = 1;
+    region.srcOffsets[1] = {static_cast<int32_t>(extent.width), static_cast<int32_t>(extent.height), 1};
+    region.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.dstSubresource.layerCount = 1;
+    region.dstOffsets[1] = region.srcOffsets[1];
+    vkd.vkCmdBlitImage(commandBuffer, frame.output.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                       dst, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region, VK_FILTER_NEAREST);
+}
+
+// --- Cleanup --- //
+void ComputePost::destroyImage(Image& image) {
+    vkd.vkDestroyImageView(device, image.view, hostAllocator);
+    vkd.vkDestroyImage(device, image.image, hostAllocator);
+    vkd.vkFreeMemory(device, image.memory, hostAllocator);
+    image = {};
+}
+
+void ComputePost::destroy() {
+    if (device == VK_NULL_HANDLE) {
+        return;
+    }
+    for (Frame& frame : frames) {
+        vkd.vkDestroySemaphore(device, frame.sceneReady, hostAllocator);
+        vkd.vkDestroySemaphore(device, frame.postReady, hostAllocator);
+        destroyImage(frame.scene);
+        destroyImage(frame.tonemapped);
+        destroyImage(frame.output);
+    }
+    frames.clear();
+    vkd.vkDestroyCommandPool(device, commandPool, hostAllocator);
+    vkd.vkDestroyDescriptorPool(device, descriptorPool, hostAllocator);
+    tonemapVariants.destroy(device, hostAllocator);
+    blurVariants.destroy(device, hostAllocator);
+    vkd.vkDestroyShaderModule(device, tonemapModule, hostAllocator);
+    vkd.vkDestroyShaderModule(device, blurModule, hostAllocator);
+    vkd.vkDestroyPipelineLayout(device, pipelineLayout, hostAllocator);
+    vkd.vkDestroyDescriptorSetLayout(device, setLayout, hostAllocator);
+    device = VK_NULL_HANDLE;
+}
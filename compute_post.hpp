@@ -0,0 +1,93 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "shader_variants.hpp"
+
+/* Compute post-processing chain on the async compute queue.
+ * Frame N renders into sceneImage(N % slots) on the graphics queue and
+ * releases it to the compute family; the compute queue tonemaps it and blurs
+ * the result into outputImage(slot), which the graphics queue of frame N + 1
+ * acquires and blits into the swap chain image. Compute work of frame N thus
+ * overlaps the scene rendering of frame N + 1.
+ * A swap chain format that can't be a blit destination is copied to instead,
+ * which only works for the same RGBA8 layout as the output.
+ * When graphics and compute share a family no ownership transfer is recorded.
+ */
+
+enum class compositeMode : uint8_t { Blit, Copy };
+
+class ComputePost
+{
+public:
+    static constexpr VkFormat sceneFormat = VK_FORMAT_R16G16B16A16_SFLOAT;
+    static constexpr VkFormat outputFormat = VK_FORMAT_R8G8B8A8_UNORM;
+
+    // how the result reaches an image of `target` format, throws when neither blit nor copy works
+    static compositeMode chooseComposite(VkPhysicalDevice physicalDevice, VkFormat target);
+
+    void init(VkPhysicalDevice physicalDevice, VkDevice device, const VkAllocationCallbacks* allocator,
+              VkExtent2D extent, uint32_t graphicsFamily, uint32_t computeFamily, uint32_t slotCount,
+              compositeMode composite, const std::vector<char>& tonemapCode, const std::vector<char>& blurCode);
+    void destroy();
+
+    bool ownershipTransfer() const { return graphicsFamily != computeFamily; }
+    uint32_t slots() const { return static_cast<uint32_t>(frames.size()); }
+    VkImage sceneImage(uint32_t slot) const { return frames[slot].scene.image; }
+    VkImageView sceneView(uint32_t slot) const { return frames[slot].scene.view; }
+    VkCommandBuffer commandBuffer(uint32_t slot) const { return frames[slot].commandBuffer; }
+    VkSemaphore sceneReady(uint32_t slot) const { return frames[slot].sceneReady; }
+    VkSemaphore postReady(uint32_t slot) const { return frames[slot].postReady; }
+
+    // graphics queue : acquire the result of `slot` and blit / copy it into dst (TRANSFER_DST_OPTIMAL)
+    void recordComposite(VkCommandBuffer commandBuffer, uint32_t slot, VkImage dst) const;
+private:
+    struct Image
+    {
+        VkImage image = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkImageView view = VK_NULL_HANDLE;
+    };
+    struct Frame
+    {
+        Image scene;        // rgba16f, rendered by the graphics queue
+        Image tonemapped;   // rgba8, tonemap output / blur input
+        Image output;       // rgba8, blur output, blitted to the swap chain
+        VkDescriptorSet tonemapSet = VK_NULL_HANDLE;
+        VkDescriptorSet blurSet = VK_NULL_HANDLE;
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        VkSemaphore sceneReady = VK_NULL_HANDLE;  // graphics -> compute
+        VkSemaphore postReady = VK_NULL_HANDLE;   // compute -> graphics
+    };
+private:
+    Image createImage(VkFormat format, VkImageUsageFlags usage);
+    void destroyImage(Image& image);
+    VkShaderModule createShaderModule(const std::vector<char>& code);
+    VkPipeline createPipeline(VkShaderModule shaderModule, const VkSpecializationInfo& specialization);
+    void createDescriptors();
+    void recordCompute(Frame& frame);
+private:
+    VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+    VkDevice device = VK_NULL_HANDLE;
+    const VkAllocationCallbacks* hostAllocator = nullptr;
+    VkExtent2D extent{};
+    uint32_t graphicsFamily = 0;
+    uint32_t computeFamily = 0;
+    compositeMode compositing = compositeMode::Blit;
+
+    VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;
+    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+    VkShaderModule tonemapModule = VK_NULL_HANDLE;
+    VkShaderModule blurModule = VK_NULL_HANDLE;
+    ShaderVariants tonemapVariants;     // WORKGROUP_X / WORKGROUP_Y / EXPOSURE
+    ShaderVariants blurVariants;        // WORKGROUP_X / WORKGROUP_Y
+    VkPipeline tonemapPipeline = VK_NULL_HANDLE;
+    VkPipeline blurPipeline = VK_NULL_HANDLE;
+    uint32_t workgroupX = 8;
+    uint32_t workgroupY = 8;
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    VkCommandPool commandPool = VK_NULL_HANDLE;
+    std::vector<Frame> frames;
+};
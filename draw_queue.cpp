@@ -0,0 +1,151 @@
+#include "draw_queue.hpp"
+#include "job_system.hpp"
+#include "vk_dispatch.hpp"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+constexpr uint32_t radix = 256;
+constexpr uint32_t parallelThreshold = 16384;   // smaller queues sort faster on one thread
+constexpr uint32_t minChunk = 8192;
+
+} // namespace
+
+void DrawQueue::clear() {
+    entries.clear();
+    packets.clear();
+    counters = {};
+    sorted = false;
+}
+
+void DrawQueue::push(uint64_t key, const drawPacket& packet) {
+    entries.push_back({key, static_cast<uint32_t>(packets.size())});
+    packets.push_back(packet);
+    ++counters.draws;
+}
+
+// pipeline / descriptor changes between neighbours, in the current order
+uint32_t DrawQueue::countStateChanges() const {
+    uint32_t changes = 0;
+    for (uint32_t i = 0; i < entries.size(); ++i) {
+        uint64_t key = entries[i].key;
+        if (i == 0) {
+            changes += sortKeyDescriptorSet(key) != noDescriptorSet ? 2 : 1;
+            continue;
+        }
+        uint64_t previous = entries[i - 1].key;
+        changes += sortKeyPipeline(key) != sortKeyPipeline(previous);
+        changes += sortKeyDescriptorSet(key) != sortKeyDescriptorSet(previous) &&
+                   sortKeyDescriptorSet(key) != noDescriptorSet;
+    }
+    return changes;
+}
+
+void DrawQueue::histogramChunk(uint32_t chunk, uint32_t chunks, uint32_t shift) {
+    uint32_t count = size();
+    uint32_t* histogram = histograms.data() + chunk * radix;
+    std::fill(histogram, histogram + radix, 0u);
+    for (uint32_t i = chunk * uint64_t(count) / chunks; i < (chunk + 1) * uint64_t(count) / chunks; ++i) {
+        ++histogram[(entries[i].key >> shift) & (radix - 1)];
+    }
+}
+
+void DrawQueue::scatterChunk(uint32_t chunk, uint32_t chunks, uint32_t shift) {
+    uint32_t count = size();
+    uint32_t* offsets = histograms.data() + chunk * radix;
+    for (uint32_t i = chunk * uint64_t(count) / chunks; i < (chunk + 1) * uint64_t(count) / chunks; ++i) {
+        scratch[offsets[(entries[i].key >> shift) & (radix - 1)]++] = entries[i];
+    }
+}
+
+// LSD radix sort on 8-bit digits; digits every key shares are skipped (layers, unused fields)
+void DrawQueue::sort(JobSystem* jobs) {
+    auto start = std::chrono::steady_clock::now();
+    uint32_t count = size();
+    counters.unsortedBinds = countStateChanges();
+    sorted = true;
+    if (count < 2) {
+        return;
+    }
+
+    uint64_t varying = 0;
+    for (const entry& e : entries) {
+        varying |= e.key ^ entries[0].key;
+    }
+    uint32_t chunks = 1;
+    if (jobs != nullptr && count >= parallelThreshold) {
+        chunks = std::clamp(count / minChunk, 1u, jobs->workerCount() + 1);
+    }
+    histograms.resize(chunks * radix);
+    scratch.resize(count);
+
+    for (uint32_t shift = 0; shift < 64; shift += 8) {
+        if (((varying >> shift) & (radix - 1)) == 0) {
+            continue;
+        }
+        ++counters.sortPasses;
+        auto forChunks = [&](auto&& work) {
+            if (chunks == 1) {
+                work(0);
+                return;
+            }
+            jobs->parallelFor(chunks, 1, [&](uint32_t first, uint32_t last) {
+                for (uint32_t chunk = first; chunk < last; ++chunk) work(chunk);
+            });
+        };
+        forChunks([&](uint32_t chunk) { histogramChunk(chunk, chunks, shift); });
+        // digit major, chunk minor : keeps equal digits in their original order (stable)
+        uint32_t offset = 0;
+        for (uint32_t digit = 0; digit < radix; ++digit) {
+            for (uint32_t chunk = 0; chunk < chunks; ++chunk) {
+                uint32_t& counter = histograms[chunk * radix + digit];
+                uint32_t digitCount = counter;
+                counter = offset;
+                offset += digitCount;
+            }
+        }
+        forChunks([&](uint32_t chunk) { scatterChunk(chunk, chunks, shift); });
+        entries.swap(scratch);
+    }
+    counters.sortMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void DrawQueue::beginRecording() {
+    if (!sorted) {
+        counters.unsortedBinds = countStateChanges();   // recorded in submission order
+    }
+    boundPipeline = UINT32_MAX;
+    boundDescriptorSet = UINT32_MAX;
+    counters.pipelineBinds = 0;
+    counters.descriptorBinds = 0;
+    counters.redundantBinds = 0;
+}
+
+void DrawQueue::record(VkCommandBuffer commandBuffer, uint32_t first, uint32_t last, const drawBindings& bindings) {
+    for (uint32_t i = first; i < last; ++i) {
+        uint64_t key = entries[i].key;
+        uint32_t pipeline = sortKeyPipeline(key);
+        if (pipeline != boundPipeline) {
+            vkd.vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                  bindings.pipelines[pipeline % bindings.pipelineCount]);
+            boundPipeline = pipeline;
+            ++counters.pipelineBinds;
+        } else {
+            ++counters.redundantBinds;
+        }
+        uint32_t descriptorSet = sortKeyDescriptorSet(key);
+        if (bindings.descriptorSets != nullptr && descriptorSet != noDescriptorSet) {
+            if (descriptorSet != boundDescriptorSet) {
+                vkd.vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, bindings.layout, 0, 1,
+                                            &bindings.descriptorSets[descriptorSet % bindings.descriptorSetCount], 0, nullptr);
+                boundDescriptorSet = descriptorSet;
+                ++counters.descriptorBinds;
+            } else {
+                ++counters.redundantBinds;
+            }
+        }
+        const drawPacket& packet = packets[entries[i].packet];
+        vkd.vkCmdDraw(commandBuffer, packet.vertexCount, packet.instanceCount, packet.firstVertex, packet.firstInstance);
+    }
+}
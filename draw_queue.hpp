@@ -0,0 +1,95 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+class JobSystem;
+
+/* Draw packet queue sorted by state.
+ * Every draw is pushed as a 64-bit sort key plus its draw parameters. The
+ * keys are radix sorted each frame (in parallel on the job system for large
+ * queues) and the recorder only binds a pipeline / descriptor set when it
+ * differs from the one already bound, so draws sharing state end up next to
+ * each other and the binds between them disappear.
+ *
+ *  63      56 55              40 39              24 23               0
+ * | layer 8  | pipeline 16      | descriptor 16    | depth 24          |
+ */
+
+constexpr uint32_t noDescriptorSet = 0xffff;
+
+// depth in [0, 1], front to back; pass 1 - depth for back to front layers (blending)
+inline uint64_t makeSortKey(uint32_t layer, uint32_t pipeline, uint32_t descriptorSet, float depth) {
+    float clamped = depth < 0.f ? 0.f : (depth > 1.f ? 1.f : depth);
+    uint64_t quantized = static_cast<uint64_t>(clamped * 16777215.f);
+    return (static_cast<uint64_t>(layer & 0xff) << 56) |
+           (static_cast<uint64_t>(pipeline & 0xffff) << 40) |
+           (static_cast<uint64_t>(descriptorSet & 0xffff) << 24) |
+           quantized;
+}
+inline uint32_t sortKeyLayer(uint64_t key) { return static_cast<uint32_t>(key >> 56); }
+inline uint32_t sortKeyPipeline(uint64_t key) { return static_cast<uint32_t>(key >> 40) & 0xffff; }
+inline uint32_t sortKeyDescriptorSet(uint64_t key) { return static_cast<uint32_t>(key >> 24) & 0xffff; }
+
+struct drawPacket
+{
+    uint32_t vertexCount = 0;
+    uint32_t instanceCount = 1;
+    uint32_t firstVertex = 0;
+    uint32_t firstInstance = 0;
+};
+
+// what the pipeline / descriptor fields of the keys index into
+struct drawBindings
+{
+    const VkPipeline* pipelines = nullptr;
+    uint32_t pipelineCount = 0;
+    VkPipelineLayout layout = VK_NULL_HANDLE;
+    const VkDescriptorSet* descriptorSets = nullptr;   // bound at set 0, may be null
+    uint32_t descriptorSetCount = 0;
+};
+
+struct drawQueueStats
+{
+    uint32_t draws = 0;
+    uint32_t pipelineBinds = 0;
+    uint32_t descriptorBinds = 0;
+    uint32_t redundantBinds = 0;    // skipped because the state was already bound
+    uint32_t unsortedBinds = 0;     // state changes the submission order would have needed
+    uint32_t sortPasses = 0;        // 8-bit digits that differed between keys
+    double sortMs = 0.0;
+};
+
+class DrawQueue
+{
+public:
+    void clear();
+    void push(uint64_t key, const drawPacket& packet);
+    // stable LSD radix sort, splits the passes over the job system when given one
+    void sort(JobSystem* jobs = nullptr);
+    uint32_t size() const { return static_cast<uint32_t>(entries.size()); }
+    uint64_t key(uint32_t index) const { return entries[index].key; }
+
+    void beginRecording();          // forget the bound state, at the start of each render pass
+    void record(VkCommandBuffer commandBuffer, uint32_t first, uint32_t last, const drawBindings& bindings);
+    const drawQueueStats& stats() const { return counters; }
+private:
+    struct entry
+    {
+        uint64_t key;
+        uint32_t packet;
+    };
+    uint32_t countStateChanges() const;
+    void histogramChunk(uint32_t chunk, uint32_t chunks, uint32_t shift);
+    void scatterChunk(uint32_t chunk, uint32_t chunks, uint32_t shift);
+private:
+    std::vector<entry> entries;
+    std::vector<entry> scratch;
+    std::vector<drawPacket> packets;
+    std::vector<uint32_t> histograms;   // 256 counters per chunk, then their scatter offsets
+    uint32_t boundPipeline = UINT32_MAX;
+    uint32_t boundDescriptorSet = UINT32_MAX;
+    bool sorted = false;
+    drawQueueStats counters{};
+};
@@ -0,0 +1,297 @@
+#include "frame_capture.hpp"
+#include "vk_dispatch.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+FrameCapture::~FrameCapture() {
+    if (writer.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            stopping = true;
+        }
+        queueCondition.notify_all();
+        writer.join();
+    }
+    if (file != nullptr) {
+        std::fclose(file);
+    }
+}
+
+void FrameCapture::init(VkPhysicalDevice physicalDevice, VkDevice c_device, const VkAllocationCallbacks* allocator,
+                        VkExtent2D c_extent, VkFormat format, uint32_t depth, const std::string& path,
+                        captureFormat c_fileFormat, uint32_t fps) {
+    switch (format) {
+    case VK_FORMAT_B8G8R8A8_UNORM:
+    case VK_FORMAT_B8G8R8A8_SRGB:
+        swapRedBlue = false;
+        break;
+    case VK_FORMAT_R8G8B8A8_UNORM:
+    case VK_FORMAT_R8G8B8A8_SRGB:
+        swapRedBlue = true;
+        break;
+    default:
+        throw std::runtime_error("Frame capture supports 8 bit RGBA / BGRA formats only!");
+    }
+    hostAllocator = allocator;
+    extent = c_extent;
+    fileFormat = c_fileFormat;
+    frameBytes = static_cast<VkDeviceSize>(extent.width) * extent.height * 4;
+    slotCount = std::max(depth, 1u);
+    slots = std::make_unique<Slot[]>(slotCount);
+
+    // cached memory makes the CPU side reads fast, coherent is the fallback
+    VkPhysicalDeviceMemoryProperties memProperties;
+    vkd.vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
+    auto findType = [&](uint32_t typeBits, VkMemoryPropertyFlags properties) -> int {
+        for (uint32_t i = 0; i < memProperties.memoryTypeCount; ++i) {
+            if ((typeBits & (1u << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    };
+
+    for (uint32_t index = 0; index < slotCount; ++index) {
+        Slot& slot = slots[index];
+        VkBufferCreateInfo bufferInfo{};
+        bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        bufferInfo.size = frameBytes;
+        bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        if (vkd.vkCreateBuffer(c_device, &bufferInfo, hostAllocator, &slot.buffer) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create capture buffer!");
+        }
+        VkMemoryRequirements memRequirements;
+        vkd.vkGetBufferMemoryRequirements(c_device, slot.buffer, &memRequirements);
+        int typeIndex = findType(memRequirements.memoryTypeBits,
+                                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+        if (typeIndex < 0) {
+            typeIndex = findType(memRequirements.memoryTypeBits,
+                                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        }
+        if (typeIndex < 0) {
+            throw std::runtime_error("Failed to find host visible memory for capture!");
+        }
+        coherent = (memProperties.memoryTypes[typeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+
+        VkMemoryAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.allocationSize = memRequirements.size;
+        allocInfo.memoryTypeIndex = static_cast<uint32_t>(typeIndex);
+        if (vkd.vkAllocateMemory(c_device, &allocInfo, hostAllocator, &slot.memory) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to allocate capture memory!");
+        }
+        vkd.vkBindBufferMemory(c_device, slot.buffer, slot.memory, 0);
+        void* mapped = nullptr;
+        if (vkd.vkMapMemory(c_device, slot.memory, 0, VK_WHOLE_SIZE, 0, &mapped) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to map capture memory!");
+        }
+        slot.mapped = static_cast<const uint8_t*>(mapped);
+    }
+
+    file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        throw std::runtime_error("Failed to open capture file: " + path);
+    }
+    if (fileFormat == captureFormat::Y4M) {
+        if (std::fprintf(file, "YUV4MPEG2 W%u H%u F%u:1 Ip A1:1 C444\n", extent.width, extent.height, fps) < 0) {
+            throw std::runtime_error("Failed to write capture header: " + path);
+        }
+        convertBuffer.resize(6 + static_cast<size_t>(frameBytes / 4) * 3);
+    }
+    device = c_device;
+    stopping = false;
+    writeFailed.store(false);
+    frameStats = {};
+    writer = std::thread(&FrameCapture::writerLoop, this);
+}
+
+bool FrameCapture::recordCopy(VkCommandBuffer commandBuffer, VkImage image, uint64_t frameSerial) {
+    if (writeFailed.load(std::memory_order_relaxed)) {
+        return false; // the capture ended with a write error
+    }
+    Slot& slot = slots[nextSlot];
+    if (slot.state.load(std::memory_order_acquire) != Free) {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        ++frameStats.dropped;
+        return false;
+    }
+    nextSlot = (nextSlot + 1) % slotCount;
+
+    VkBufferImageCopy region{};
+    region.bufferOffset = 0;
+    region.bufferRowLength = 0;   // tightly packed
+    region.bufferImageHeight = 0;
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = 0;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset = {0, 0, 0};
+    region.imageExtent = {extent.width, extent.height, 1};
+    vkd.vkCmdCopyImageToBuffer(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, slot.buffer, 1, &region);
+
+    // make the copy visible to host reads once the fence has signaled
+    VkBufferMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer = slot.buffer;
+    barrier.offset = 0;
+    barrier.size = VK_WHOLE_SIZE;
+    vkd.vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0,
+                             0, nullptr, 1, &barrier, 0, nullptr);
+
+    slot.frameSerial = frameSerial;
+    slot.state.store(Recorded, std::memory_order_release);
+    std::lock_guard<std::mutex> lock(queueMutex);
+    ++frameStats.captured;
+    return true;
+}
+
+void FrameCapture::frameCompleted(uint64_t frameSerial) {
+    std::vector<uint32_t> ready;
+    for (uint32_t index = 0; index < slotCount; ++index) {
+        if (slots[index].state.load(std::memory_order_acquire) == Recorded && slots[index].frameSerial <= frameSerial) {
+            ready.push_back(index);
+        }
+    }
+    if (ready.empty()) {
+        return;
+    }
+    std::sort(ready.begin(), ready.end(), [&](uint32_t a, uint32_t b) {
+        return slots[a].frameSerial < slots[b].frameSerial;
+    });
+    for (uint32_t index : ready) {
+        if (!coherent) {
+            VkMappedMemoryRange range{};
+            range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+            range.memory = slots[index].memory;
+            range.offset = 0;
+            range.size = VK_WHOLE_SIZE;
+            vkd.vkInvalidateMappedMemoryRanges(device, 1, &range);
+        }
+        slots[index].state.store(Queued, std::memory_order_release);
+    }
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        writeQueue.insert(writeQueue.end(), ready.begin(), ready.end());
+    }
+    queueCondition.notify_one();
+}
+
+// --- Writer thread --- //
+void FrameCapture::writerLoop() {
+    for (;;) {
+        uint32_t index;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueCondition.wait(lock, [this] { return stopping || !writeQueue.empty(); });
+            if (writeQueue.empty()) {
+                return; // stopping and drained
+            }
+            index = writeQueue.front();
+            writeQueue.pop_front();
+        }
+        // after a failure the queued frames are only released
+        size_t expected = 0;
+        size_t bytes = 0;
+        int error = 0;
+        auto start = std::chrono::steady_clock::now();
+        if (!writeFailed.load(std::memory_order_relaxed)) {
+            bytes = writeFrame(slots[index].mapped, expected);
+            error = errno;
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        slots[index].state.store(Free, std::memory_order_release);
+
+        std::lock_guard<std::mutex> lock(queueMutex);
+        frameStats.bytesWritten += bytes;
+        frameStats.writerSeconds += seconds;
+        if (expected == 0) {
+            continue;
+        }
+        if (bytes == expected) {
+            ++frameStats.written;
+        } else {
+            fail("write", error);
+        }
+    }
+}
+
+void FrameCapture::fail(const char* what, int error) {
+    if (!frameStats.failed) {
+        std::cerr << "Frame capture " << what << " failed after " << frameStats.written << " frames: "
+                  << std::strerror(error) << ", capture stopped" << std::endl;
+    }
+    frameStats.failed = true;
+    writeFailed.store(true);
+}
+
+// one fwrite per frame, the stream stays a single large sequential write
+size_t FrameCapture::writeFrame(const uint8_t* pixels, size_t& expected) {
+    if (fileFormat == captureFormat::Raw) {
+        expected = static_cast<size_t>(frameBytes);
+        return std::fwrite(pixels, 1, expected, file);
+    }
+    // BT.601 limited range, 4:4:4 planar
+    const size_t planeSize = static_cast<size_t>(extent.width) * extent.height;
+    uint8_t* out = convertBuffer.data();
+    std::copy_n("FRAME\n", 6, out);
+    uint8_t* planeY = out + 6;
+    uint8_t* planeU = planeY + planeSize;
+    uint8_t* planeV = planeU + planeSize;
+    const int r = swapRedBlue ? 0 : 2;
+    const int b = swapRedBlue ? 2 : 0;
+    for (size_t i = 0; i < planeSize; ++i) {
+        const uint8_t* pixel = pixels + i * 4;
+        int R = pixel[r], G = pixel[1], B = pixel[b];
+        planeY[i] = static_cast<uint8_t>(((66 * R + 129 * G + 25 * B + 128) >> 8) + 16);
+        planeU[i] = static_cast<uint8_t>(((-38 * R - 74 * G + 112 * B + 128) >> 8) + 128);
+        planeV[i] = static_cast<uint8_t>(((112 * R - 94 * G - 18 * B + 128) >> 8) + 128);
+    }
+    expected = convertBuffer.size();
+    return std::fwrite(convertBuffer.data(), 1, expected, file);
+}
+
+captureStats FrameCapture::stats() {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return frameStats;
+}
+
+// --- Cleanup --- //
+void FrameCapture::shutdown() {
+    if (!enabled()) {
+        return;
+    }
+    frameCompleted(UINT64_MAX);
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    queueCondition.notify_all();
+    writer.join();
+    // buffered frames only reach the disk here
+    bool flushed = std::fflush(file) == 0;
+    int error = errno;
+    bool closed = std::fclose(file) == 0;
+    file = nullptr;
+    if (!flushed || !closed) {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        fail(flushed ? "close" : "flush", flushed ? errno : error);
+    }
+
+    for (uint32_t index = 0; index < slotCount; ++index) {
+        vkd.vkUnmapMemory(device, slots[index].memory);
+        vkd.vkDestroyBuffer(device, slots[index].buffer, hostAllocator);
+        vkd.vkFreeMemory(device, slots[index].memory, hostAllocator);
+    }
+    slots.reset();
+    slotCount = 0;
+    device = VK_NULL_HANDLE;
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+/* Asynchronous frame readback.
+ * Each captured frame is copied (vkCmdCopyImageToBuffer) into one slot of a
+ * pool of persistently mapped host-visible buffers. Once the frame's fence has
+ * signaled the slot is handed to a writer thread that streams it to disk, so
+ * the render loop never waits for the readback. When every slot is still busy
+ * the frame is dropped instead of stalling. A failed write (disk full ...)
+ * is reported once and ends the capture, later frames are not copied.
+ */
+
+enum class captureFormat { Raw, Y4M };
+
+struct captureStats
+{
+    uint64_t captured = 0;       // frames copied on the GPU
+    uint64_t dropped = 0;        // frames skipped because all slots were busy
+    uint64_t written = 0;        // frames written to disk
+    uint64_t bytesWritten = 0;   // what fwrite accepted
+    bool failed = false;         // a write failed, the capture stopped there
+    double writerSeconds = 0.0;  // time the writer spent converting + writing
+    double throughputMBps() const {
+        return writerSeconds > 0.0 ? bytesWritten / writerSeconds / (1024.0 * 1024.0) : 0.0;
+    }
+};
+
+class FrameCapture
+{
+public:
+    FrameCapture() = default;
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+    ~FrameCapture();
+
+    void init(VkPhysicalDevice physicalDevice, VkDevice device, const VkAllocationCallbacks* allocator,
+              VkExtent2D extent, VkFormat format,
+              uint32_t depth, const std::string& path, captureFormat fileFormat, uint32_t fps = 60);
+    // image must be in TRANSFER_SRC_OPTIMAL, returns false if the frame was dropped
+    bool recordCopy(VkCommandBuffer commandBuffer, VkImage image, uint64_t frameSerial);
+    // every frame up to frameSerial has finished on the GPU
+    void frameCompleted(uint64_t frameSerial);
+    // device must be idle, flushes pending frames and joins the writer
+    void shutdown();
+
+    bool enabled() const { return device != VK_NULL_HANDLE; }
+    captureStats stats();
+private:
+    enum slotState : uint8_t { Free, Recorded, Queued };
+    struct Slot
+    {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        const uint8_t* mapped = nullptr;
+        uint64_t frameSerial = 0;
+        std::atomic<uint8_t> state{Free};
+    };
+private:
+    void writerLoop();
+    size_t writeFrame(const uint8_t* pixels, size_t& expected);   // bytes written
+    void fail(const char* what, int error);  // queueMutex held
+private:
+    VkDevice device = VK_NULL_HANDLE;
+    const VkAllocationCallbacks* hostAllocator = nullptr;
+    VkExtent2D extent{};
+    bool swapRedBlue = false;    // source is RGBA instead of BGRA
+    bool coherent = true;
+    VkDeviceSize frameBytes = 0;
+    std::unique_ptr<Slot[]> slots;   // Slot holds an atomic, not movable
+    uint32_t slotCount = 0;
+    uint32_t nextSlot = 0;
+
+    captureFormat fileFormat = captureFormat::Raw;
+    std::FILE* file = nullptr;
+    std::vector<uint8_t> convertBuffer;  // Y4M planes of one frame, writer thread only
+
+    std::thread writer;
+    std::mutex queueMutex;
+    std::condition_variable queueCondition;
+    std::deque<uint32_t> writeQueue;
+    bool stopping = false;
+    std::atomic<bool> writeFailed{false};
+    captureStats frameStats;             // guarded by queueMutex
+};
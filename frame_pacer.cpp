@@ -0,0 +1,104 @@
+#include "frame_pacer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace {
+
+constexpr double safetyMargin = 0.001;   // seconds kept between the estimated frame end and its deadline
+constexpr double minOversleep = 0.0002;
+constexpr double maxOversleep = 0.02;    // default Windows timer resolution is 15.6 ms
+
+double seconds(FramePacer::clock::duration duration) {
+    return std::chrono::duration<double>(duration).count();
+}
+
+// fast attack, slow release : a spike is followed at once, it is forgotten over ~50 samples
+double track(double estimate, double sample) {
+    return sample > estimate ? sample : estimate + (sample - estimate) * 0.02;
+}
+
+} // namespace
+
+void FramePacer::configure(const framePacing& c_pacing, double refreshRate, bool vsync) {
+    pacing = c_pacing;
+    period = 0.0;
+    refreshPeriod = vsync && refreshRate > 0.0 ? 1.0 / refreshRate : 0.0;
+    if (pacing.fpsCap > 0.0) {
+        period = 1.0 / pacing.fpsCap;
+    } else if (pacing.justInTimeInput && vsync && refreshRate > 0.0) {
+        period = 1.0 / refreshRate;
+    }
+    started = false;
+}
+
+void FramePacer::sleepUntil(clock::time_point deadline) {
+    auto now = clock::now();
+    // coarse sleep up to the expected oversleep, then spin
+    double remaining = seconds(deadline - now);
+    if (remaining > oversleep) {
+        double requested = remaining - oversleep;
+        std::this_thread::sleep_for(std::chrono::duration<double>(requested));
+        auto woke = clock::now();
+        double late = seconds(woke - now) - requested;
+        oversleep = std::clamp(track(oversleep, late), minOversleep, maxOversleep);
+        counters.sleptSeconds += seconds(woke - now);
+        now = woke;
+    } else {
+        // spin only : without a sample one late wake-up would keep us spinning for good
+        oversleep = std::max(minOversleep, oversleep * 0.98);
+    }
+    while (now < deadline) {
+        std::this_thread::yield();
+        now = clock::now();
+    }
+}
+
+void FramePacer::waitForFrameStart() {
+    if (!paced() || !started) {
+        return;
+    }
+    clock::time_point start;
+    if (pacing.justInTimeInput) {
+        // the previous frame ended around its deadline, leave just enough room for this one
+        auto deadline = lastEnd + std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(period));
+        start = deadline - std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(workEstimate + safetyMargin));
+    } else {
+        start = lastBegin + std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(period));
+    }
+    if (start > clock::now()) {
+        sleepUntil(start);
+    }
+}
+
+void FramePacer::inputSampled() {
+    lastInput = clock::now();
+    inputThisFrame = true;
+}
+
+void FramePacer::frameBegin() {
+    lastBegin = clock::now();
+    if (!inputThisFrame) {
+        lastInput = lastBegin;      // headless : nothing polled, the frame starts with its input
+    }
+    inputThisFrame = false;
+}
+
+void FramePacer::frameEnd() {
+    lastEnd = clock::now();
+    double work = seconds(lastEnd - lastBegin);
+    workEstimate = started ? track(workEstimate, work) : work;
+    started = true;
+    ++counters.frames;
+    // FIFO : at most one present per refresh, a late frame waits for the next vsync after it ended
+    clock::time_point present = lastEnd;
+    if (refreshPeriod > 0.0 && counters.frames > 1) {
+        double sincePrevious = seconds(lastEnd - lastPresent);
+        double refreshes = std::max(1.0, std::ceil(sincePrevious / refreshPeriod));
+        present = lastPresent + std::chrono::duration_cast<clock::duration>(
+            std::chrono::duration<double>(refreshes * refreshPeriod));
+    }
+    lastPresent = present;
+    inputAgeTotal += seconds(present - lastInput) * 1000.0;
+    counters.inputAgeMs = inputAgeTotal / counters.frames;
+}
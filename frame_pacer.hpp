@@ -0,0 +1,66 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+/* Frame pacing for the interactive main loop.
+ * - fps cap : frames start at most every 1 / fpsCap seconds
+ * - just-in-time input : the frame starts as late as possible before the
+ *   next deadline (estimated frame work + margin before it), so the input
+ *   sampled right before drawFrame() is as fresh as possible
+ * Input age runs from the input sampling to the predicted present : the
+ * frame's vsync with FIFO presents (one per refresh period after the last
+ * one), the end of the frame otherwise.
+ * Waits sleep coarsely and spin the rest; the spin window follows how late
+ * the OS actually wakes us up (timer granularity differs a lot between
+ * systems), so a cap costs little CPU and still hits its deadlines.
+ */
+
+struct framePacing
+{
+    double fpsCap = 0.0;            // frames per second, 0 : uncapped
+    bool waitWhenIdle = true;       // block in glfwWaitEventsTimeout while nothing needs a redraw
+    double idleTimeout = 0.5;       // seconds, wake up periodically even without events
+    bool justInTimeInput = false;   // start frames late, needs a cap or vsync to know the deadline
+};
+
+struct pacerStats
+{
+    uint64_t frames = 0;            // rendered by the paced loop
+    uint64_t idleWaits = 0;         // event waits instead of a frame (static scene / minimized)
+    double sleptSeconds = 0.0;      // spent in limiter sleeps
+    double inputAgeMs = 0.0;        // average time from input sampling to the predicted present
+};
+
+class FramePacer
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    // period between frame deadlines : the cap, or the display refresh with just-in-time input
+    void configure(const framePacing& pacing, double refreshRate, bool vsync);
+    bool paced() const { return period > 0.0; }
+
+    void waitForFrameStart();       // then sample input and call frameBegin()
+    void inputSampled();            // right after glfwPollEvents
+    void frameBegin();
+    void frameEnd();                // after present
+    void idleWait() { ++counters.idleWaits; }
+
+    void sleepUntil(clock::time_point deadline);
+    const pacerStats& stats() const { return counters; }
+    double workEstimateMs() const { return workEstimate * 1000.0; }
+private:
+    framePacing pacing{};
+    double period = 0.0;            // seconds
+    double refreshPeriod = 0.0;     // seconds, vsync only : presents land on this grid
+    double workEstimate = 0.0;      // seconds, rises at once, decays slowly
+    double oversleep = 0.001;       // seconds, how late sleep_for returns
+    clock::time_point lastBegin{};
+    clock::time_point lastEnd{};
+    clock::time_point lastInput{};
+    clock::time_point lastPresent{};   // predicted
+    bool inputThisFrame = false;
+    bool started = false;
+    pacerStats counters{};
+    double inputAgeTotal = 0.0;
+};
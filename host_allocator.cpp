@@ -0,0 +1,274 @@
+#include "host_allocator.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+// Stored right in front of every pointer handed to the driver
+struct alignas(16) HostAllocator::Header
+{
+    uint64_t size;
+    uint32_t scope;
+    uint32_t kind;
+    void* base;
+    uint64_t poolClass;
+};
+
+namespace {
+
+constexpr size_t headerSize = 32;
+constexpr size_t minAlignment = 16;
+constexpr size_t poolChunkBytes = 64 * 1024;
+constexpr size_t arenaAlignment = 64;
+
+const char* scopeNames[] = {"COMMAND", "OBJECT", "CACHE", "DEVICE", "INSTANCE"};
+
+inline uintptr_t alignUp(uintptr_t value, size_t alignment) {
+    return (value + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+}
+
+inline size_t poolBlockSize(size_t poolClass) {
+    return size_t(64) << poolClass;
+}
+
+} // namespace
+
+HostAllocator::HostAllocator(size_t frameArenaBytes)
+:
+    arenaSize(frameArenaBytes)
+{
+    static_assert(sizeof(Header) == headerSize, "host allocation header must stay 32 bytes");
+    vkCallbacks.pUserData = this;
+    vkCallbacks.pfnAllocation = vkAllocate;
+    vkCallbacks.pfnReallocation = vkReallocate;
+    vkCallbacks.pfnFree = vkFree;
+    vkCallbacks.pfnInternalAllocation = vkInternalAllocate;
+    vkCallbacks.pfnInternalFree = vkInternalFree;
+    if (arenaSize > 0) {
+        arena = static_cast<uint8_t*>(::operator new(arenaSize, std::align_val_t(arenaAlignment)));
+    }
+}
+
+HostAllocator::~HostAllocator() {
+    for (PoolClass& pool : pools) {
+        for (void* chunk : pool.chunks) {
+            std::free(chunk);
+        }
+    }
+    if (arena != nullptr) {
+        ::operator delete(arena, std::align_val_t(arenaAlignment));
+    }
+}
+
+void HostAllocator::beginFrame() {
+    arenaOffset.store(0, std::memory_order_relaxed);
+}
+
+// --- Allocation --- //
+void* HostAllocator::allocate(size_t size, size_t alignment, VkSystemAllocationScope scope) {
+    if (size == 0) {
+        return nullptr;
+    }
+    alignment = std::max(alignment, minAlignment);
+    uint8_t* user = nullptr;
+    void* base = nullptr;
+    blockKind kind = Heap;
+    size_t poolClass = 0;
+
+    if (scope == VK_SYSTEM_ALLOCATION_SCOPE_COMMAND) {
+        user = static_cast<uint8_t*>(allocateArena(size, alignment));
+        if (user != nullptr) {
+            kind = Arena;
+        } else {
+            arenaOverflowCount.fetch_add(1, std::memory_order_relaxed);
+        }
+    } else if (scope == VK_SYSTEM_ALLOCATION_SCOPE_OBJECT && alignment == minAlignment) {
+        size_t total = size + headerSize;
+        while (poolClass < poolClassCount && poolBlockSize(poolClass) < total) {
+            ++poolClass;
+        }
+        if (poolClass < poolClassCount) {
+            base = allocatePool(poolClass);
+            if (base != nullptr) {
+                user = static_cast<uint8_t*>(base) + headerSize;
+                kind = Pool;
+            }
+        }
+    }
+
+    if (user == nullptr) {
+        base = std::malloc(size + alignment + headerSize);
+        if (base == nullptr) {
+            return nullptr;
+        }
+        user = reinterpret_cast<uint8_t*>(alignUp(reinterpret_cast<uintptr_t>(base) + headerSize, alignment));
+        kind = Heap;
+    }
+
+    Header* header = reinterpret_cast<Header*>(user - headerSize);
+    header->size = size;
+    header->scope = static_cast<uint32_t>(scope);
+    header->kind = kind;
+    header->base = base;
+    header->poolClass = poolClass;
+    track(scope, size);
+    return user;
+}
+
+void* HostAllocator::reallocate(void* original, size_t size, size_t alignment, VkSystemAllocationScope scope) {
+    if (original == nullptr) {
+        return allocate(size, alignment, scope);
+    }
+    if (size == 0) {
+        release(original);
+        return nullptr;
+    }
+    const Header* header = reinterpret_cast<const Header*>(static_cast<uint8_t*>(original) - headerSize);
+    void* memory = allocate(size, alignment, scope);
+    if (memory == nullptr) {
+        return nullptr; // original stays valid
+    }
+    std::memcpy(memory, original, std::min<size_t>(header->size, size));
+    release(original);
+    return memory;
+}
+
+void HostAllocator::release(void* memory) {
+    if (memory == nullptr) {
+        return;
+    }
+    const Header* header = reinterpret_cast<const Header*>(static_cast<uint8_t*>(memory) - headerSize);
+    untrack(static_cast<VkSystemAllocationScope>(header->scope), header->size);
+    switch (header->kind) {
+    case Heap:
+        std::free(header->base);
+        break;
+    case Pool:
+        releasePool(header->poolClass, header->base);
+        break;
+    case Arena:
+        break; // reclaimed by beginFrame()
+    }
+}
+
+void* HostAllocator::allocateArena(size_t size, size_t alignment) {
+    if (arena == nullptr) {
+        return nullptr;
+    }
+    const uintptr_t arenaBase = reinterpret_cast<uintptr_t>(arena);
+    size_t offset = arenaOffset.load(std::memory_order_relaxed);
+    for (;;) {
+        size_t start = alignUp(arenaBase + offset + headerSize, alignment) - arenaBase;
+        size_t end = start + size;
+        if (end > arenaSize) {
+            return nullptr;
+        }
+        if (arenaOffset.compare_exchange_weak(offset, end, std::memory_order_relaxed)) {
+            return arena + start;
+        }
+    }
+}
+
+void* HostAllocator::allocatePool(size_t poolClass) {
+    PoolClass& pool = pools[poolClass];
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    if (pool.freeList == nullptr) {
+        uint8_t* chunk = static_cast<uint8_t*>(std::malloc(poolChunkBytes));
+        if (chunk == nullptr) {
+            return nullptr;
+        }
+        pool.chunks.push_back(chunk);
+        const size_t blockSize = poolBlockSize(poolClass);
+        for (size_t offset = 0; offset + blockSize <= poolChunkBytes; offset += blockSize) {
+            void* block = chunk + offset;
+            *static_cast<void**>(block) = pool.freeList;
+            pool.freeList = block;
+        }
+    }
+    void* block = pool.freeList;
+    pool.freeList = *static_cast<void**>(block);
+    return block;
+}
+
+void HostAllocator::releasePool(size_t poolClass, void* block) {
+    PoolClass& pool = pools[poolClass];
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    *static_cast<void**>(block) = pool.freeList;
+    pool.freeList = block;
+}
+
+// --- Statistics --- //
+void HostAllocator::track(VkSystemAllocationScope scope, size_t size) {
+    ScopeCounters& counter = counters[scope];
+    counter.allocations.fetch_add(1, std::memory_order_relaxed);
+    counter.liveCount.fetch_add(1, std::memory_order_relaxed);
+    counter.totalBytes.fetch_add(size, std::memory_order_relaxed);
+    uint64_t live = counter.liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+    uint64_t peak = counter.peakBytes.load(std::memory_order_relaxed);
+    while (live > peak && !counter.peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+}
+
+void HostAllocator::untrack(VkSystemAllocationScope scope, size_t size) {
+    ScopeCounters& counter = counters[scope];
+    counter.frees.fetch_add(1, std::memory_order_relaxed);
+    counter.liveCount.fetch_sub(1, std::memory_order_relaxed);
+    counter.liveBytes.fetch_sub(size, std::memory_order_relaxed);
+}
+
+hostScopeStats HostAllocator::stats(VkSystemAllocationScope scope) const {
+    const ScopeCounters& counter = counters[scope];
+    hostScopeStats result{};
+    result.allocations = counter.allocations.load(std::memory_order_relaxed);
+    result.frees = counter.frees.load(std::memory_order_relaxed);
+    result.liveCount = counter.liveCount.load(std::memory_order_relaxed);
+    result.liveBytes = counter.liveBytes.load(std::memory_order_relaxed);
+    result.peakBytes = counter.peakBytes.load(std::memory_order_relaxed);
+    result.totalBytes = counter.totalBytes.load(std::memory_order_relaxed);
+    result.internalBytes = counter.internalBytes.load(std::memory_order_relaxed);
+    return result;
+}
+
+bool HostAllocator::reportLeaks(std::ostream& out) const {
+    bool leaked = false;
+    out << "Host allocations by scope (count / total bytes / peak live bytes):" << std::endl;
+    for (uint32_t scope = 0; scope < scopeCount; ++scope) {
+        hostScopeStats s = stats(static_cast<VkSystemAllocationScope>(scope));
+        out << "  " << scopeNames[scope] << ": " << s.allocations << " / " << s.totalBytes
+            << " / " << s.peakBytes << std::endl;
+        if (s.liveCount != 0 || s.internalBytes != 0) {
+            leaked = true;
+            out << "  LEAK " << scopeNames[scope] << ": " << s.liveCount << " allocations, "
+                << s.liveBytes << " bytes still alive, " << s.internalBytes << " internal bytes" << std::endl;
+        }
+    }
+    if (arenaOverflows() != 0) {
+        out << "  COMMAND arena overflowed " << arenaOverflows() << " times, consider a bigger arena" << std::endl;
+    }
+    return leaked;
+}
+
+// --- Vulkan callbacks --- //
+VKAPI_ATTR void* VKAPI_CALL HostAllocator::vkAllocate(void* userData, size_t size, size_t alignment,
+                                                       VkSystemAllocationScope scope) {
+    return static_cast<HostAllocator*>(userData)->allocate(size, alignment, scope);
+}
+
+VKAPI_ATTR void* VKAPI_CALL HostAllocator::vkReallocate(void* userData, void* original, size_t size,
+                                                         size_t alignment, VkSystemAllocationScope scope) {
+    return static_cast<HostAllocator*>(userData)->reallocate(original, size, alignment, scope);
+}
+
+VKAPI_ATTR void VKAPI_CALL HostAllocator::vkFree(void* userData, void* memory) {
+    static_cast<HostAllocator*>(userData)->release(memory);
+}
+
+VKAPI_ATTR void VKAPI_CALL HostAllocator::vkInternalAllocate(void* userData, size_t size,
+                                                             VkInternalAllocationType, VkSystemAllocationScope scope) {
+    static_cast<HostAllocator*>(userData)->counters[scope].internalBytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+VKAPI_ATTR void VKAPI_CALL HostAllocator::vkInternalFree(void* userData, size_t size,
+                                                         VkInternalAllocationType, VkSystemAllocationScope scope) {
+    static_cast<HostAllocator*>(userData)->counters[scope].internalBytes.fetch_sub(size, std::memory_order_relaxed);
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+/* VkAllocationCallbacks that track and bound driver host memory.
+ * Strategy per VkSystemAllocationScope:
+ *   COMMAND  : per-frame linear arena, reset in beginFrame(). Command scope
+ *              allocations only live for one vk* call, so nothing survives a reset.
+ *   OBJECT   : small blocks come from size-class pools, bigger ones from the heap.
+ *   CACHE / DEVICE / INSTANCE : heap.
+ * Byte / count statistics are kept per scope; reportLeaks() lists what the
+ * driver still holds after everything has been destroyed.
+ */
+
+struct hostScopeStats
+{
+    uint64_t allocations = 0;
+    uint64_t frees = 0;
+    uint64_t liveCount = 0;
+    uint64_t liveBytes = 0;
+    uint64_t peakBytes = 0;
+    uint64_t totalBytes = 0;
+    uint64_t internalBytes = 0;   // driver internal allocations (notifications only)
+};
+
+class HostAllocator
+{
+public:
+    static constexpr uint32_t scopeCount = VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE + 1;
+
+    explicit HostAllocator(size_t frameArenaBytes = 1 << 20);
+    HostAllocator(const HostAllocator&) = delete;
+    HostAllocator& operator=(const HostAllocator&) = delete;
+    ~HostAllocator();
+
+    const VkAllocationCallbacks* callbacks() const { return &vkCallbacks; }
+    // no vk* call may be in progress on another thread
+    void beginFrame();
+
+    hostScopeStats stats(VkSystemAllocationScope scope) const;
+    uint64_t arenaOverflows() const { return arenaOverflowCount.load(std::memory_order_relaxed); }
+    // returns true if anything is still alive
+    bool reportLeaks(std::ostream& out) const;
+private:
+    enum blockKind : uint32_t { Heap, Pool, Arena };
+    struct Header;
+    struct ScopeCounters
+    {
+        std::atomic<uint64_t> allocations{0};
+        std::atomic<uint64_t> frees{0};
+        std::atomic<uint64_t> liveCount{0};
+        std::atomic<uint64_t> liveBytes{0};
+        std::atomic<uint64_t> peakBytes{0};
+        std::atomic<uint64_t> totalBytes{0};
+        std::atomic<uint64_t> internalBytes{0};
+    };
+    static constexpr size_t poolClassCount = 4;   // 64 / 128 / 256 / 512 byte blocks
+    struct PoolClass
+    {
+        std::mutex mutex;
+        void* freeList = nullptr;
+        std::vector<void*> chunks;
+    };
+private:
+    void* allocate(size_t size, size_t alignment, VkSystemAllocationScope scope);
+    void* reallocate(void* original, size_t size, size_t alignment, VkSystemAllocationScope scope);
+    void release(void* memory);
+    void* allocateArena(size_t size, size_t alignment);
+    void* allocatePool(size_t poolClass);
+    void releasePool(size_t poolClass, void* block);
+    void track(VkSystemAllocationScope scope, size_t size);
+    void untrack(VkSystemAllocationScope scope, size_t size);
+
+    static VKAPI_ATTR void* VKAPI_CALL vkAllocate(void* userData, size_t size, size_t alignment,
+                                                   VkSystemAllocationScope scope);
+    static VKAPI_ATTR void* VKAPI_CALL vkReallocate(void* userData, void* original, size_t size,
+                                                     size_t alignment, VkSystemAllocationScope scope);
+    static VKAPI_ATTR void VKAPI_CALL vkFree(void* userData, void* memory);
+    static VKAPI_ATTR void VKAPI_CALL vkInternalAllocate(void* userData, size_t size,
+                                                         VkInternalAllocationType type, VkSystemAllocationScope scope);
+    static VKAPI_ATTR void VKAPI_CALL vkInternalFree(void* userData, size_t size,
+                                                     VkInternalAllocationType type, VkSystemAllocationScope scope);
+private:
+    VkAllocationCallbacks vkCallbacks{};
+    ScopeCounters counters[scopeCount];
+
+    uint8_t* arena = nullptr;
+    size_t arenaSize = 0;
+    std::atomic<size_t> arenaOffset{0};
+    std::atomic<uint64_t> arenaOverflowCount{0};
+
+    PoolClass pools[poolClassCount];
+};
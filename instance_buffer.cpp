@@ -0,0 +1,122 @@
+#include "instance_buffer.hpp"
+#include "vk_dispatch.hpp"
+#include <stdexcept>
+
+void InstanceBuffers::init(VkPhysicalDevice c_physicalDevice, VkDevice c_device, const VkAllocationCallbacks* allocator,
+                           uint32_t slotCount, uint32_t capacity) {
+    physicalDevice = c_physicalDevice;
+    device = c_device;
+    hostAllocator = allocator;
+    instanceCapacity = capacity;
+    slots.resize(slotCount);
+    for (Slot& slot : slots) {
+        createBuffer(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, slot.device, slot.deviceMemory);
+        // coherent : the CPU writes are visible to the copy without a flush
+        createBuffer(VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                     slot.staging, slot.stagingMemory);
+        void* mapped = nullptr;
+        if (vkd.vkMapMemory(device, slot.stagingMemory, 0, VK_WHOLE_SIZE, 0, &mapped) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to map instance staging memory!");
+        }
+        slot.mapped = static_cast<float*>(mapped);
+    }
+}
+
+void InstanceBuffers::createBuffer(VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
+                                   VkBuffer& buffer, VkDeviceMemory& memory) {
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = instanceSize * instanceCapacity;
+    bufferInfo.usage = usage;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    if (vkd.vkCreateBuffer(device, &bufferInfo, hostAllocator, &buffer) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create instance buffer!");
+    }
+
+    VkMemoryRequirements memRequirements;
+    vkd.vkGetBufferMemoryRequirements(device, buffer, &memRequirements);
+    VkPhysicalDeviceMemoryProperties memProperties;
+    vkd.vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
+    uint32_t typeIndex = UINT32_MAX;
+    for (uint32_t i = 0; i < memProperties.memoryTypeCount; ++i) {
+        if ((memRequirements.memoryTypeBits & (1u << i)) &&
+            (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+            typeIndex = i;
+            break;
+        }
+    }
+    if (typeIndex == UINT32_MAX) {
+        throw std::runtime_error("Failed to find memory for instance buffer!");
+    }
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = memRequirements.size;
+    allocInfo.memoryTypeIndex = typeIndex;
+    if (vkd.vkAllocateMemory(device, &allocInfo, hostAllocator, &memory) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate instance buffer memory!");
+    }
+    vkd.vkBindBufferMemory(device, buffer, memory, 0);
+}
+
+// --- Upload --- //
+void InstanceBuffers::record(VkCommandBuffer commandBuffer, uint32_t slotIndex, SceneStore& scene) {
+    if (scene.size() > instanceCapacity) {
+        throw std::runtime_error("Scene exceeds the instance buffer capacity!");
+    }
+    uploadStats = {};
+    scene.collectUploads(slotIndex, ranges);
+    if (ranges.empty()) {
+        return;
+    }
+
+    // ranges are packed back to back in the staging buffer
+    Slot& slot = slots[slotIndex];
+    regions.clear();
+    VkDeviceSize stagingOffset = 0;
+    for (const sceneCopyRange& range : ranges) {
+        float* out = slot.mapped + stagingOffset / sizeof(float);
+        for (uint32_t i = 0; i < range.count; ++i) {
+            scene.writeInstance(range.first + i, out + i * 16);
+        }
+        VkBufferCopy region{};
+        region.srcOffset = stagingOffset;
+        region.dstOffset = instanceSize * range.first;
+        region.size = instanceSize * range.count;
+        regions.push_back(region);
+        stagingOffset += region.size;
+        uploadStats.instances += range.count;
+    }
+    uploadStats.regions = static_cast<uint32_t>(regions.size());
+    uploadStats.bytes = stagingOffset;
+    vkd.vkCmdCopyBuffer(commandBuffer, slot.staging, slot.device, uploadStats.regions, regions.data());
+
+    VkBufferMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer = slot.device;
+    barrier.offset = 0;
+    barrier.size = VK_WHOLE_SIZE;
+    vkd.vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0, 0, nullptr, 1, &barrier, 0, nullptr);
+}
+
+// --- Cleanup --- //
+void InstanceBuffers::destroy() {
+    if (device == VK_NULL_HANDLE) {
+        return;
+    }
+    for (Slot& slot : slots) {
+        vkd.vkDestroyBuffer(device, slot.device, hostAllocator);
+        vkd.vkFreeMemory(device, slot.deviceMemory, hostAllocator);
+        vkd.vkDestroyBuffer(device, slot.staging, hostAllocator);
+        vkd.vkFreeMemory(device, slot.stagingMemory, hostAllocator);
+    }
+    slots.clear();
+    device = VK_NULL_HANDLE;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "scene_store.hpp"
+
+/* Per frame slot GPU copies of the scene's world matrices (column-major mat4,
+ * one per instance, indexed by SceneStore::instanceIndex).
+ * Each frame only the instances that changed since this slot was last used
+ * are packed into the slot's persistently mapped staging buffer and copied
+ * with one VkBufferCopy per coalesced range, so the upload size follows the
+ * number of changed objects instead of the scene size.
+ */
+
+struct instanceUploadStats
+{
+    uint32_t instances = 0;     // matrices copied
+    uint32_t regions = 0;       // VkBufferCopy regions
+    VkDeviceSize bytes = 0;     // bytes copied, merge gaps included
+};
+
+class InstanceBuffers
+{
+public:
+    static constexpr VkDeviceSize instanceSize = sizeof(float) * 16;
+
+    void init(VkPhysicalDevice physicalDevice, VkDevice device, const VkAllocationCallbacks* allocator,
+              uint32_t slotCount, uint32_t capacity);
+    void destroy();
+
+    // upload the changes of `scene` for `slot`, then make them visible to vertex / shader reads
+    void record(VkCommandBuffer commandBuffer, uint32_t slot, SceneStore& scene);
+
+    VkBuffer buffer(uint32_t slot) const { return slots[slot].device; }
+    uint32_t capacity() const { return instanceCapacity; }
+    const instanceUploadStats& lastUpload() const { return uploadStats; }
+private:
+    struct Slot
+    {
+        VkBuffer device = VK_NULL_HANDLE;       // vertex / storage buffer read by the draws
+        VkDeviceMemory deviceMemory = VK_NULL_HANDLE;
+        VkBuffer staging = VK_NULL_HANDLE;
+        VkDeviceMemory stagingMemory = VK_NULL_HANDLE;
+        float* mapped = nullptr;
+    };
+private:
+    void createBuffer(VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& memory);
+private:
+    VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+    VkDevice device = VK_NULL_HANDLE;
+    const VkAllocationCallbacks* hostAllocator = nullptr;
+    uint32_t instanceCapacity = 0;
+    std::vector<Slot> slots;
+    std::vector<sceneCopyRange> ranges;
+    std::vector<VkBufferCopy> regions;
+    instanceUploadStats uploadStats{};
+};
@@ -0,0 +1,221 @@
+#include "job_system.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+// which system / deque the current thread belongs to
+thread_local const JobSystem* currentSystem = nullptr;
+thread_local uint32_t currentIndex = 0;
+
+} // namespace
+
+// --- Graph --- //
+jobId JobGraph::addNode(std::function<void()> work, const jobId* dependencies, size_t dependencyCount) {
+    jobId id = static_cast<jobId>(nodes.size());
+    for (size_t i = 0; i < dependencyCount; ++i) {
+        if (dependencies[i] >= id) {
+            throw std::runtime_error("JobGraph: dependency on an unknown job");
+        }
+        nodes[dependencies[i]].successors.push_back(id);
+    }
+    node& added = nodes.emplace_back();
+    added.work = std::move(work);
+    added.dependencyCount = static_cast<uint32_t>(dependencyCount);
+    return id;
+}
+
+jobId JobGraph::add(std::function<void()> work, std::initializer_list<jobId> dependencies) {
+    return addNode(std::move(work), dependencies.begin(), dependencies.size());
+}
+
+jobId JobGraph::parallelFor(uint32_t count, uint32_t grain, std::function<void(uint32_t first, uint32_t last)> work,
+                            std::initializer_list<jobId> dependencies) {
+    grain = std::max(grain, 1u);
+    std::vector<jobId> chunks;
+    for (uint32_t first = 0; first < count; first += grain) {
+        uint32_t last = std::min(count, first + grain);
+        chunks.push_back(addNode([work, first, last] { work(first, last); }, dependencies.begin(), dependencies.size()));
+    }
+    if (chunks.empty()) {
+        return addNode([] {}, dependencies.begin(), dependencies.size());
+    }
+    return addNode([] {}, chunks.data(), chunks.size());
+}
+
+void JobGraph::clear() {
+    if (remaining.load(std::memory_order_acquire) != 0) {
+        throw std::runtime_error("JobGraph: cleared while running");
+    }
+    nodes.clear();
+}
+
+// --- Workers --- //
+uint32_t JobSystem::defaultWorkerCount() {
+    uint32_t hardware = std::thread::hardware_concurrency();
+    return hardware > 1 ? hardware - 1 : 0;
+}
+
+JobSystem::JobSystem(uint32_t workerCount) {
+    for (uint32_t i = 0; i <= workerCount; ++i) {
+        queues.push_back(std::make_unique<queue>());
+    }
+    for (uint32_t i = 1; i <= workerCount; ++i) {
+        threads.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+uint32_t JobSystem::currentQueue() const {
+    return currentSystem == this ? currentIndex : 0;
+}
+
+void JobSystem::workerLoop(uint32_t index) {
+    currentSystem = this;
+    currentIndex = index;
+    task work{};
+    for (;;) {
+        if (pop(index, work)) {
+            execute(work);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleeping.fetch_add(1);
+        wake.wait(lock, [this] { return stopping || queued.load() > 0; });
+        sleeping.fetch_sub(1);
+        if (stopping) {
+            return;
+        }
+    }
+}
+
+void JobSystem::push(task work) {
+    queue& own = *queues[currentQueue()];
+    {
+        std::lock_guard<std::mutex> lock(own.mutex);
+        own.tasks.push_back(work);
+    }
+    queued.fetch_add(1);
+    // pairs with the sleeping / queued checks of workerLoop, a sleeper can't miss this job
+    if (sleeping.load() > 0) {
+        { std::lock_guard<std::mutex> lock(sleepMutex); }
+        wake.notify_one();
+    }
+}
+
+bool JobSystem::pop(uint32_t self, task& work) {
+    if (queued.load() == 0) {
+        return false;
+    }
+    {
+        queue& own = *queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            work = own.tasks.back();
+            own.tasks.pop_back();
+            queued.fetch_sub(1);
+            return true;
+        }
+    }
+    // steal the oldest job of another deque, starting next to our own to spread the thieves
+    const uint32_t count = static_cast<uint32_t>(queues.size());
+    for (uint32_t offset = 1; offset < count; ++offset) {
+        queue& victim = *queues[(self + offset) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            work = victim.tasks.front();
+            victim.tasks.pop_front();
+            queued.fetch_sub(1);
+            stolen.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobSystem::execute(task work) {
+    JobGraph& graph = *work.graph;
+    JobGraph::node& job = graph.nodes[work.id];
+    // after a failure the successors still count down so the graph completes, their work is skipped
+    if (!graph.failed.load(std::memory_order_acquire)) {
+        try {
+            job.work();
+        } catch (...) {
+            bool first = false;
+            if (graph.failed.compare_exchange_strong(first, true)) {
+                graph.error = std::current_exception();
+            }
+        }
+    }
+    for (jobId successor : job.successors) {
+        if (graph.nodes[successor].pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            push({work.graph, successor});
+        }
+    }
+    executed.fetch_add(1, std::memory_order_relaxed);
+    // last : once remaining hits 0 the graph may be cleared or destroyed, only `this` is used after it.
+    // pairs with the sleeping / remaining checks of wait, a sleeping waiter can't miss the end
+    if (graph.remaining.fetch_sub(1) == 1 && sleeping.load() > 0) {
+        { std::lock_guard<std::mutex> lock(sleepMutex); }
+        wake.notify_all();
+    }
+}
+
+// --- Graphs --- //
+void JobSystem::submit(JobGraph& graph) {
+    if (!done(graph)) {
+        throw std::runtime_error("JobSystem: graph submitted while running");
+    }
+    graph.failed.store(false, std::memory_order_relaxed);
+    graph.error = nullptr;
+    graph.remaining.store(graph.size(), std::memory_order_release);
+    for (JobGraph::node& job : graph.nodes) {
+        job.pending.store(job.dependencyCount, std::memory_order_relaxed);
+    }
+    for (jobId id = 0; id < graph.size(); ++id) {
+        if (graph.nodes[id].dependencyCount == 0) {
+            push({&graph, id});
+        }
+    }
+}
+
+void JobSystem::wait(JobGraph& graph) {
+    const uint32_t self = currentQueue();
+    task work{};
+    while (!done(graph)) {
+        if (pop(self, work)) {
+            execute(work);
+            continue;
+        }
+        // the remaining jobs run on other threads : sleep until one of them queues work or the graph ends
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleeping.fetch_add(1);
+        wake.wait(lock, [&] { return queued.load() > 0 || graph.remaining.load() == 0; });
+        sleeping.fetch_sub(1);
+    }
+    if (graph.error) {
+        std::exception_ptr error = graph.error;
+        graph.error = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+void JobSystem::parallelFor(uint32_t count, uint32_t grain, const std::function<void(uint32_t first, uint32_t last)>& work) {
+    if (count <= grain || threads.empty()) {
+        work(0, count);
+        return;
+    }
+    JobGraph graph;
+    graph.parallelFor(count, grain, work);
+    run(graph);
+}
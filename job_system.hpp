@@ -0,0 +1,105 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* Work-stealing job system.
+ * Work is described as a JobGraph : jobs plus the jobs they depend on. Each
+ * worker owns a deque, it pushes and pops ready jobs at the back (LIFO, cache
+ * warm) and idle workers steal from the front of the others. A job becomes
+ * ready when its last dependency finishes, the finishing thread pushes it
+ * onto its own deque. Threads that wait for a graph run jobs meanwhile, so
+ * waiting from inside a job doesn't deadlock, and sleep when there is nothing
+ * to run. The first exception a job throws is rethrown by wait(), the jobs of
+ * the graph that haven't started yet are skipped.
+ */
+
+using jobId = uint32_t;
+
+class JobGraph
+{
+public:
+    jobId add(std::function<void()> work, std::initializer_list<jobId> dependencies = {});
+    // [0, count) in chunks of `grain` indices, the returned job completes after every chunk
+    jobId parallelFor(uint32_t count, uint32_t grain, std::function<void(uint32_t first, uint32_t last)> work,
+                      std::initializer_list<jobId> dependencies = {});
+    void clear();   // not while the graph runs
+    uint32_t size() const { return static_cast<uint32_t>(nodes.size()); }
+private:
+    friend class JobSystem;
+    struct node
+    {
+        std::function<void()> work;
+        std::vector<jobId> successors;
+        uint32_t dependencyCount = 0;
+        std::atomic<uint32_t> pending{0};   // unfinished dependencies while running
+    };
+    jobId addNode(std::function<void()> work, const jobId* dependencies, size_t dependencyCount);
+private:
+    std::deque<node> nodes;                 // stable addresses
+    std::atomic<uint32_t> remaining{0};     // unfinished jobs while running
+    std::atomic<bool> failed{false};        // a job threw, the rest is skipped
+    std::exception_ptr error;               // written once by the failing job, read after remaining hits 0
+};
+
+struct jobStats
+{
+    uint64_t executed = 0;
+    uint64_t stolen = 0;    // taken from another thread's deque
+};
+
+class JobSystem
+{
+public:
+    explicit JobSystem(uint32_t workerCount = defaultWorkerCount());
+    ~JobSystem();
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    static uint32_t defaultWorkerCount();   // one per hardware thread, minus the submitting thread
+    uint32_t workerCount() const { return static_cast<uint32_t>(threads.size()); }
+
+    void submit(JobGraph& graph);           // the graph has to stay alive until it is done
+    void wait(JobGraph& graph);             // runs jobs on the calling thread until the graph is done, rethrows
+    bool done(const JobGraph& graph) const { return graph.remaining.load(std::memory_order_acquire) == 0; }
+    void run(JobGraph& graph) { submit(graph); wait(graph); }
+    // blocking helper : work(first, last) over [0, count)
+    void parallelFor(uint32_t count, uint32_t grain, const std::function<void(uint32_t first, uint32_t last)>& work);
+
+    jobStats stats() const { return {executed.load(), stolen.load()}; }
+private:
+    struct task
+    {
+        JobGraph* graph;
+        jobId id;
+    };
+    struct queue
+    {
+        std::mutex mutex;
+        std::deque<task> tasks;
+    };
+private:
+    uint32_t currentQueue() const;          // 0 : threads that aren't workers
+    void push(task work);
+    bool pop(uint32_t self, task& work);
+    void execute(task work);
+    void workerLoop(uint32_t index);
+private:
+    std::vector<std::unique_ptr<queue>> queues;   // [0] external threads, [1..] workers
+    std::vector<std::thread> threads;
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::atomic<uint32_t> queued{0};
+    std::atomic<uint32_t> sleeping{0};
+    bool stopping = false;
+    std::atomic<uint64_t> executed{0};
+    std::atomic<uint64_t> stolen{0};
+};
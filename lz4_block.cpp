@@ -0,0 +1,153 @@
+#include "lz4_block.hpp"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+constexpr size_t minMatch = 4;
+constexpr size_t lastLiterals = 5;      // the block ends with at least 5 literals
+constexpr size_t matchLimit = 12;       // no match starts in the last 12 bytes
+constexpr size_t maxOffset = 65535;
+constexpr uint32_t hashBits = 12;
+
+uint32_t read32(const uint8_t* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+uint32_t hashOf(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - hashBits);
+}
+
+// 15 in the token, then 255 per byte until the rest fits
+uint8_t* writeLength(uint8_t* out, size_t length) {
+    for (; length >= 255; length -= 255) *out++ = 255;
+    *out++ = static_cast<uint8_t>(length);
+    return out;
+}
+
+} // namespace
+
+size_t lz4CompressBound(size_t size) {
+    return size + size / 255 + 16;
+}
+
+size_t lz4Compress(const void* src, size_t size, void* dst, size_t capacity) {
+    const uint8_t* in = static_cast<const uint8_t*>(src);
+    uint8_t* out = static_cast<uint8_t*>(dst);
+    uint8_t* const outEnd = out + capacity;
+    const uint8_t* anchor = in;             // first literal not emitted yet
+
+    // emits literals [anchor, literalEnd) and, if matchLength > 0, the match
+    auto emit = [&](const uint8_t* literalEnd, size_t offset, size_t matchLength) {
+        size_t literals = static_cast<size_t>(literalEnd - anchor);
+        // worst case : token, literal length bytes, literals, offset, match length bytes
+        size_t needed = 1 + literals / 255 + 1 + literals + 2 + matchLength / 255 + 1;
+        if (static_cast<size_t>(outEnd - out) < needed) return false;
+        uint8_t* token = out++;
+        *token = static_cast<uint8_t>((literals < 15 ? literals : 15) << 4);
+        if (literals >= 15) out = writeLength(out, literals - 15);
+        if (literals > 0) std::memcpy(out, anchor, literals);
+        out += literals;
+        if (matchLength > 0) {
+            *out++ = static_cast<uint8_t>(offset);
+            *out++ = static_cast<uint8_t>(offset >> 8);
+            size_t extra = matchLength - minMatch;
+            *token |= static_cast<uint8_t>(extra < 15 ? extra : 15);
+            if (extra >= 15) out = writeLength(out, extra - 15);
+        }
+        return true;
+    };
+
+    if (size > matchLimit) {
+        std::vector<uint32_t> table(size_t(1) << hashBits, UINT32_MAX);
+        const uint8_t* const matchEnd = in + size - lastLiterals;    // matches stop here
+        const uint8_t* const searchEnd = in + size - matchLimit;     // and start before here
+        const uint8_t* p = in;
+        while (p < searchEnd) {
+            uint32_t sequence = read32(p);
+            uint32_t& slot = table[hashOf(sequence)];
+            uint32_t candidate = slot;
+            slot = static_cast<uint32_t>(p - in);
+            if (candidate == UINT32_MAX || static_cast<size_t>(p - in) - candidate > maxOffset ||
+                read32(in + candidate) != sequence) {
+                ++p;
+                continue;
+            }
+            const uint8_t* match = in + candidate;
+            // extend backwards over pending literals, then forwards
+            while (p > anchor && match > in && p[-1] == match[-1]) {
+                --p;
+                --match;
+            }
+            const uint8_t* end = p + minMatch;
+            const uint8_t* from = match + minMatch;
+            while (end < matchEnd && *end == *from) {
+                ++end;
+                ++from;
+            }
+            if (!emit(p, static_cast<size_t>(p - match), static_cast<size_t>(end - p))) return 0;
+            // positions inside the match become candidates for later ones
+            for (const uint8_t* inside = p + 1; inside + 4 <= end && inside < searchEnd; inside += 2) {
+                table[hashOf(read32(inside))] = static_cast<uint32_t>(inside - in);
+            }
+            p = end;
+            anchor = end;
+        }
+    }
+    if (!emit(in + size, 0, 0)) return 0;
+    return static_cast<size_t>(out - static_cast<uint8_t*>(dst));
+}
+
+bool lz4Decompress(const void* src, size_t size, void* dst, size_t rawSize) {
+    const uint8_t* in = static_cast<const uint8_t*>(src);
+    const uint8_t* const inEnd = in + size;
+    uint8_t* const outBegin = static_cast<uint8_t*>(dst);
+    uint8_t* out = outBegin;
+    uint8_t* const outEnd = outBegin + rawSize;
+
+    // returns false on a length running past the input
+    auto readLength = [&](size_t& length) {
+        if (length != 15) return true;
+        uint8_t byte;
+        do {
+            if (in >= inEnd) return false;
+            byte = *in++;
+            length += byte;
+        } while (byte == 255);
+        return true;
+    };
+
+    while (in < inEnd) {
+        uint8_t token = *in++;
+        size_t literals = token >> 4;
+        if (!readLength(literals)) return false;
+        if (literals > static_cast<size_t>(inEnd - in) || literals > static_cast<size_t>(outEnd - out)) return false;
+        if (literals > 0) std::memcpy(out, in, literals);
+        in += literals;
+        out += literals;
+        if (in == inEnd) break;             // the last sequence has no match
+
+        if (inEnd - in < 2) return false;
+        size_t offset = in[0] | (size_t(in[1]) << 8);
+        in += 2;
+        size_t length = token & 15;
+        if (!readLength(length)) return false;
+        length += minMatch;
+        if (offset == 0 || offset > static_cast<size_t>(out - outBegin) ||
+            length > static_cast<size_t>(outEnd - out)) {
+            return false;
+        }
+        const uint8_t* match = out - offset;
+        if (offset >= length) {
+            std::memcpy(out, match, length);
+            out += length;
+        } else {
+            // overlapping : repeats the last `offset` bytes
+            for (size_t i = 0; i < length; ++i) *out++ = match[i];
+        }
+    }
+    return out == outEnd;
+}
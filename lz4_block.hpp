@@ -0,0 +1,17 @@
+#pragma once
+#include <cstddef>
+
+/* LZ4 block format (no frame, no checksums), used by the asset pack.
+ * Greedy single-probe compressor : fast enough for the build step, the
+ * output is read by any LZ4 block decoder. The decoder checks every
+ * length and offset against both buffers, a corrupt block fails instead
+ * of reading or writing out of bounds.
+ */
+
+size_t lz4CompressBound(size_t size);
+
+// bytes written to `dst`, 0 if they don't fit in `capacity`
+size_t lz4Compress(const void* src, size_t size, void* dst, size_t capacity);
+
+// false unless the block decodes to exactly `rawSize` bytes
+bool lz4Decompress(const void* src, size_t size, void* dst, size_t rawSize);
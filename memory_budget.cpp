@@ -0,0 +1,125 @@
+#include "memory_budget.hpp"
+#include "vk_dispatch.hpp"
+#include <algorithm>
+
+void MemoryBudgetMonitor::init(VkPhysicalDevice c_physicalDevice, bool budgetExtension, memoryBudgetThresholds thresholds) {
+    physicalDevice = c_physicalDevice;
+    budgetSupported = budgetExtension;
+    limits = thresholds;
+
+    VkPhysicalDeviceMemoryProperties memProperties;
+    vkd.vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
+    heapBudgets.assign(memProperties.memoryHeapCount, {});
+    framesSinceEvent.assign(memProperties.memoryHeapCount, 0);
+    for (uint32_t i = 0; i < memProperties.memoryHeapCount; ++i) {
+        heapBudgets[i].size = memProperties.memoryHeaps[i].size;
+        heapBudgets[i].budget = memProperties.memoryHeaps[i].size; // best guess without the extension
+        heapBudgets[i].deviceLocal = (memProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+    }
+    poll();
+}
+
+memoryPressure MemoryBudgetMonitor::classify(const heapBudget& heap) const {
+    if (heap.budget == 0) {
+        return memoryPressure::Critical;
+    }
+    float ratio = static_cast<float>(static_cast<double>(heap.usage) / static_cast<double>(heap.budget));
+    // rising edges use the threshold, falling edges need the hysteresis margin as well
+    switch (heap.level) {
+    case memoryPressure::Critical:
+        if (ratio >= limits.critical - limits.hysteresis) return memoryPressure::Critical;
+        if (ratio >= limits.warning - limits.hysteresis) return memoryPressure::Warning;
+        return memoryPressure::Normal;
+    case memoryPressure::Warning:
+        if (ratio >= limits.critical) return memoryPressure::Critical;
+        if (ratio >= limits.warning - limits.hysteresis) return memoryPressure::Warning;
+        return memoryPressure::Normal;
+    case memoryPressure::Normal:
+        break;
+    }
+    if (ratio >= limits.critical) return memoryPressure::Critical;
+    if (ratio >= limits.warning) return memoryPressure::Warning;
+    return memoryPressure::Normal;
+}
+
+void MemoryBudgetMonitor::poll() {
+    if (!budgetSupported) {
+        return; // usage is unknown, nothing to react to
+    }
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties{};
+    budgetProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+    VkPhysicalDeviceMemoryProperties2 memProperties{};
+    memProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+    memProperties.pNext = &budgetProperties;
+    vkd.vkGetPhysicalDeviceMemoryProperties2(physicalDevice, &memProperties);
+
+    for (uint32_t i = 0; i < heapBudgets.size(); ++i) {
+        heapBudget& heap = heapBudgets[i];
+        heap.budget = budgetProperties.heapBudget[i];
+        heap.usage = budgetProperties.heapUsage[i];
+
+        memoryPressure previous = heap.level;
+        heap.level = classify(heap);
+        ++framesSinceEvent[i];
+        bool changed = heap.level != previous;
+        bool repeat = heap.level != memoryPressure::Normal && framesSinceEvent[i] >= limits.repeatFrames;
+        if (!changed && !repeat) {
+            continue;
+        }
+        framesSinceEvent[i] = 0;
+        dispatch(makeEvent(i, previous));
+    }
+}
+
+memoryPressureEvent MemoryBudgetMonitor::makeEvent(uint32_t heapIndex, memoryPressure previous) const {
+    const heapBudget& heap = heapBudgets[heapIndex];
+    memoryPressureEvent event{};
+    event.heapIndex = heapIndex;
+    event.previous = previous;
+    event.current = heap.level;
+    event.budget = heap.budget;
+    event.usage = heap.usage;
+    VkDeviceSize target = static_cast<VkDeviceSize>(static_cast<double>(heap.budget) * limits.warning);
+    event.bytesToRelease = heap.usage > target ? heap.usage - target : 0;
+    return event;
+}
+
+// a callback may add / remove listeners : iterate a copy, skip the ones removed meanwhile
+void MemoryBudgetMonitor::dispatch(const memoryPressureEvent& event) {
+    std::vector<std::pair<uint32_t, listener>> snapshot = listeners;
+    for (const auto& entry : snapshot) {
+        if (registered(entry.first)) {
+            entry.second(event);
+        }
+    }
+}
+
+bool MemoryBudgetMonitor::registered(uint32_t id) const {
+    return std::any_of(listeners.begin(), listeners.end(), [id](const auto& entry) { return entry.first == id; });
+}
+
+uint32_t MemoryBudgetMonitor::addListener(listener callback) {
+    uint32_t id = nextListenerId++;
+    listeners.emplace_back(id, callback);
+    // init() polled before anyone listened : heaps already under pressure are reported now
+    for (uint32_t i = 0; i < heapBudgets.size(); ++i) {
+        if (heapBudgets[i].level != memoryPressure::Normal && registered(id)) {
+            callback(makeEvent(i, memoryPressure::Normal));
+        }
+    }
+    return id;
+}
+
+void MemoryBudgetMonitor::removeListener(uint32_t id) {
+    listeners.erase(std::remove_if(listeners.begin(), listeners.end(),
+                                   [id](const auto& entry) { return entry.first == id; }),
+                    listeners.end());
+}
+
+memoryPressure MemoryBudgetMonitor::worstLevel() const {
+    memoryPressure worst = memoryPressure::Normal;
+    for (const heapBudget& heap : heapBudgets) {
+        worst = std::max(worst, heap.level);
+    }
+    return worst;
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+/* Per-heap VRAM budget tracking through VK_EXT_memory_budget.
+ * poll() is called once per frame; when a heap's usage / budget ratio crosses
+ * the warning or critical threshold a pressure event is sent to every listener
+ * (streaming, caches ...) so they can evict. While a heap stays under pressure
+ * the event is repeated every `repeatFrames` polls, a level only drops again
+ * after the ratio fell `hysteresis` below its threshold. A new listener is
+ * told about every heap already under pressure right away (previous Normal).
+ * Listeners may add or remove listeners from inside the callback.
+ */
+
+enum class memoryPressure : uint8_t { Normal, Warning, Critical };
+
+struct heapBudget
+{
+    VkDeviceSize size = 0;
+    VkDeviceSize budget = 0;    // how much this process may use, from the driver
+    VkDeviceSize usage = 0;     // how much this process currently uses
+    bool deviceLocal = false;
+    memoryPressure level = memoryPressure::Normal;
+};
+
+struct memoryPressureEvent
+{
+    uint32_t heapIndex;
+    memoryPressure previous;
+    memoryPressure current;
+    VkDeviceSize budget;
+    VkDeviceSize usage;
+    VkDeviceSize bytesToRelease;  // to get back under the warning threshold
+};
+
+struct memoryBudgetThresholds
+{
+    float warning = 0.85f;
+    float critical = 0.95f;
+    float hysteresis = 0.05f;
+    uint32_t repeatFrames = 60;
+};
+
+class MemoryBudgetMonitor
+{
+public:
+    using listener = std::function<void(const memoryPressureEvent&)>;
+
+    // budgetExtension : VK_EXT_memory_budget was enabled on the device
+    void init(VkPhysicalDevice physicalDevice, bool budgetExtension, memoryBudgetThresholds thresholds = {});
+    void poll();
+
+    uint32_t addListener(listener callback);
+    void removeListener(uint32_t id);
+
+    bool supported() const { return budgetSupported; }
+    const std::vector<heapBudget>& heaps() const { return heapBudgets; }
+    memoryPressure worstLevel() const;
+private:
+    memoryPressure classify(const heapBudget& heap) const;
+    memoryPressureEvent makeEvent(uint32_t heapIndex, memoryPressure previous) const;
+    void dispatch(const memoryPressureEvent& event);
+    bool registered(uint32_t id) const;
+private:
+    VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+    bool budgetSupported = false;
+    memoryBudgetThresholds limits;
+    std::vector<heapBudget> heapBudgets;
+    std::vector<uint32_t> framesSinceEvent;
+    std::vector<std::pair<uint32_t, listener>> listeners;
+    uint32_t nextListenerId = 1;
+};
@@ -0,0 +1,80 @@
+#pragma once
+#include <cstdint>
+
+/* Cooked mesh file (.mesh), written by asset_cooker, read by the renderer.
+ * The file is the upload: every section is a tightly packed array aligned to
+ * 16 bytes, the header stores its offset, so the runtime maps / reads the file
+ * and copies each section into a buffer without parsing anything.
+ *
+ *   header | vertices | indices | lods | meshlets | meshlet vertices | meshlet triangles
+ *
+ * Positions are 16 bit unorm inside the mesh bounds, UVs 16 bit unorm inside
+ * the UV bounds, normals 8 bit snorm octahedral. All LODs share the vertex
+ * array, each LOD owns an index range and a meshlet range.
+ */
+
+constexpr uint32_t cookedMeshMagic = 0x48534d43;  // "CMSH"
+constexpr uint32_t cookedMeshVersion = 1;
+constexpr uint32_t cookedMeshAlignment = 16;
+
+struct cookedVertex
+{
+    uint16_t position[4];  // R16G16B16A16_UNORM, w unused
+    uint16_t uv[2];        // R16G16_UNORM
+    int8_t normal[2];      // R8G8_SNORM, octahedral
+    uint8_t padding[2];
+};
+static_assert(sizeof(cookedVertex) == 16, "cookedVertex must stay 16 bytes");
+
+struct cookedLod
+{
+    uint32_t indexOffset;    // in indices
+    uint32_t indexCount;
+    uint32_t meshletOffset;  // in meshlets
+    uint32_t meshletCount;
+    float error;             // object space simplification error (grid cell size)
+    uint32_t padding[3];
+};
+static_assert(sizeof(cookedLod) == 32, "cookedLod must stay 32 bytes");
+
+struct cookedMeshlet
+{
+    float center[3];         // bounding sphere, object space
+    float radius;
+    uint32_t vertexOffset;   // into meshlet vertices (uint32 vertex indices)
+    uint32_t triangleOffset; // into meshlet triangles (3 x uint8 local indices)
+    uint8_t vertexCount;
+    uint8_t triangleCount;
+    uint8_t padding[6];
+};
+static_assert(sizeof(cookedMeshlet) == 32, "cookedMeshlet must stay 32 bytes");
+
+struct cookedMeshHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t indexSize;      // 2 or 4 bytes
+    uint32_t lodCount;
+
+    uint32_t vertexCount;
+    uint32_t indexCount;     // all LODs
+    uint32_t meshletCount;   // all LODs
+    uint32_t meshletVertexCount;
+
+    uint32_t meshletTriangleBytes;
+    uint32_t padding;
+    uint64_t fileSize;
+
+    float boundsMin[4];      // position = boundsMin + unorm * (boundsMax - boundsMin)
+    float boundsMax[4];
+    float uvMin[2];
+    float uvMax[2];
+
+    uint64_t vertexOffset;   // byte offsets from the start of the file
+    uint64_t indexOffset;
+    uint64_t lodOffset;
+    uint64_t meshletOffset;
+    uint64_t meshletVertexOffset;
+    uint64_t meshletTriangleOffset;
+};
+static_assert(sizeof(cookedMeshHeader) % cookedMeshAlignment == 0, "header keeps the sections aligned");
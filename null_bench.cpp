@@ -0,0 +1,320 @@
+#include "test_vulkan.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+
+/* null_bench : 空驱动下的 CPU 开销测试
+ * The renderer is linked against null_driver.cpp (every vk* / glfw* call
+ * returns at once), so the numbers are our own CPU cost only : init steps,
+ * frames and teardown, in nanoseconds and heap allocations (operator new,
+ * counted on every thread). No GPU, loader or window needed, results are
+ * stable enough to catch CPU-side regressions on any Linux box.
+ */
+
+// --- Allocation counting --- //
+
+namespace {
+
+std::atomic<uint64_t> allocationCount{0};
+std::atomic<uint64_t> allocationBytes{0};
+
+void* countedAllocate(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocationBytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void* countedAllocateAligned(std::size_t size, std::align_val_t alignment) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocationBytes.fetch_add(size, std::memory_order_relaxed);
+    std::size_t align = static_cast<std::size_t>(alignment);
+    // aligned_alloc wants a multiple of the alignment
+    if (void* memory = std::aligned_alloc(align, (size + align - 1) / align * align)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+} // namespace
+
+void* operator new(std::size_t size) { return countedAllocate(size); }
+void* operator new[](std::size_t size) { return countedAllocate(size); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return countedAllocateAligned(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return countedAllocateAligned(size, alignment); }
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept { std::free(memory); }
+
+// --- Harness --- //
+
+struct costSample
+{
+    double ns = 0.0;
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+};
+
+// time + allocations since the last mark
+class costMeter
+{
+public:
+    costMeter() { mark(); }
+    void mark() {
+        start = std::chrono::steady_clock::now();
+        allocations = allocationCount.load();
+        bytes = allocationBytes.load();
+    }
+    costSample sample() const {
+        costSample result{};
+        result.ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        result.allocations = allocationCount.load() - allocations;
+        result.bytes = allocationBytes.load() - bytes;
+        return result;
+    }
+private:
+    std::chrono::steady_clock::time_point start;
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+};
+
+struct nullScenario
+{
+    std::string name;
+    renderSettings settings;
+};
+
+struct nullOptions
+{
+    std::string scenario = "all";
+    uint32_t frames = 2000;
+    uint32_t warmup = 100;
+    int workers = 0;            // 0 : jobs run on the main thread, deterministic
+    uint32_t sceneObjects = 10000;
+    bool commandCache = true;
+    std::string output;         // empty : stdout, diagnostics go to stderr
+};
+
+static std::vector<nullScenario> makeScenarios(const nullOptions& options) {
+    renderSettings base{};
+    base.headless = true;
+    base.vsync = false;
+    base.gpuTiming = true;
+    base.workerThreads = options.workers;
+    base.commandCache = options.commandCache;
+
+    std::vector<nullScenario> scenarios;
+    scenarios.push_back({"triangle", base});
+
+    nullScenario pipelines{"pipelines", base};
+    pipelines.settings.drawCount = 1024;
+    pipelines.settings.pipelineCount = 64;
+    scenarios.push_back(pipelines);
+
+    nullScenario postprocess{"postprocess", base};
+    postprocess.settings.drawCount = 256;
+    postprocess.settings.computePost = true;
+    scenarios.push_back(postprocess);
+
+    nullScenario scene{"scene", base};
+    scene.settings.sceneCapacity = options.sceneObjects;
+    scene.settings.statisticsGroups = 4;
+    scenarios.push_back(scene);
+    return scenarios;
+}
+
+static void writeCost(std::ostream& out, const costSample& cost) {
+    out << "{\"ns\": " << static_cast<uint64_t>(cost.ns)
+        << ", \"allocations\": " << cost.allocations
+        << ", \"bytes\": " << cost.bytes << "}";
+}
+
+static double percentile(std::vector<double> samples, double p) {
+    if (samples.empty()) return 0.0;
+    std::sort(samples.begin(), samples.end());
+    size_t index = static_cast<size_t>(p * (samples.size() - 1) + 0.5);
+    return samples[std::min(index, samples.size() - 1)];
+}
+
+// perspective camera (90 degrees, z in [0, 1], near 0.1, far 256) at (x, y, z) looking down -z
+static mat4 sceneCamera(float x, float y, float z) {
+    const float n = 0.1f, f = 256.f;
+    mat4 projection{};
+    projection.m[0] = 1.f;
+    projection.m[5] = -1.f;
+    projection.m[10] = f / (n - f);
+    projection.m[11] = -1.f;
+    projection.m[14] = n * f / (n - f);
+    mat4 view = {{1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, -x, -y, -z, 1.f}};
+    return multiply(projection, view);
+}
+
+static std::string runScenario(nullScenario scenario, const nullOptions& options) {
+    std::vector<std::pair<std::string, costSample>> initSteps;
+    costMeter meter;
+    scenario.settings.initStep = [&](const char* step) {
+        initSteps.emplace_back(step, meter.sample());
+        meter.mark();
+    };
+
+    costMeter initMeter;
+    auto renderer = std::make_unique<test>(windowInfo{1280, 720, "null_bench"}, scenario.settings);
+    costSample init = initMeter.sample();
+
+    // a flat scene, 1% of the objects move each frame
+    if (scenario.settings.sceneCapacity > 0) {
+        std::vector<sceneHandle> objects;
+        for (uint32_t i = 0; i < scenario.settings.sceneCapacity; ++i) {
+            objects.push_back(renderer->scene().create());
+        }
+        renderer->setSceneUpdate([objects = std::move(objects)](SceneStore& scene, uint64_t frame) {
+            uint32_t moved = std::max<uint32_t>(1, static_cast<uint32_t>(objects.size() / 100));
+            for (uint32_t i = 0; i < moved; ++i) {
+                mat4 local = {{1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f,
+                               static_cast<float>(frame % 64), 0.f, 0.f, 1.f}};
+                scene.setLocalTransform(objects[(frame * moved + i) % objects.size()], local);
+            }
+        });
+        // the moved objects walk in and out of the view, culling runs every frame
+        renderer->setSceneView(sceneCamera(0.f, 0.f, 16.f));
+    }
+
+    for (uint32_t i = 0; i < options.warmup; ++i) {
+        renderer->renderFrame();
+    }
+    std::vector<double> frameNs;
+    std::vector<double> frameAllocations;
+    frameNs.reserve(options.frames);
+    frameAllocations.reserve(options.frames);
+    uint64_t frameBytes = 0;
+    for (uint32_t i = 0; i < options.frames; ++i) {
+        costMeter frame;
+        renderer->renderFrame();
+        costSample cost = frame.sample();
+        frameNs.push_back(cost.ns);
+        frameAllocations.push_back(static_cast<double>(cost.allocations));
+        frameBytes += cost.bytes;
+    }
+    renderer->waitIdle();
+
+    costMeter teardownMeter;
+    renderer.reset();
+    costSample teardown = teardownMeter.sample();
+
+    double frames = std::max<double>(1.0, options.frames);
+    double totalAllocations = 0.0;
+    for (double allocations : frameAllocations) totalAllocations += allocations;
+
+    std::ostringstream json;
+    json << "{\"scenario\": \"" << scenario.name << "\""
+         << ", \"draws\": " << scenario.settings.drawCount
+         << ", \"workers\": " << options.workers
+         << ", \"command_cache\": " << (options.commandCache ? "true" : "false")
+         << ", \"frames\": " << options.frames
+         << ", \"frame_ns\": {\"p50\": " << percentile(frameNs, 0.50)
+         << ", \"p90\": " << percentile(frameNs, 0.90)
+         << ", \"p99\": " << percentile(frameNs, 0.99)
+         << ", \"max\": " << percentile(frameNs, 1.0) << "}"
+         << ", \"frame_allocations\": {\"mean\": " << totalAllocations / frames
+         << ", \"max\": " << percentile(frameAllocations, 1.0)
+         << ", \"bytes_mean\": " << frameBytes / frames << "}"
+         << ", \"init\": ";
+    writeCost(json, init);
+    json << ", \"init_steps\": [";
+    for (size_t i = 0; i < initSteps.size(); ++i) {
+        json << (i ? ", " : "") << "{\"step\": \"" << initSteps[i].first << "\", \"cost\": ";
+        writeCost(json, initSteps[i].second);
+        json << "}";
+    }
+    json << "], \"teardown\": ";
+    writeCost(json, teardown);
+    json << "}";
+    return json.str();
+}
+
+static void printUsage() {
+    std::cout << "usage: null_bench [--scenario all|triangle|pipelines|postprocess|scene]\n"
+                 "                  [--frames N] [--warmup N] [--workers N] [--scene-objects N]\n"
+                 "                  [--no-cache] [--output FILE]" << std::endl;
+}
+
+static nullOptions parseOptions(int argc, char** argv) {
+    nullOptions options{};
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::runtime_error("Missing value for " + arg);
+            }
+            return argv[++i];
+        };
+        if (arg == "--scenario") options.scenario = value();
+        else if (arg == "--frames") options.frames = static_cast<uint32_t>(std::stoul(value()));
+        else if (arg == "--warmup") options.warmup = static_cast<uint32_t>(std::stoul(value()));
+        else if (arg == "--workers") options.workers = std::stoi(value());
+        else if (arg == "--scene-objects") options.sceneObjects = static_cast<uint32_t>(std::stoul(value()));
+        else if (arg == "--no-cache") options.commandCache = false;
+        else if (arg == "--output") options.output = value();
+        else if (arg == "--help" || arg == "-h") {
+            printUsage();
+            std::exit(EXIT_SUCCESS);
+        } else {
+            throw std::runtime_error("Unknown option: " + arg);
+        }
+    }
+    return options;
+}
+
+int main(int argc, char** argv) {
+    try {
+        nullOptions options = parseOptions(argc, argv);
+        std::vector<std::string> results;
+        // stdout carries the JSON report only : the renderer logs to stderr, anything else
+        // written to std::cout while the scenarios run is sent there as well
+        std::streambuf* report = std::cout.rdbuf(std::cerr.rdbuf());
+        for (const nullScenario& scenario : makeScenarios(options)) {
+            if (options.scenario != "all" && options.scenario != scenario.name) {
+                continue;
+            }
+            results.push_back(runScenario(scenario, options));
+        }
+        std::cout.rdbuf(report);
+        if (results.empty()) {
+            throw std::runtime_error("Unknown scenario: " + options.scenario);
+        }
+
+        std::ostringstream json;
+        json << "{\"results\": [\n";
+        for (size_t i = 0; i < results.size(); ++i) {
+            json << "  " << results[i] << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        json << "]}\n";
+        if (options.output.empty()) {
+            std::cout << json.str();
+        } else {
+            std::ofstream file(options.output);
+            if (!file) {
+                throw std::runtime_error("Failed to open output file: " + options.output);
+            }
+            file << json.str();
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,509 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+#include <vulkan/vulkan.h>
+#define GLFW_INCLUDE_VULKAN
+#include <glfw/glfw3.h>
+
+#include "vk_dispatch.hpp"
+
+/* Null driver : every vk* / glfw* entry point the renderer calls, returning at once.
+ * Linked into renderer_null instead of the Vulkan loader and glfw, so
+ * null_bench measures only our own CPU cost (see null_bench.cpp).
+ * One CPU-type device with a graphics family, a compute-only family and
+ * host-visible memory; mapped memory is real so uploads / readbacks still
+ * write somewhere. Nothing is executed, fences are always signaled.
+ * Uses malloc instead of new : null_bench counts operator new as the
+ * renderer's allocations.
+ */
+
+namespace {
+
+std::atomic<uint64_t> nextHandle{1};
+
+// pointers on 64-bit, uint64_t non-dispatchable handles on 32-bit builds
+template <typename Handle>
+Handle newHandle() {
+    Handle handle{};
+    uint64_t value = nextHandle.fetch_add(1);
+    std::memcpy(&handle, &value, sizeof(handle));
+    return handle;
+}
+
+// buffers, images and memory carry their size, memory also its bytes
+struct nullObject
+{
+    VkDeviceSize size;
+    unsigned char* bytes;
+};
+
+template <typename Handle>
+Handle newObject(VkDeviceSize size, bool backed) {
+    nullObject* object = static_cast<nullObject*>(std::malloc(sizeof(nullObject)));
+    object->size = size;
+    object->bytes = backed ? static_cast<unsigned char*>(std::calloc(1, static_cast<size_t>(size))) : nullptr;
+    Handle handle{};
+    std::memcpy(&handle, &object, sizeof(object));
+    return handle;
+}
+
+template <typename Handle>
+nullObject* objectOf(Handle handle) {
+    nullObject* object = nullptr;
+    std::memcpy(&object, &handle, sizeof(object));
+    return object;
+}
+
+template <typename Handle>
+void freeObject(Handle handle) {
+    nullObject* object = objectOf(handle);
+    if (object == nullptr) return;
+    std::free(object->bytes);
+    std::free(object);
+}
+
+// two-call enumeration idiom
+template <typename T>
+VkResult enumerate(uint32_t* count, T* out, const T* values, uint32_t available) {
+    if (out == nullptr) {
+        *count = available;
+        return VK_SUCCESS;
+    }
+    uint32_t written = std::min(*count, available);
+    std::copy(values, values + written, out);
+    *count = written;
+    return written < available ? VK_INCOMPLETE : VK_SUCCESS;
+}
+
+constexpr VkDeviceSize heapSize = VkDeviceSize(1) << 30;
+
+// every entry point of the dispatch table, defined below
+PFN_vkVoidFunction procAddress(const char* name);
+
+} // namespace
+
+// --- Instance / physical device --- //
+
+VkResult vkCreateInstance(const VkInstanceCreateInfo*, const VkAllocationCallbacks*, VkInstance* instance) {
+    *instance = newHandle<VkInstance>();
+    return VK_SUCCESS;
+}
+
+void vkDestroyInstance(VkInstance, const VkAllocationCallbacks*) {}
+
+VkResult vkEnumerateInstanceLayerProperties(uint32_t* count, VkLayerProperties* properties) {
+    VkLayerProperties validation{};
+    std::strcpy(validation.layerName, "VK_LAYER_KHRONOS_validation");
+    validation.specVersion = VK_API_VERSION_1_4;
+    return enumerate(count, properties, &validation, 1);
+}
+
+PFN_vkVoidFunction vkGetInstanceProcAddr(VkInstance, const char* name) {
+    return procAddress(name);
+}
+
+// the loader exports no extension functions, the null driver does : vkd resolves them here
+VkResult vkCreateDebugUtilsMessengerEXT(VkInstance, const VkDebugUtilsMessengerCreateInfoEXT*,
+                                        const VkAllocationCallbacks*, VkDebugUtilsMessengerEXT* messenger) {
+    *messenger = newHandle<VkDebugUtilsMessengerEXT>();
+    return VK_SUCCESS;
+}
+
+void vkDestroyDebugUtilsMessengerEXT(VkInstance, VkDebugUtilsMessengerEXT, const VkAllocationCallbacks*) {}
+
+VkResult vkEnumeratePhysicalDevices(VkInstance, uint32_t* count, VkPhysicalDevice* devices) {
+    static const VkPhysicalDevice device = newHandle<VkPhysicalDevice>();
+    return enumerate(count, devices, &device, 1);
+}
+
+void vkGetPhysicalDeviceProperties(VkPhysicalDevice, VkPhysicalDeviceProperties* properties) {
+    *properties = {};
+    properties->apiVersion = VK_API_VERSION_1_4;
+    properties->deviceType = VK_PHYSICAL_DEVICE_TYPE_CPU;
+    std::strcpy(properties->deviceName, "null driver");
+    properties->limits.timestampPeriod = 1.f;
+    properties->limits.maxComputeWorkGroupInvocations = 1024;
+}
+
+void vkGetPhysicalDeviceFeatures(VkPhysicalDevice, VkPhysicalDeviceFeatures* features) {
+    *features = {};
+    features->geometryShader = VK_TRUE;
+    features->pipelineStatisticsQuery = VK_TRUE;
+}
+
+void vkGetPhysicalDeviceQueueFamilyProperties(VkPhysicalDevice, uint32_t* count, VkQueueFamilyProperties* properties) {
+    VkQueueFamilyProperties families[2]{};
+    families[0].queueFlags = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT;
+    families[0].queueCount = 1;
+    families[0].timestampValidBits = 64;
+    families[0].minImageTransferGranularity = {1, 1, 1};
+    families[1].queueFlags = VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT;   // async compute path
+    families[1].queueCount = 1;
+    families[1].timestampValidBits = 64;
+    families[1].minImageTransferGranularity = {1, 1, 1};
+    enumerate(count, properties, families, 2);
+}
+
+void vkGetPhysicalDeviceMemoryProperties(VkPhysicalDevice, VkPhysicalDeviceMemoryProperties* properties) {
+    *properties = {};
+    properties->memoryTypeCount = 2;
+    properties->memoryTypes[0] = {VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0};
+    properties->memoryTypes[1] = {VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT |
+                                  VK_MEMORY_PROPERTY_HOST_CACHED_BIT, 1};
+    properties->memoryHeapCount = 2;
+    properties->memoryHeaps[0] = {heapSize, VK_MEMORY_HEAP_DEVICE_LOCAL_BIT};
+    properties->memoryHeaps[1] = {heapSize, 0};
+}
+
+void vkGetPhysicalDeviceMemoryProperties2(VkPhysicalDevice physicalDevice, VkPhysicalDeviceMemoryProperties2* properties) {
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &properties->memoryProperties);
+    for (auto* next = static_cast<VkBaseOutStructure*>(properties->pNext); next != nullptr; next = next->pNext) {
+        if (next->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT) {
+            auto* budget = reinterpret_cast<VkPhysicalDeviceMemoryBudgetPropertiesEXT*>(next);
+            for (uint32_t i = 0; i < VK_MAX_MEMORY_HEAPS; ++i) {
+                budget->heapBudget[i] = i < 2 ? heapSize : 0;
+                budget->heapUsage[i] = 0;
+            }
+        }
+    }
+}
+
+VkResult vkEnumerateDeviceExtensionProperties(VkPhysicalDevice, const char*, uint32_t* count, VkExtensionProperties* properties) {
+    VkExtensionProperties extensions[2]{};
+    std::strcpy(extensions[0].extensionName, VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+    std::strcpy(extensions[1].extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    return enumerate(count, properties, extensions, 2);
+}
+
+// --- Surface / swap chain --- //
+
+void vkDestroySurfaceKHR(VkInstance, VkSurfaceKHR, const VkAllocationCallbacks*) {}
+
+VkResult vkGetPhysicalDeviceSurfaceSupportKHR(VkPhysicalDevice, uint32_t queueFamily, VkSurfaceKHR, VkBool32* supported) {
+    *supported = queueFamily == 0 ? VK_TRUE : VK_FALSE;
+    return VK_SUCCESS;
+}
+
+VkResult vkGetPhysicalDeviceSurfaceCapabilitiesKHR(VkPhysicalDevice, VkSurfaceKHR, VkSurfaceCapabilitiesKHR* capabilities) {
+    *capabilities = {};
+    capabilities->minImageCount = 2;
+    capabilities->maxImageCount = 3;
+    capabilities->currentExtent = {0xFFFFFFFF, 0xFFFFFFFF};
+    capabilities->minImageExtent = {1, 1};
+    capabilities->maxImageExtent = {16384, 16384};
+    capabilities->maxImageArrayLayers = 1;
+    capabilities->supportedTransforms = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
+    capabilities->currentTransform = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
+    capabilities->supportedCompositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+    capabilities->supportedUsageFlags = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+                                        VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    return VK_SUCCESS;
+}
+
+VkResult vkGetPhysicalDeviceSurfaceFormatsKHR(VkPhysicalDevice, VkSurfaceKHR, uint32_t* count, VkSurfaceFormatKHR* formats) {
+    VkSurfaceFormatKHR format{VK_FORMAT_B8G8R8A8_SRGB, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR};
+    return enumerate(count, formats, &format, 1);
+}
+
+VkResult vkGetPhysicalDeviceSurfacePresentModesKHR(VkPhysicalDevice, VkSurfaceKHR, uint32_t* count, VkPresentModeKHR* modes) {
+    VkPresentModeKHR available[2] = {VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR};
+    return enumerate(count, modes, available, 2);
+}
+
+VkResult vkCreateSwapchainKHR(VkDevice, const VkSwapchainCreateInfoKHR*, const VkAllocationCallbacks*, VkSwapchainKHR* swapchain) {
+    *swapchain = newHandle<VkSwapchainKHR>();
+    return VK_SUCCESS;
+}
+
+void vkDestroySwapchainKHR(VkDevice, VkSwapchainKHR, const VkAllocationCallbacks*) {}
+
+VkResult vkGetSwapchainImagesKHR(VkDevice, VkSwapchainKHR, uint32_t* count, VkImage* images) {
+    static const VkImage swapchainImages[3] = {newHandle<VkImage>(), newHandle<VkImage>(), newHandle<VkImage>()};
+    return enumerate(count, images, swapchainImages, 3);
+}
+
+VkResult vkAcquireNextImageKHR(VkDevice, VkSwapchainKHR, uint64_t, VkSemaphore, VkFence, uint32_t* imageIndex) {
+    static std::atomic<uint32_t> next{0};
+    *imageIndex = next.fetch_add(1) % 3;
+    return VK_SUCCESS;
+}
+
+VkResult vkQueuePresentKHR(VkQueue, const VkPresentInfoKHR*) { return VK_SUCCESS; }
+
+// --- Device --- //
+
+VkResult vkCreateDevice(VkPhysicalDevice, const VkDeviceCreateInfo*, const VkAllocationCallbacks*, VkDevice* device) {
+    *device = newHandle<VkDevice>();
+    return VK_SUCCESS;
+}
+
+void vkDestroyDevice(VkDevice, const VkAllocationCallbacks*) {}
+
+PFN_vkVoidFunction vkGetDeviceProcAddr(VkDevice, const char* name) {
+    return procAddress(name);
+}
+
+void vkGetDeviceQueue(VkDevice, uint32_t, uint32_t, VkQueue* queue) {
+    *queue = newHandle<VkQueue>();
+}
+
+VkResult vkDeviceWaitIdle(VkDevice) { return VK_SUCCESS; }
+
+// --- Memory / resources --- //
+
+VkResult vkAllocateMemory(VkDevice, const VkMemoryAllocateInfo* info, const VkAllocationCallbacks*, VkDeviceMemory* memory) {
+    // only host visible memory is ever mapped, device local memory stays unbacked
+    *memory = newObject<VkDeviceMemory>(info->allocationSize, info->memoryTypeIndex == 1);
+    return VK_SUCCESS;
+}
+
+void vkFreeMemory(VkDevice, VkDeviceMemory memory, const VkAllocationCallbacks*) { freeObject(memory); }
+
+VkResult vkMapMemory(VkDevice, VkDeviceMemory memory, VkDeviceSize offset, VkDeviceSize, VkMemoryMapFlags, void** data) {
+    nullObject* object = objectOf(memory);
+    if (object == nullptr || object->bytes == nullptr) {
+        return VK_ERROR_MEMORY_MAP_FAILED;
+    }
+    *data = object->bytes + offset;
+    return VK_SUCCESS;
+}
+
+void vkUnmapMemory(VkDevice, VkDeviceMemory) {}
+
+VkResult vkInvalidateMappedMemoryRanges(VkDevice, uint32_t, const VkMappedMemoryRange*) { return VK_SUCCESS; }
+
+VkResult vkCreateBuffer(VkDevice, const VkBufferCreateInfo* info, const VkAllocationCallbacks*, VkBuffer* buffer) {
+    *buffer = newObject<VkBuffer>(info->size, false);
+    return VK_SUCCESS;
+}
+
+void vkDestroyBuffer(VkDevice, VkBuffer buffer, const VkAllocationCallbacks*) { freeObject(buffer); }
+
+void vkGetBufferMemoryRequirements(VkDevice, VkBuffer buffer, VkMemoryRequirements* requirements) {
+    requirements->size = objectOf(buffer)->size;
+    requirements->alignment = 256;
+    requirements->memoryTypeBits = 0x3;
+}
+
+VkResult vkBindBufferMemory(VkDevice, VkBuffer, VkDeviceMemory, VkDeviceSize) { return VK_SUCCESS; }
+
+VkResult vkCreateImage(VkDevice, const VkImageCreateInfo* info, const VkAllocationCallbacks*, VkImage* image) {
+    VkDeviceSize size = VkDeviceSize(info->extent.width) * info->extent.height * info->extent.depth * info->arrayLayers * 16;
+    *image = newObject<VkImage>(size, false);
+    return VK_SUCCESS;
+}
+
+void vkDestroyImage(VkDevice, VkImage image, const VkAllocationCallbacks*) { freeObject(image); }
+
+void vkGetImageMemoryRequirements(VkDevice, VkImage image, VkMemoryRequirements* requirements) {
+    requirements->size = objectOf(image)->size;
+    requirements->alignment = 4096;
+    requirements->memoryTypeBits = 0x3;
+}
+
+VkResult vkBindImageMemory(VkDevice, VkImage, VkDeviceMemory, VkDeviceSize) { return VK_SUCCESS; }
+
+VkResult vkCreateImageView(VkDevice, const VkImageViewCreateInfo*, const VkAllocationCallbacks*, VkImageView* view) {
+    *view = newHandle<VkImageView>();
+    return VK_SUCCESS;
+}
+
+void vkDestroyImageView(VkDevice, VkImageView, const VkAllocationCallbacks*) {}
+
+// --- Pipelines / passes --- //
+
+VkResult vkCreateShaderModule(VkDevice, const VkShaderModuleCreateInfo*, const VkAllocationCallbacks*, VkShaderModule* module) {
+    *module = newHandle<VkShaderModule>();
+    return VK_SUCCESS;
+}
+
+void vkDestroyShaderModule(VkDevice, VkShaderModule, const VkAllocationCallbacks*) {}
+
+VkResult vkCreatePipelineLayout(VkDevice, const VkPipelineLayoutCreateInfo*, const VkAllocationCallbacks*, VkPipelineLayout* layout) {
+    *layout = newHandle<VkPipelineLayout>();
+    return VK_SUCCESS;
+}
+
+void vkDestroyPipelineLayout(VkDevice, VkPipelineLayout, const VkAllocationCallbacks*) {}
+
+VkResult vkCreateGraphicsPipelines(VkDevice, VkPipelineCache, uint32_t count, const VkGraphicsPipelineCreateInfo*,
+                                   const VkAllocationCallbacks*, VkPipeline* pipelines) {
+    for (uint32_t i = 0; i < count; ++i) pipelines[i] = newHandle<VkPipeline>();
+    return VK_SUCCESS;
+}
+
+VkResult vkCreateComputePipelines(VkDevice, VkPipelineCache, uint32_t count, const VkComputePipelineCreateInfo*,
+                                  const VkAllocationCallbacks*, VkPipeline* pipelines) {
+    for (uint32_t i = 0; i < count; ++i) pipelines[i] = newHandle<VkPipeline>();
+    return VK_SUCCESS;
+}
+
+void vkDestroyPipeline(VkDevice, VkPipeline, const VkAllocationCallbacks*) {}
+
+VkResult vkCreateRenderPass(VkDevice, const VkRenderPassCreateInfo*, const VkAllocationCallbacks*, VkRenderPass* renderPass) {
+    *renderPass = newHandle<VkRenderPass>();
+    return VK_SUCCESS;
+}
+
+void vkDestroyRenderPass(VkDevice, VkRenderPass, const VkAllocationCallbacks*) {}
+
+VkResult vkCreateFramebuffer(VkDevice, const VkFramebufferCreateInfo*, const VkAllocationCallbacks*, VkFramebuffer* framebuffer) {
+    *framebuffer = newHandle<VkFramebuffer>();
+    return VK_SUCCESS;
+}
+
+void vkDestroyFramebuffer(VkDevice, VkFramebuffer, const VkAllocationCallbacks*) {}
+
+// --- Descriptors --- //
+
+VkResult vkCreateDescriptorSetLayout(VkDevice, const VkDescriptorSetLayoutCreateInfo*, const VkAllocationCallbacks*,
+                                     VkDescriptorSetLayout* layout) {
+    *layout = newHandle<VkDescriptorSetLayout>();
+    return VK_SUCCESS;
+}
+
+void vkDestroyDescriptorSetLayout(VkDevice, VkDescriptorSetLayout, const VkAllocationCallbacks*) {}
+
+VkResult vkCreateDescriptorPool(VkDevice, const VkDescriptorPoolCreateInfo*, const VkAllocationCallbacks*, VkDescriptorPool* pool) {
+    *pool = newHandle<VkDescriptorPool>();
+    return VK_SUCCESS;
+}
+
+void vkDestroyDescriptorPool(VkDevice, VkDescriptorPool, const VkAllocationCallbacks*) {}
+
+VkResult vkAllocateDescriptorSets(VkDevice, const VkDescriptorSetAllocateInfo* info, VkDescriptorSet* sets) {
+    for (uint32_t i = 0; i < info->descriptorSetCount; ++i) sets[i] = newHandle<VkDescriptorSet>();
+    return VK_SUCCESS;
+}
+
+void vkUpdateDescriptorSets(VkDevice, uint32_t, const VkWriteDescriptorSet*, uint32_t, const VkCopyDescriptorSet*) {}
+
+// --- Commands --- //
+
+VkResult vkCreateCommandPool(VkDevice, const VkCommandPoolCreateInfo*, const VkAllocationCallbacks*, VkCommandPool* pool) {
+    *pool = newHandle<VkCommandPool>();
+    return VK_SUCCESS;
+}
+
+void vkDestroyCommandPool(VkDevice, VkCommandPool, const VkAllocationCallbacks*) {}
+
+VkResult vkAllocateCommandBuffers(VkDevice, const VkCommandBufferAllocateInfo* info, VkCommandBuffer* buffers) {
+    for (uint32_t i = 0; i < info->commandBufferCount; ++i) buffers[i] = newHandle<VkCommandBuffer>();
+    return VK_SUCCESS;
+}
+
+void vkFreeCommandBuffers(VkDevice, VkCommandPool, uint32_t, const VkCommandBuffer*) {}
+
+VkResult vkBeginCommandBuffer(VkCommandBuffer, const VkCommandBufferBeginInfo*) { return VK_SUCCESS; }
+VkResult vkEndCommandBuffer(VkCommandBuffer) { return VK_SUCCESS; }
+VkResult vkResetCommandBuffer(VkCommandBuffer, VkCommandBufferResetFlags) { return VK_SUCCESS; }
+
+void vkCmdBeginRenderPass(VkCommandBuffer, const VkRenderPassBeginInfo*, VkSubpassContents) {}
+void vkCmdEndRenderPass(VkCommandBuffer) {}
+void vkCmdExecuteCommands(VkCommandBuffer, uint32_t, const VkCommandBuffer*) {}
+void vkCmdBindPipeline(VkCommandBuffer, VkPipelineBindPoint, VkPipeline) {}
+void vkCmdBindDescriptorSets(VkCommandBuffer, VkPipelineBindPoint, VkPipelineLayout, uint32_t, uint32_t,
+                             const VkDescriptorSet*, uint32_t, const uint32_t*) {}
+void vkCmdDraw(VkCommandBuffer, uint32_t, uint32_t, uint32_t, uint32_t) {}
+void vkCmdDispatch(VkCommandBuffer, uint32_t, uint32_t, uint32_t) {}
+void vkCmdPipelineBarrier(VkCommandBuffer, VkPipelineStageFlags, VkPipelineStageFlags, VkDependencyFlags,
+                          uint32_t, const VkMemoryBarrier*, uint32_t, const VkBufferMemoryBarrier*,
+                          uint32_t, const VkImageMemoryBarrier*) {}
+void vkCmdCopyBuffer(VkCommandBuffer, VkBuffer, VkBuffer, uint32_t, const VkBufferCopy*) {}
+void vkCmdCopyImageToBuffer(VkCommandBuffer, VkImage, VkImageLayout, VkBuffer, uint32_t, const VkBufferImageCopy*) {}
+void vkCmdBlitImage(VkCommandBuffer, VkImage, VkImageLayout, VkImage, VkImageLayout, uint32_t, const VkImageBlit*, VkFilter) {}
+void vkCmdClearColorImage(VkCommandBuffer, VkImage, VkImageLayout, const VkClearColorValue*, uint32_t,
+                          const VkImageSubresourceRange*) {}
+void vkCmdResetQueryPool(VkCommandBuffer, VkQueryPool, uint32_t, uint32_t) {}
+void vkCmdBeginQuery(VkCommandBuffer, VkQueryPool, uint32_t, VkQueryControlFlags) {}
+void vkCmdEndQuery(VkCommandBuffer, VkQueryPool, uint32_t) {}
+void vkCmdWriteTimestamp(VkCommandBuffer, VkPipelineStageFlagBits, VkQueryPool, uint32_t) {}
+
+// --- Synchronization / queries --- //
+
+VkResult vkCreateSemaphore(VkDevice, const VkSemaphoreCreateInfo*, const VkAllocationCallbacks*, VkSemaphore* semaphore) {
+    *semaphore = newHandle<VkSemaphore>();
+    return VK_SUCCESS;
+}
+
+void vkDestroySemaphore(VkDevice, VkSemaphore, const VkAllocationCallbacks*) {}
+
+VkResult vkCreateFence(VkDevice, const VkFenceCreateInfo*, const VkAllocationCallbacks*, VkFence* fence) {
+    *fence = newHandle<VkFence>();
+    return VK_SUCCESS;
+}
+
+void vkDestroyFence(VkDevice, VkFence, const VkAllocationCallbacks*) {}
+VkResult vkWaitForFences(VkDevice, uint32_t, const VkFence*, VkBool32, uint64_t) { return VK_SUCCESS; }
+VkResult vkResetFences(VkDevice, uint32_t, const VkFence*) { return VK_SUCCESS; }
+VkResult vkQueueSubmit(VkQueue, uint32_t, const VkSubmitInfo*, VkFence) { return VK_SUCCESS; }
+
+VkResult vkCreateQueryPool(VkDevice, const VkQueryPoolCreateInfo*, const VkAllocationCallbacks*, VkQueryPool* pool) {
+    *pool = newHandle<VkQueryPool>();
+    return VK_SUCCESS;
+}
+
+void vkDestroyQueryPool(VkDevice, VkQueryPool, const VkAllocationCallbacks*) {}
+
+VkResult vkGetQueryPoolResults(VkDevice, VkQueryPool, uint32_t, uint32_t, size_t dataSize, void* data,
+                               VkDeviceSize, VkQueryResultFlags) {
+    std::memset(data, 0, dataSize);
+    return VK_SUCCESS;
+}
+
+// --- Proc addresses --- //
+
+namespace {
+
+PFN_vkVoidFunction procAddress(const char* name) {
+#define NULL_PROC_ADDRESS(function) \
+    if (std::strcmp(name, #function) == 0) return reinterpret_cast<PFN_vkVoidFunction>(&function);
+    VK_GLOBAL_FUNCTIONS(NULL_PROC_ADDRESS)
+    VK_INSTANCE_FUNCTIONS(NULL_PROC_ADDRESS)
+    VK_DEVICE_FUNCTIONS(NULL_PROC_ADDRESS)
+#undef NULL_PROC_ADDRESS
+    return nullptr;
+}
+
+} // namespace
+
+// --- GLFW --- //
+// the harness runs headless : window creation fails, everything else is inert
+
+int glfwInit(void) { return GLFW_FALSE; }
+#if GLFW_VERSION_MAJOR > 3 || (GLFW_VERSION_MAJOR == 3 && GLFW_VERSION_MINOR >= 4)
+void glfwInitVulkanLoader(PFN_vkGetInstanceProcAddr) {}
+#endif
+void glfwTerminate(void) {}
+void glfwWindowHint(int, int) {}
+GLFWwindow* glfwCreateWindow(int, int, const char*, GLFWmonitor*, GLFWwindow*) { return nullptr; }
+void glfwDestroyWindow(GLFWwindow*) {}
+int glfwWindowShouldClose(GLFWwindow*) { return GLFW_TRUE; }
+void glfwPollEvents(void) {}
+void glfwWaitEventsTimeout(double) {}
+void glfwGetFramebufferSize(GLFWwindow*, int* width, int* height) { *width = 0; *height = 0; }
+int glfwGetWindowAttrib(GLFWwindow*, int) { return 0; }
+GLFWmonitor* glfwGetPrimaryMonitor(void) { return nullptr; }
+const GLFWvidmode* glfwGetVideoMode(GLFWmonitor*) { return nullptr; }
+void glfwSetWindowUserPointer(GLFWwindow*, void*) {}
+void* glfwGetWindowUserPointer(GLFWwindow*) { return nullptr; }
+GLFWwindowrefreshfun glfwSetWindowRefreshCallback(GLFWwindow*, GLFWwindowrefreshfun) { return nullptr; }
+GLFWframebuffersizefun glfwSetFramebufferSizeCallback(GLFWwindow*, GLFWframebuffersizefun) { return nullptr; }
+GLFWwindowiconifyfun glfwSetWindowIconifyCallback(GLFWwindow*, GLFWwindowiconifyfun) { return nullptr; }
+GLFWwindowfocusfun glfwSetWindowFocusCallback(GLFWwindow*, GLFWwindowfocusfun) { return nullptr; }
+GLFWkeyfun glfwSetKeyCallback(GLFWwindow*, GLFWkeyfun) { return nullptr; }
+GLFWcursorposfun glfwSetCursorPosCallback(GLFWwindow*, GLFWcursorposfun) { return nullptr; }
+GLFWmousebuttonfun glfwSetMouseButtonCallback(GLFWwindow*, GLFWmousebuttonfun) { return nullptr; }
+GLFWscrollfun glfwSetScrollCallback(GLFWwindow*, GLFWscrollfun) { return nullptr; }
+
+const char** glfwGetRequiredInstanceExtensions(uint32_t* count) {
+    *count = 0;
+    return nullptr;
+}
+
+VkResult glfwCreateWindowSurface(VkInstance, GLFWwindow*, const VkAllocationCallbacks*, VkSurfaceKHR* surface) {
+    *surface = VK_NULL_HANDLE;
+    return VK_ERROR_INITIALIZATION_FAILED;
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+#include <string_view>
+
+/* Asset pack (.pak), written by asset_packer, read by AssetPack.
+ * The table of contents sits right after the header so opening a pack is one
+ * small read; entries are sorted by (name hash, name) and looked up with a
+ * binary search. Entry data follows, each entry aligned to 16 bytes and in
+ * the order it was packed, so loading a group of assets packed together is
+ * one sequential read.
+ *
+ *   header | entries | blocks | names | data
+ *
+ * Compressed entries are cut into independent LZ4 blocks of blockSize raw
+ * bytes (lz4_block.hpp) that decompress in parallel. A block that doesn't
+ * shrink is stored raw (storedSize == rawSize). Entries with blockCount 0 are
+ * stored as is and can be used straight from the mapped file.
+ */
+
+constexpr uint32_t assetPackMagic = 0x4b415041;    // "APAK"
+constexpr uint32_t assetPackVersion = 1;
+constexpr uint32_t assetPackAlignment = 16;
+constexpr uint32_t assetPackBlockSize = 64 * 1024;  // LZ4 offsets reach 64 KiB back
+
+struct assetPackHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t blockCount;
+
+    uint32_t blockSize;
+    uint32_t nameBytes;
+    uint64_t fileSize;
+
+    uint64_t entryOffset;    // byte offsets from the start of the file
+    uint64_t blockOffset;
+    uint64_t nameOffset;
+    uint64_t dataOffset;     // first entry's data
+};
+static_assert(sizeof(assetPackHeader) % assetPackAlignment == 0, "header keeps the tables aligned");
+
+struct assetPackEntry
+{
+    uint64_t nameHash;       // FNV-1a of the name, the sort key
+    uint32_t nameOffset;     // into the names, not null terminated
+    uint32_t nameLength;
+    uint64_t dataOffset;     // from the start of the file
+    uint64_t size;           // uncompressed bytes
+    uint64_t storedSize;     // bytes in the file
+    uint32_t firstBlock;     // into the blocks
+    uint32_t blockCount;     // 0 : stored uncompressed
+};
+static_assert(sizeof(assetPackEntry) == 48, "assetPackEntry must stay 48 bytes");
+
+struct assetPackBlock
+{
+    uint64_t offset;         // from the start of the file
+    uint32_t storedSize;     // == rawSize : stored raw
+    uint32_t rawSize;        // blockSize, less for the entry's last block
+};
+static_assert(sizeof(assetPackBlock) == 16, "assetPackBlock must stay 16 bytes");
+
+inline uint64_t assetNameHash(std::string_view name) {
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : name) {
+        hash = (hash ^ static_cast<uint8_t>(c)) * 1099511628211ull;
+    }
+    return hash;
+}
+
+// table order, shared by the packer and the lookup
+inline bool assetEntryLess(uint64_t hash, std::string_view name, uint64_t otherHash, std::string_view otherName) {
+    return hash != otherHash ? hash < otherHash : name < otherName;
+}
@@ -0,0 +1,71 @@
+#include "pipeline_stats.hpp"
+#include "vk_dispatch.hpp"
+#include <stdexcept>
+
+namespace {
+
+// result order follows the bit order of the flags
+constexpr VkQueryPipelineStatisticFlags statisticFlags =
+    VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+constexpr uint32_t statisticCount = 3;
+
+} // namespace
+
+void PipelineStatistics::init(VkDevice c_device, const VkAllocationCallbacks* allocator, std::vector<std::string> groupNames) {
+    device = c_device;
+    hostAllocator = allocator;
+    groups.clear();
+    for (std::string& name : groupNames) {
+        drawGroupStats group{};
+        group.name = std::move(name);
+        groups.push_back(group);
+    }
+    written.assign(groups.size(), 0);
+
+    VkQueryPoolCreateInfo queryPoolInfo{};
+    queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+    queryPoolInfo.queryCount = static_cast<uint32_t>(groups.size());
+    queryPoolInfo.pipelineStatistics = statisticFlags;
+    if (vkd.vkCreateQueryPool(device, &queryPoolInfo, hostAllocator, &pool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create pipeline statistics query pool!");
+    }
+}
+
+void PipelineStatistics::reset(VkCommandBuffer commandBuffer) {
+    vkd.vkCmdResetQueryPool(commandBuffer, pool, 0, static_cast<uint32_t>(groups.size()));
+}
+
+void PipelineStatistics::begin(VkCommandBuffer commandBuffer, uint32_t group) {
+    vkd.vkCmdBeginQuery(commandBuffer, pool, group, 0);
+}
+
+void PipelineStatistics::end(VkCommandBuffer commandBuffer, uint32_t group) {
+    vkd.vkCmdEndQuery(commandBuffer, pool, group);
+    written[group] = 1;
+}
+
+// 上一帧已经通过 fence，结果无需等待；本帧没有执行的组返回 VK_NOT_READY，保持上次的值
+void PipelineStatistics::collect() {
+    uint64_t values[statisticCount] = {};
+    for (uint32_t group = 0; group < groups.size(); ++group) {
+        if (!written[group]) {
+            continue;
+        }
+        if (vkd.vkGetQueryPoolResults(device, pool, group, 1, sizeof(values), values, sizeof(values),
+                                      VK_QUERY_RESULT_64_BIT) == VK_SUCCESS) {
+            groups[group].vertexInvocations = values[0];
+            groups[group].clippingPrimitives = values[1];
+            groups[group].fragmentInvocations = values[2];
+        }
+    }
+}
+
+void PipelineStatistics::destroy() {
+    if (pool != VK_NULL_HANDLE) {
+        vkd.vkDestroyQueryPool(device, pool, hostAllocator);
+        pool = VK_NULL_HANDLE;
+    }
+}
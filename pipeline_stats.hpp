@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+/* Pipeline statistics queries around groups of draws.
+ * One query per group per frame : vertex shader invocations, primitives
+ * leaving the clipper and fragment shader invocations. Results are read
+ * without waiting once the frame's fence has signaled (collect()), so they
+ * describe the previous frame. Needs the pipelineStatisticsQuery feature.
+ */
+
+struct drawGroupStats
+{
+    std::string name;
+    uint64_t vertexInvocations = 0;
+    uint64_t clippingPrimitives = 0;
+    uint64_t fragmentInvocations = 0;
+};
+
+class PipelineStatistics
+{
+public:
+    void init(VkDevice device, const VkAllocationCallbacks* allocator, std::vector<std::string> groupNames);
+    void destroy();
+    bool enabled() const { return pool != VK_NULL_HANDLE; }
+
+    void reset(VkCommandBuffer commandBuffer);              // outside of render passes
+    void begin(VkCommandBuffer commandBuffer, uint32_t group);
+    void end(VkCommandBuffer commandBuffer, uint32_t group);
+    void collect();                                         // after the frame's fence
+    const std::vector<drawGroupStats>& results() const { return groups; }
+private:
+    VkDevice device = VK_NULL_HANDLE;
+    const VkAllocationCallbacks* hostAllocator = nullptr;
+    VkQueryPool pool = VK_NULL_HANDLE;
+    std::vector<drawGroupStats> groups;
+    std::vector<uint8_t> written;   // groups ever recorded, cached command buffers keep issuing them
+};
@@ -0,0 +1,453 @@
+#include "render_graph.hpp"
+#include "vk_dispatch.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+struct AccessInfo
+{
+    VkPipelineStageFlags stage;
+    VkAccessFlags access;
+    VkImageLayout layout;
+    bool write;
+};
+
+AccessInfo accessInfo(RGAccess access) {
+    switch (access) {
+    case RGAccess::ColorAttachment:
+        return {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, true};
+    case RGAccess::DepthAttachment:
+        return {VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, true};
+    case RGAccess::DepthRead:
+        return {VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT,
+                VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, false};
+    case RGAccess::FragmentSampled:
+        return {VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, false};
+    case RGAccess::ComputeSampled:
+        return {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, false};
+    case RGAccess::ComputeStorageRead:
+        return {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+                VK_IMAGE_LAYOUT_GENERAL, false};
+    case RGAccess::ComputeStorageWrite:
+        return {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+                VK_IMAGE_LAYOUT_GENERAL, true};
+    case RGAccess::TransferSrc:
+        return {VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+                VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, false};
+    case RGAccess::TransferDst:
+        return {VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, true};
+    case RGAccess::Present:
+        return {VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, false};
+    }
+    throw std::runtime_error("Unknown render graph access!");
+}
+
+uint32_t findMemoryType(VkPhysicalDevice physicalDevice, uint32_t typeBits, VkMemoryPropertyFlags properties) {
+    VkPhysicalDeviceMemoryProperties memProperties;
+    vkd.vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
+    for (uint32_t i = 0; i < memProperties.memoryTypeCount; ++i) {
+        if ((typeBits & (1u << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+            return i;
+        }
+    }
+    throw std::runtime_error("Failed to find suitable memory type for render graph!");
+}
+
+} // namespace
+
+// --- Declaration --- //
+RGResource RenderGraph::importImage(const std::string& name, VkImageAspectFlags aspect,
+                                    VkPipelineStageFlags availableStage, RGAccess finalAccess) {
+    Resource resource{};
+    resource.name = name;
+    resource.imported = true;
+    resource.exported = true;
+    resource.desc.aspect = aspect;
+    resource.availableStage = availableStage;
+    resource.finalAccess = finalAccess;
+    resources.push_back(resource);
+    return static_cast<RGResource>(resources.size() - 1);
+}
+
+RGResource RenderGraph::createTransient(const std::string& name, const RGImageDesc& desc) {
+    Resource resource{};
+    resource.name = name;
+    resource.desc = desc;
+    resources.push_back(resource);
+    return static_cast<RGResource>(resources.size() - 1);
+}
+
+void RenderGraph::bindImport(RGResource resource, VkImage image, VkImageView view) {
+    resources[resource].image = image;
+    resources[resource].view = view;
+}
+
+void RenderGraph::releaseToQueue(RGResource resource, uint32_t srcQueueFamily, uint32_t dstQueueFamily) {
+    if (!resources[resource].exported) {
+        throw std::runtime_error("Only imported images can change queue ownership: " + resources[resource].name);
+    }
+    resources[resource].srcQueueFamily = srcQueueFamily;
+    resources[resource].dstQueueFamily = dstQueueFamily;
+}
+
+void RenderGraph::addPass(const std::string& name, std::vector<RGUse> uses, RGExecute execute, bool sideEffect) {
+    Pass pass{};
+    pass.name = name;
+    pass.uses = std::move(uses);
+    pass.execute = std::move(execute);
+    pass.sideEffect = sideEffect;
+    passes.push_back(std::move(pass));
+}
+
+// --- Compile --- //
+void RenderGraph::compile(VkPhysicalDevice physicalDevice, VkDevice device, const VkAllocationCallbacks* allocator) {
+    hostAllocator = allocator;
+    graphStats = {};
+    graphStats.passes = static_cast<uint32_t>(passes.size());
+    cullPasses();
+    computeLifetimes();
+    allocateTransients(physicalDevice, device);
+    planBarriers();
+}
+
+// Walk passes backwards from the graph outputs, a pass survives only if
+// something downstream consumes what it writes.
+void RenderGraph::cullPasses() {
+    std::vector<bool> needed(resources.size(), false);
+    for (size_t i = 0; i < resources.size(); ++i) {
+        needed[i] = resources[i].exported;
+    }
+    for (size_t i = passes.size(); i-- > 0;) {
+        Pass& pass = passes[i];
+        bool live = pass.sideEffect;
+        for (const RGUse& use : pass.uses) {
+            if (accessInfo(use.access).write && needed[use.resource]) {
+                live = true;
+            }
+        }
+        pass.culled = !live;
+        if (!live) {
+            ++graphStats.culledPasses;
+            continue;
+        }
+        for (const RGUse& use : pass.uses) {
+            if (!accessInfo(use.access).write) {
+                needed[use.resource] = true;
+            }
+        }
+    }
+    livePasses.clear();
+    for (uint32_t i = 0; i < passes.size(); ++i) {
+        if (!passes[i].culled) {
+            livePasses.push_back(i);
+        }
+    }
+}
+
+void RenderGraph::computeLifetimes() {
+    for (Resource& resource : resources) {
+        resource.firstPass = -1;
+        resource.lastPass = -1;
+    }
+    for (int order = 0; order < static_cast<int>(livePasses.size()); ++order) {
+        for (const RGUse& use : passes[livePasses[order]].uses) {
+            Resource& resource = resources[use.resource];
+            if (resource.firstPass < 0) {
+                resource.firstPass = order;
+            }
+            resource.lastPass = order;
+        }
+    }
+}
+
+// Transients with disjoint [firstPass, lastPass] share one VkDeviceMemory at offset 0.
+void RenderGraph::allocateTransients(VkPhysicalDevice physicalDevice, VkDevice device) {
+    if (!memoryBlocks.empty()) {
+        throw std::runtime_error("Render graph transients are already allocated!");
+    }
+    std::vector<RGResource> transients;
+    std::vector<VkMemoryRequirements> requirements(resources.size());
+    for (RGResource index = 0; index < resources.size(); ++index) {
+        Resource& resource = resources[index];
+        if (resource.imported || resource.firstPass < 0) {
+            continue;
+        }
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.format = resource.desc.format;
+        imageInfo.extent = {resource.desc.extent.width, resource.desc.extent.height, 1};
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.usage = resource.desc.usage;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        if (vkd.vkCreateImage(device, &imageInfo, hostAllocator, &resource.image) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create transient image: " + resource.name);
+        }
+        vkd.vkGetImageMemoryRequirements(device, resource.image, &requirements[index]);
+        graphStats.transientBytes += requirements[index].size;
+        transients.push_back(index);
+    }
+    graphStats.transients = static_cast<uint32_t>(transients.size());
+
+    // biggest first, so smaller images fill blocks that already exist
+    std::sort(transients.begin(), transients.end(), [&](RGResource a, RGResource b) {
+        return requirements[a].size > requirements[b].size;
+    });
+    for (RGResource index : transients) {
+        Resource& resource = resources[index];
+        int chosen = -1;
+        for (int block = 0; block < static_cast<int>(memoryBlocks.size()) && chosen < 0; ++block) {
+            if ((memoryBlocks[block].typeBits & requirements[index].memoryTypeBits) == 0) {
+                continue;
+            }
+            bool overlaps = false;
+            for (RGResource other : memoryBlocks[block].occupants) {
+                if (resource.firstPass <= resources[other].lastPass &&
+                    resources[other].firstPass <= resource.lastPass) {
+                    overlaps = true;
+                    break;
+                }
+            }
+            if (!overlaps) {
+                chosen = block;
+            }
+        }
+        if (chosen < 0) {
+            memoryBlocks.emplace_back();
+            chosen = static_cast<int>(memoryBlocks.size() - 1);
+        }
+        MemoryBlock& block = memoryBlocks[chosen];
+        block.size = std::max(block.size, requirements[index].size);
+        block.typeBits &= requirements[index].memoryTypeBits;
+        block.occupants.push_back(index);
+        resource.memoryBlock = chosen;
+    }
+
+    for (MemoryBlock& block : memoryBlocks) {
+        VkMemoryAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.allocationSize = block.size;
+        allocInfo.memoryTypeIndex = findMemoryType(physicalDevice, block.typeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        if (vkd.vkAllocateMemory(device, &allocInfo, hostAllocator, &block.memory) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to allocate render graph memory!");
+        }
+        graphStats.aliasedBytes += block.size;
+
+        // previous occupant = the one that ends last before this one starts
+        for (RGResource index : block.occupants) {
+            Resource& resource = resources[index];
+            resource.aliasPredecessor = -1;
+            for (RGResource other : block.occupants) {
+                if (resources[other].lastPass < resource.firstPass &&
+                    (resource.aliasPredecessor < 0 ||
+                     resources[other].lastPass > resources[resource.aliasPredecessor].lastPass)) {
+                    resource.aliasPredecessor = static_cast<int>(other);
+                }
+            }
+            if (vkd.vkBindImageMemory(device, resource.image, block.memory, 0) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to bind transient image memory: " + resource.name);
+            }
+
+            VkImageViewCreateInfo viewInfo{};
+            viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+            viewInfo.image = resource.image;
+            viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+            viewInfo.format = resource.desc.format;
+            viewInfo.subresourceRange.aspectMask = resource.desc.aspect;
+            viewInfo.subresourceRange.baseMipLevel = 0;
+            viewInfo.subresourceRange.levelCount = 1;
+            viewInfo.subresourceRange.baseArrayLayer = 0;
+            viewInfo.subresourceRange.layerCount = 1;
+            if (vkd.vkCreateImageView(device, &viewInfo, hostAllocator, &resource.view) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create transient image view: " + resource.name);
+            }
+        }
+    }
+}
+
+/* Track the last write and the reads since then for every image, and emit a
+ * barrier only for a layout change, a read that hasn't seen the last write yet,
+ * or a write after any earlier use (WAW / WAR). Barriers of one pass are merged
+ * into a single vkCmdPipelineBarrier.
+ */
+void RenderGraph::planBarriers() {
+    struct State
+    {
+        VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkPipelineStageFlags writeStage = 0;
+        VkAccessFlags writeAccess = 0;
+        VkPipelineStageFlags readStages = 0;
+        VkPipelineStageFlags visibleStages = 0;
+        VkAccessFlags visibleAccess = 0;
+    };
+    std::vector<State> states(resources.size());
+    for (size_t i = 0; i < resources.size(); ++i) {
+        if (resources[i].imported) {
+            states[i].writeStage = resources[i].availableStage;
+        }
+    }
+
+    passBarriers.assign(livePasses.size(), {});
+    finalBarriers = {};
+    for (int order = 0; order < static_cast<int>(livePasses.size()); ++order) {
+        BarrierBatch& batch = passBarriers[order];
+        for (const RGUse& use : passes[livePasses[order]].uses) {
+            const Resource& resource = resources[use.resource];
+            State& state = states[use.resource];
+            AccessInfo info = accessInfo(use.access);
+
+            if (!resource.imported && order == resource.firstPass && resource.aliasPredecessor >= 0) {
+                // memory was last used by another image, wait for it to finish
+                const State& previous = states[resource.aliasPredecessor];
+                state.writeStage = previous.writeStage | previous.readStages;
+                state.writeAccess = previous.writeAccess;
+            }
+
+            bool layoutChange = state.layout != info.layout;
+            bool needed;
+            VkPipelineStageFlags srcStage;
+            if (info.write) {
+                srcStage = state.writeStage | state.readStages;
+                needed = layoutChange || srcStage != 0;
+            } else {
+                srcStage = state.writeStage;
+                bool visible = (info.stage & ~state.visibleStages) == 0 &&
+                               (info.access & ~state.visibleAccess) == 0;
+                needed = layoutChange || (!visible && state.writeStage != 0);
+            }
+
+            if (needed) {
+                batch.srcStage |= srcStage != 0 ? srcStage : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+                batch.dstStage |= info.stage;
+                batch.barriers.push_back({use.resource, state.layout, info.layout, state.writeAccess, info.access});
+            }
+
+            if (info.write) {
+                state.writeStage = info.stage;
+                state.writeAccess = info.access;
+                state.readStages = 0;
+                state.visibleStages = 0;
+                state.visibleAccess = 0;
+            } else {
+                if (needed && layoutChange) {
+                    // the transition is the new "write" later readers have to chain after
+                    state.writeStage = info.stage;
+                    state.writeAccess = 0;
+                    state.visibleStages = 0;
+                    state.visibleAccess = 0;
+                }
+                if (needed) {
+                    state.visibleStages |= info.stage;
+                    state.visibleAccess |= info.access;
+                }
+                state.readStages |= info.stage;
+            }
+            state.layout = info.layout;
+        }
+        graphStats.barriers += static_cast<uint32_t>(batch.barriers.size());
+    }
+
+    for (RGResource index = 0; index < resources.size(); ++index) {
+        const Resource& resource = resources[index];
+        if (!resource.exported) {
+            continue;
+        }
+        const State& state = states[index];
+        AccessInfo info = accessInfo(resource.finalAccess);
+        bool visible = (info.stage & ~state.visibleStages) == 0 &&
+                       (info.access & ~state.visibleAccess) == 0;
+        bool release = resource.srcQueueFamily != resource.dstQueueFamily;
+        if (!release && state.layout == info.layout && (visible || info.access == 0)) {
+            continue;
+        }
+        VkPipelineStageFlags srcStage = state.writeStage | state.readStages;
+        finalBarriers.srcStage |= srcStage != 0 ? srcStage : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+        if (release) {
+            // dst stage / access of a release are ignored, the acquire on the other queue waits
+            finalBarriers.dstStage |= VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+            finalBarriers.barriers.push_back({index, state.layout, info.layout, state.writeAccess, 0,
+                                              resource.srcQueueFamily, resource.dstQueueFamily});
+            continue;
+        }
+        finalBarriers.dstStage |= info.stage;
+        finalBarriers.barriers.push_back({index, state.layout, info.layout, state.writeAccess, info.access});
+    }
+    graphStats.barriers += static_cast<uint32_t>(finalBarriers.barriers.size());
+}
+
+// --- Execute --- //
+void RenderGraph::recordBatch(VkCommandBuffer commandBuffer, const BarrierBatch& batch) const {
+    if (batch.barriers.empty()) {
+        return;
+    }
+    std::vector<VkImageMemoryBarrier> imageBarriers(batch.barriers.size());
+    for (size_t i = 0; i < batch.barriers.size(); ++i) {
+        const Barrier& barrier = batch.barriers[i];
+        const Resource& resource = resources[barrier.resource];
+        VkImageMemoryBarrier& imageBarrier = imageBarriers[i];
+        imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        imageBarrier.srcAccessMask = barrier.srcAccess;
+        imageBarrier.dstAccessMask = barrier.dstAccess;
+        imageBarrier.oldLayout = barrier.oldLayout;
+        imageBarrier.newLayout = barrier.newLayout;
+        imageBarrier.srcQueueFamilyIndex = barrier.srcQueueFamily;
+        imageBarrier.dstQueueFamilyIndex = barrier.dstQueueFamily;
+        imageBarrier.image = resource.image;
+        imageBarrier.subresourceRange.aspectMask = resource.desc.aspect;
+        imageBarrier.subresourceRange.baseMipLevel = 0;
+        imageBarrier.subresourceRange.levelCount = 1;
+        imageBarrier.subresourceRange.baseArrayLayer = 0;
+        imageBarrier.subresourceRange.layerCount = 1;
+    }
+    vkd.vkCmdPipelineBarrier(commandBuffer, batch.srcStage, batch.dstStage, 0,
+                             0, nullptr, 0, nullptr,
+                             static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+}
+
+void RenderGraph::execute(VkCommandBuffer commandBuffer) const {
+    for (size_t order = 0; order < livePasses.size(); ++order) {
+        recordBatch(commandBuffer, passBarriers[order]);
+        const Pass& pass = passes[livePasses[order]];
+        if (pass.execute) {
+            pass.execute(commandBuffer, *this);
+        }
+    }
+    recordBatch(commandBuffer, finalBarriers);
+}
+
+// --- Cleanup --- //
+void RenderGraph::destroy(VkDevice device) {
+    for (Resource& resource : resources) {
+        if (resource.imported) {
+            continue;
+        }
+        if (resource.view != VK_NULL_HANDLE) {
+            vkd.vkDestroyImageView(device, resource.view, hostAllocator);
+        }
+        if (resource.image != VK_NULL_HANDLE) {
+            vkd.vkDestroyImage(device, resource.image, hostAllocator);
+        }
+    }
+    for (MemoryBlock& block : memoryBlocks) {
+        vkd.vkFreeMemory(device, block.memory, hostAllocator);
+    }
+    resources.clear();
+    passes.clear();
+    livePasses.clear();
+    passBarriers.clear();
+    finalBarriers = {};
+    memoryBlocks.clear();
+}
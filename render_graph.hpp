@@ -0,0 +1,147 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+/* Frame graph over a single command buffer.
+ * Passes declare which images they read / write (RGAccess), compile() culls
+ * passes whose results are never consumed, derives the minimal set of layout
+ * transitions + barriers between passes, and places transient images whose
+ * lifetimes do not overlap into the same VkDeviceMemory.
+ */
+
+using RGResource = uint32_t;
+
+enum class RGAccess : uint8_t {
+    ColorAttachment,      // write, COLOR_ATTACHMENT_OPTIMAL
+    DepthAttachment,      // write, DEPTH_STENCIL_ATTACHMENT_OPTIMAL
+    DepthRead,            // depth test only, DEPTH_STENCIL_READ_ONLY_OPTIMAL
+    FragmentSampled,      // sampled in fragment shader
+    ComputeSampled,       // sampled in compute shader
+    ComputeStorageRead,   // imageLoad in compute shader
+    ComputeStorageWrite,  // imageStore in compute shader
+    TransferSrc,
+    TransferDst,
+    Present,              // only valid as final access of an imported image
+};
+
+struct RGImageDesc
+{
+    VkFormat format;
+    VkExtent2D extent;
+    VkImageUsageFlags usage;
+    VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+};
+
+struct RGUse
+{
+    RGResource resource;
+    RGAccess access;
+};
+
+class RenderGraph;
+using RGExecute = std::function<void(VkCommandBuffer, const RenderGraph&)>;
+
+struct RGStats
+{
+    uint32_t passes = 0;
+    uint32_t culledPasses = 0;
+    uint32_t barriers = 0;            // image barriers recorded per execute()
+    uint32_t transients = 0;
+    VkDeviceSize transientBytes = 0;  // memory without aliasing
+    VkDeviceSize aliasedBytes = 0;    // memory actually allocated
+};
+
+class RenderGraph
+{
+public:
+    // Imported images live outside of the graph (e.g. swap chain images).
+    // `availableStage` is the stage the image becomes usable at (semaphore wait stage),
+    // `finalAccess` marks the image as a graph output and is the state it's left in.
+    RGResource importImage(const std::string& name, VkImageAspectFlags aspect,
+                           VkPipelineStageFlags availableStage, RGAccess finalAccess);
+    RGResource createTransient(const std::string& name, const RGImageDesc& desc);
+    void bindImport(RGResource resource, VkImage image, VkImageView view);
+    // Release an exported image to another queue family at the end of the graph,
+    // the receiving queue records the matching acquire barrier.
+    void releaseToQueue(RGResource resource, uint32_t srcQueueFamily, uint32_t dstQueueFamily);
+
+    void addPass(const std::string& name, std::vector<RGUse> uses, RGExecute execute,
+                 bool sideEffect = false);
+
+    void compile(VkPhysicalDevice physicalDevice, VkDevice device, const VkAllocationCallbacks* allocator = nullptr);
+    void execute(VkCommandBuffer commandBuffer) const;
+    void destroy(VkDevice device);
+
+    VkImage image(RGResource resource) const { return resources[resource].image; }
+    VkImageView view(RGResource resource) const { return resources[resource].view; }
+    const RGStats& stats() const { return graphStats; }
+private:
+    struct Resource
+    {
+        std::string name;
+        bool imported = false;
+        bool exported = false;
+        RGImageDesc desc{};
+        VkPipelineStageFlags availableStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+        RGAccess finalAccess = RGAccess::Present;
+        uint32_t srcQueueFamily = VK_QUEUE_FAMILY_IGNORED;  // final ownership release
+        uint32_t dstQueueFamily = VK_QUEUE_FAMILY_IGNORED;
+        VkImage image = VK_NULL_HANDLE;
+        VkImageView view = VK_NULL_HANDLE;
+        // lifetime in live pass order, transient only
+        int firstPass = -1;
+        int lastPass = -1;
+        int memoryBlock = -1;
+        int aliasPredecessor = -1;  // previous occupant of the same memory
+    };
+    struct Pass
+    {
+        std::string name;
+        std::vector<RGUse> uses;
+        RGExecute execute;
+        bool sideEffect = false;
+        bool culled = false;
+    };
+    struct Barrier
+    {
+        RGResource resource;
+        VkImageLayout oldLayout;
+        VkImageLayout newLayout;
+        VkAccessFlags srcAccess;
+        VkAccessFlags dstAccess;
+        uint32_t srcQueueFamily = VK_QUEUE_FAMILY_IGNORED;
+        uint32_t dstQueueFamily = VK_QUEUE_FAMILY_IGNORED;
+    };
+    struct BarrierBatch
+    {
+        VkPipelineStageFlags srcStage = 0;
+        VkPipelineStageFlags dstStage = 0;
+        std::vector<Barrier> barriers;
+    };
+    struct MemoryBlock
+    {
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkDeviceSize size = 0;
+        uint32_t typeBits = ~0u;
+        std::vector<RGResource> occupants;
+    };
+private:
+    void cullPasses();
+    void computeLifetimes();
+    void allocateTransients(VkPhysicalDevice physicalDevice, VkDevice device);
+    void planBarriers();
+    void recordBatch(VkCommandBuffer commandBuffer, const BarrierBatch& batch) const;
+private:
+    std::vector<Resource> resources;
+    std::vector<Pass> passes;
+    std::vector<uint32_t> livePasses;
+    std::vector<BarrierBatch> passBarriers;  // one per live pass, recorded before it
+    BarrierBatch finalBarriers;
+    std::vector<MemoryBlock> memoryBlocks;
+    RGStats graphStats;
+    const VkAllocationCallbacks* hostAllocator = nullptr;
+};
@@ -0,0 +1,365 @@
+#include "scene_store.hpp"
+#include "job_system.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+constexpr uint32_t parallelGrain = 2048; // objects per job, below that a level runs inline
+
+const mat4 identity = {{1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 0.f, 1.f}};
+
+} // namespace
+
+// --- Matrix streams --- //
+void SceneStore::matrixStreams::resize(uint32_t size) {
+    for (int e = 0; e < 16; ++e) {
+        data[e].resize(size);
+        view.m[e] = data[e].data();
+    }
+}
+
+void SceneStore::matrixStreams::set(uint32_t i, const mat4& value) {
+    for (int e = 0; e < 16; ++e) {
+        data[e][i] = value.m[e];
+    }
+}
+
+mat4 SceneStore::matrixStreams::get(uint32_t i) const {
+    mat4 value{};
+    for (int e = 0; e < 16; ++e) {
+        value.m[e] = data[e][i];
+    }
+    return value;
+}
+
+void SceneStore::matrixStreams::copy(uint32_t dst, uint32_t src) {
+    for (int e = 0; e < 16; ++e) {
+        data[e][dst] = data[e][src];
+    }
+}
+
+// --- Objects --- //
+SceneStore::SceneStore(uint32_t frameSlots) : slotCount(frameSlots) {
+    if (frameSlots == 0 || frameSlots > maxFrameSlots) {
+        throw std::runtime_error("SceneStore: unsupported frame slot count");
+    }
+}
+
+uint32_t SceneStore::resolve(sceneHandle handle) const {
+    if (!valid(handle)) {
+        throw std::runtime_error("SceneStore: stale or invalid handle");
+    }
+    return handle.index;
+}
+
+bool SceneStore::valid(sceneHandle handle) const {
+    return handle.index < slots.size() && slots[handle.index].generation == handle.generation &&
+           slots[handle.index].dense != none;
+}
+
+sceneHandle SceneStore::create(sceneHandle parent) {
+    uint32_t parentSlot = parent == sceneHandle{} ? none : resolve(parent);
+    uint32_t index;
+    if (!freeSlots.empty()) {
+        index = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        index = static_cast<uint32_t>(slots.size());
+        slots.emplace_back();
+    }
+    uint32_t dense = count++;
+    if (dense >= denseSlot.size()) {
+        // grow geometrically, the streams are reallocated together
+        uint32_t capacity = std::max(64u, dense * 2);
+        denseSlot.resize(capacity);
+        local.resize(capacity);
+        world.resize(capacity);
+        pendingMask.resize(capacity, 0);
+    }
+    denseSlot[dense] = index;
+    local.set(dense, identity);
+    world.set(dense, identity);
+
+    slot& object = slots[index];
+    object.dense = dense;
+    object.parent = none;
+    object.firstChild = none;
+    object.nextSibling = none;
+    object.depth = 0;
+    object.dirty = false;
+    if (parentSlot != none) {
+        link(index, parentSlot);
+        object.depth = slots[parentSlot].depth + 1;
+    }
+    markDirty(index);
+    return {index, object.generation};
+}
+
+void SceneStore::destroy(sceneHandle handle) {
+    if (!valid(handle)) {
+        return;
+    }
+    unlink(handle.index);
+    stack.clear();
+    stack.push_back(handle.index);
+    while (!stack.empty()) {
+        uint32_t index = stack.back();
+        stack.pop_back();
+        for (uint32_t child = slots[index].firstChild; child != none; child = slots[child].nextSibling) {
+            stack.push_back(child);
+        }
+        // swap-remove : the last instance moves into the hole and has to be uploaded again
+        uint32_t dense = slots[index].dense;
+        uint32_t last = --count;
+        if (dense != last) {
+            local.copy(dense, last);
+            world.copy(dense, last);
+            denseSlot[dense] = denseSlot[last];
+            slots[denseSlot[dense]].dense = dense;
+            queueUpload(dense);
+        }
+        slot& object = slots[index];
+        object.generation++;
+        object.dense = none;
+        object.dirty = false;
+        freeSlots.push_back(index);
+    }
+}
+
+void SceneStore::link(uint32_t child, uint32_t parent) {
+    slots[child].parent = parent;
+    slots[child].nextSibling = slots[parent].firstChild;
+    slots[parent].firstChild = child;
+}
+
+void SceneStore::unlink(uint32_t child) {
+    uint32_t parent = slots[child].parent;
+    if (parent == none) {
+        return;
+    }
+    uint32_t* link = &slots[parent].firstChild;
+    while (*link != child) {
+        link = &slots[*link].nextSibling;
+    }
+    *link = slots[child].nextSibling;
+    slots[child].parent = none;
+    slots[child].nextSibling = none;
+}
+
+void SceneStore::updateDepths(uint32_t root) {
+    stack.clear();
+    stack.push_back(root);
+    while (!stack.empty()) {
+        uint32_t index = stack.back();
+        stack.pop_back();
+        uint32_t parent = slots[index].parent;
+        slots[index].depth = parent == none ? 0 : slots[parent].depth + 1;
+        for (uint32_t child = slots[index].firstChild; child != none; child = slots[child].nextSibling) {
+            stack.push_back(child);
+        }
+    }
+}
+
+void SceneStore::setParent(sceneHandle handle, sceneHandle parent) {
+    uint32_t index = resolve(handle);
+    uint32_t parentSlot = parent == sceneHandle{} ? none : resolve(parent);
+    for (uint32_t ancestor = parentSlot; ancestor != none; ancestor = slots[ancestor].parent) {
+        if (ancestor == index) {
+            throw std::runtime_error("SceneStore: setParent would create a cycle");
+        }
+    }
+    unlink(index);
+    if (parentSlot != none) {
+        link(index, parentSlot);
+    }
+    updateDepths(index);
+    markDirty(index);
+}
+
+void SceneStore::setLocalTransform(sceneHandle handle, const mat4& value) {
+    uint32_t index = resolve(handle);
+    local.set(slots[index].dense, value);
+    markDirty(index);
+}
+
+mat4 SceneStore::localTransform(sceneHandle handle) const {
+    return local.get(slots[resolve(handle)].dense);
+}
+
+mat4 SceneStore::worldTransform(sceneHandle handle) const {
+    return world.get(slots[resolve(handle)].dense);
+}
+
+uint32_t SceneStore::instanceIndex(sceneHandle handle) const {
+    return slots[resolve(handle)].dense;
+}
+
+void SceneStore::markDirty(uint32_t index) {
+    if (!slots[index].dirty) {
+        slots[index].dirty = true;
+        dirtyList.push_back(index);
+    }
+}
+
+void SceneStore::queueUpload(uint32_t instance) {
+    for (uint32_t f = 0; f < slotCount; ++f) {
+        uint8_t bit = static_cast<uint8_t>(1u << f);
+        if ((pendingMask[instance] & bit) == 0) {
+            pendingMask[instance] |= bit;
+            pending[f].push_back(instance);
+        }
+    }
+}
+
+// --- Propagation --- //
+sceneUpdateStats SceneStore::update(JobSystem* jobs) {
+    sceneUpdateStats stats{};
+    // dirty objects and their subtrees, each visited once even when nested dirty objects overlap
+    ++stamp;
+    updateList.clear();
+    for (uint32_t index : dirtyList) {
+        if (slots[index].dense == none || !slots[index].dirty) {
+            continue; // destroyed since it was marked
+        }
+        slots[index].dirty = false;
+        stats.dirty++;
+        stack.clear();
+        stack.push_back(index);
+        while (!stack.empty()) {
+            uint32_t node = stack.back();
+            stack.pop_back();
+            if (slots[node].visited == stamp) {
+                continue; // its subtree is already in the list
+            }
+            slots[node].visited = stamp;
+            updateList.push_back(node);
+            for (uint32_t child = slots[node].firstChild; child != none; child = slots[child].nextSibling) {
+                stack.push_back(child);
+            }
+        }
+    }
+    dirtyList.clear();
+    stats.propagated = static_cast<uint32_t>(updateList.size());
+    if (updateList.empty()) {
+        return stats;
+    }
+
+    // parents before children : counting sort by depth, one batch per level
+    depthStart.assign(1, 0);
+    for (uint32_t index : updateList) {
+        uint32_t depth = slots[index].depth;
+        if (depth + 2 > depthStart.size()) {
+            depthStart.resize(depth + 2, 0);
+        }
+        depthStart[depth + 1]++;
+    }
+    for (size_t d = 1; d < depthStart.size(); ++d) {
+        depthStart[d] += depthStart[d - 1];
+    }
+    sortedList.resize(updateList.size());
+    for (uint32_t index : updateList) {
+        sortedList[depthStart[slots[index].depth]++] = index;
+    }
+    updateList.swap(sortedList);
+    const simdKernels& kernels = simdDispatch();
+    size_t begin = 0;
+    while (begin < updateList.size()) {
+        uint32_t depth = slots[updateList[begin]].depth;
+        size_t end = begin;
+        while (end < updateList.size() && slots[updateList[end]].depth == depth) {
+            ++end;
+        }
+        uint32_t batch = static_cast<uint32_t>(end - begin);
+        if (depth == 0) {
+            for (size_t i = begin; i < end; ++i) {
+                uint32_t dense = slots[updateList[i]].dense;
+                for (int e = 0; e < 16; ++e) {
+                    world.data[e][dense] = local.data[e][dense];
+                }
+            }
+        } else {
+            if (parentScratch.data[0].size() < batch) {
+                parentScratch.resize(batch);
+                localScratch.resize(batch);
+            }
+            // gather, multiply and scatter touch disjoint scratch / world entries per chunk
+            const uint32_t* level = updateList.data() + begin;
+            auto multiplyChunk = [&](uint32_t first, uint32_t last) {
+                // one stream at a time keeps the gathers / scatters sequential per array
+                for (int e = 0; e < 16; ++e) {
+                    const float* parentWorld = world.data[e].data();
+                    const float* objectLocal = local.data[e].data();
+                    for (uint32_t i = first; i < last; ++i) {
+                        const slot& object = slots[level[i]];
+                        parentScratch.data[e][i] = parentWorld[slots[object.parent].dense];
+                        localScratch.data[e][i] = objectLocal[object.dense];
+                    }
+                }
+                kernels.multiplyBatch(parentScratch.view, localScratch.view, localScratch.view, first, last);
+                for (int e = 0; e < 16; ++e) {
+                    float* objectWorld = world.data[e].data();
+                    for (uint32_t i = first; i < last; ++i) {
+                        objectWorld[slots[level[i]].dense] = localScratch.data[e][i];
+                    }
+                }
+            };
+            if (jobs != nullptr) {
+                jobs->parallelFor(batch, parallelGrain, multiplyChunk);
+            } else {
+                multiplyChunk(0, batch);
+            }
+        }
+        begin = end;
+    }
+    for (uint32_t index : updateList) {
+        queueUpload(slots[index].dense);
+    }
+    return stats;
+}
+
+// --- Uploads --- //
+void SceneStore::collectUploads(uint32_t frameSlot, std::vector<sceneCopyRange>& ranges, uint32_t mergeGap) {
+    if (frameSlot >= slotCount) {
+        throw std::runtime_error("SceneStore: frame slot out of range");
+    }
+    ranges.clear();
+    std::vector<uint32_t>& queue = pending[frameSlot];
+    const uint8_t bit = static_cast<uint8_t>(1u << frameSlot);
+    auto append = [&](uint32_t instance) {
+        if (!ranges.empty() && instance - (ranges.back().first + ranges.back().count) <= mergeGap) {
+            ranges.back().count = instance - ranges.back().first + 1;
+        } else {
+            ranges.push_back({instance, 1});
+        }
+    };
+    if (queue.size() * 8 > count) {
+        // most of the scene changed : a linear scan of the mask beats sorting the queue
+        for (uint32_t instance : queue) {
+            if (instance >= count) {
+                pendingMask[instance] &= static_cast<uint8_t>(~bit); // removed after it was queued
+            }
+        }
+        for (uint32_t instance = 0; instance < count; ++instance) {
+            if (pendingMask[instance] & bit) {
+                pendingMask[instance] &= static_cast<uint8_t>(~bit);
+                append(instance);
+            }
+        }
+    } else {
+        std::sort(queue.begin(), queue.end());
+        for (uint32_t instance : queue) {
+            pendingMask[instance] &= static_cast<uint8_t>(~bit);
+            if (instance < count) { // else removed after it was queued
+                append(instance);
+            }
+        }
+    }
+    queue.clear();
+}
+
+void SceneStore::writeInstance(uint32_t instance, float* out) const {
+    for (int e = 0; e < 16; ++e) {
+        out[e] = world.data[e][instance];
+    }
+}
@@ -0,0 +1,115 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "simd_math.hpp"
+
+class JobSystem;
+
+/* Scene objects with hierarchical transforms in structure-of-arrays form.
+ * Handles are (slot, generation) pairs, a destroyed object's handle never
+ * resolves again even if its slot is reused. Object data is kept dense
+ * (swap-remove), the dense index is also the GPU instance index.
+ * update() recomputes world transforms only for dirty objects and their
+ * subtrees, depth by depth with the SIMD multiply kernel (wide levels are
+ * split across the job system when one is given), and queues the
+ * changed instances for every frame slot; collectUploads() turns one slot's
+ * queue into sorted, coalesced copy ranges.
+ */
+
+struct sceneHandle
+{
+    uint32_t index = UINT32_MAX;   // slot
+    uint32_t generation = 0;
+    bool operator==(const sceneHandle& other) const = default;
+};
+
+struct sceneCopyRange
+{
+    uint32_t first;  // dense instance index
+    uint32_t count;
+};
+
+struct sceneUpdateStats
+{
+    uint32_t dirty = 0;        // objects changed through the API
+    uint32_t propagated = 0;   // world transforms recomputed, subtrees included
+};
+
+class SceneStore
+{
+public:
+    static constexpr uint32_t maxFrameSlots = 8;
+
+    explicit SceneStore(uint32_t frameSlots = 2);
+
+    sceneHandle create(sceneHandle parent = {});
+    void destroy(sceneHandle handle);   // the whole subtree
+    bool valid(sceneHandle handle) const;
+    void setParent(sceneHandle handle, sceneHandle parent);
+    void setLocalTransform(sceneHandle handle, const mat4& local);
+    mat4 localTransform(sceneHandle handle) const;
+    mat4 worldTransform(sceneHandle handle) const;   // as of the last update()
+    uint32_t instanceIndex(sceneHandle handle) const;
+
+    sceneUpdateStats update(JobSystem* jobs = nullptr);
+    // Instances changed since `frameSlot` last collected, in increasing order.
+    // Ranges separated by at most `mergeGap` clean instances are merged: one
+    // bigger copy is cheaper than many small regions.
+    void collectUploads(uint32_t frameSlot, std::vector<sceneCopyRange>& ranges, uint32_t mergeGap = 4);
+
+    uint32_t size() const { return count; }
+    uint32_t frameSlots() const { return slotCount; }
+    const mat4SoA& worldTransforms() const { return world.view; }   // dense instance order, as of the last update()
+    void writeInstance(uint32_t instance, float* out) const;   // 16 floats, column-major world matrix
+private:
+    static constexpr uint32_t none = UINT32_MAX;
+
+    struct matrixStreams
+    {
+        std::vector<float> data[16];
+        mat4SoA view{};
+        void resize(uint32_t size);
+        void set(uint32_t i, const mat4& value);
+        mat4 get(uint32_t i) const;
+        void copy(uint32_t dst, uint32_t src);
+    };
+    struct slot
+    {
+        uint32_t generation = 0;
+        uint32_t dense = none;
+        uint32_t parent = none;
+        uint32_t firstChild = none;
+        uint32_t nextSibling = none;
+        uint32_t depth = 0;
+        uint32_t visited = 0;   // update() stamp
+        bool dirty = false;
+    };
+private:
+    uint32_t resolve(sceneHandle handle) const;   // slot, throws if stale
+    void link(uint32_t child, uint32_t parent);
+    void unlink(uint32_t child);
+    void markDirty(uint32_t slotIndex);
+    void queueUpload(uint32_t instance);
+    void updateDepths(uint32_t root);
+private:
+    uint32_t slotCount;
+    uint32_t count = 0;
+    std::vector<slot> slots;
+    std::vector<uint32_t> freeSlots;
+    std::vector<uint32_t> denseSlot;   // dense -> slot
+    matrixStreams local;
+    matrixStreams world;
+
+    std::vector<uint32_t> dirtyList;
+    uint32_t stamp = 0;
+    std::vector<uint32_t> updateList;
+    std::vector<uint32_t> sortedList;
+    std::vector<uint32_t> depthStart;
+    std::vector<uint32_t> stack;
+    matrixStreams parentScratch;
+    matrixStreams localScratch;
+
+    std::vector<uint32_t> pending[maxFrameSlots];
+    std::vector<uint8_t> pendingMask;  // bit f set <=> the instance is queued in pending[f]
+};
@@ -0,0 +1,89 @@
+#include "shader_variants.hpp"
+#include "vk_dispatch.hpp"
+#include <cstring>
+#include <stdexcept>
+
+uint32_t specFloat(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+ShaderVariants::ShaderVariants(std::vector<specConstant> c_constants, buildFunction c_build)
+    : constants(std::move(c_constants)), build(std::move(c_build)) {
+    for (size_t i = 0; i < constants.size(); ++i) {
+        for (size_t j = 0; j < i; ++j) {
+            if (constants[j].id == constants[i].id || constants[j].name == constants[i].name) {
+                throw std::runtime_error("ShaderVariants: duplicate specialization constant " + constants[i].name);
+            }
+        }
+        // key values are laid out back to back, the key itself is the specialization data
+        VkSpecializationMapEntry entry{};
+        entry.constantID = constants[i].id;
+        entry.offset = static_cast<uint32_t>(i * sizeof(uint32_t));
+        entry.size = sizeof(uint32_t);
+        entries.push_back(entry);
+    }
+}
+
+variantKey ShaderVariants::defaults() const {
+    variantKey key;
+    for (const specConstant& constant : constants) {
+        key.push_back(constant.defaultValue);
+    }
+    return key;
+}
+
+size_t ShaderVariants::indexOf(const std::string& name) const {
+    for (size_t i = 0; i < constants.size(); ++i) {
+        if (constants[i].name == name) {
+            return i;
+        }
+    }
+    throw std::runtime_error("ShaderVariants: unknown specialization constant " + name);
+}
+
+void ShaderVariants::set(variantKey& key, const std::string& name, uint32_t value) const {
+    key.at(indexOf(name)) = value;
+}
+
+uint32_t ShaderVariants::value(const variantKey& key, const std::string& name) const {
+    return key.at(indexOf(name));
+}
+
+// FNV-1a over the bytes of the values, low byte first
+size_t ShaderVariants::keyHash::operator()(const variantKey& key) const {
+    uint64_t hash = 14695981039346656037ull;
+    for (uint32_t value : key) {
+        for (uint32_t shift = 0; shift < 32; shift += 8) {
+            hash = (hash ^ ((value >> shift) & 0xffu)) * 1099511628211ull;
+        }
+    }
+    return static_cast<size_t>(hash);
+}
+
+VkPipeline ShaderVariants::get(const variantKey& key) {
+    if (key.size() != constants.size()) {
+        throw std::runtime_error("ShaderVariants: key doesn't match the declared constants");
+    }
+    ++lookupCount;
+    auto found = pipelines.find(key);
+    if (found != pipelines.end()) {
+        return found->second;
+    }
+    VkSpecializationInfo specialization{};
+    specialization.mapEntryCount = static_cast<uint32_t>(entries.size());
+    specialization.pMapEntries = entries.data();
+    specialization.dataSize = key.size() * sizeof(uint32_t);
+    specialization.pData = key.data();
+    VkPipeline pipeline = build(key, specialization);
+    pipelines.emplace(key, pipeline);
+    return pipeline;
+}
+
+void ShaderVariants::destroy(VkDevice device, const VkAllocationCallbacks* allocator) {
+    for (auto& [key, pipeline] : pipelines) {
+        vkd.vkDestroyPipeline(device, pipeline, allocator);
+    }
+    pipelines.clear();
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+/* Shader variants through specialization constants.
+ * A program declares its feature toggles and tunables once as 32-bit
+ * specialization constants; a variant is one value set (variantKey, values
+ * in declaration order). get() builds the pipeline of a value set the first
+ * time it is asked for and returns the cached one afterwards, the driver
+ * folds the constants and drops the dead branches at that point instead of
+ * every draw branching on uniforms.
+ */
+
+struct specConstant
+{
+    std::string name;
+    uint32_t id;              // layout(constant_id = id), local_size_*_id
+    uint32_t defaultValue;    // bool / int / uint as is, floats through specFloat()
+};
+
+using variantKey = std::vector<uint32_t>;
+
+uint32_t specFloat(float value);
+
+class ShaderVariants
+{
+public:
+    // creates the pipeline of `key`, `specialization` points into the key and is valid during the call
+    using buildFunction = std::function<VkPipeline(const variantKey& key, const VkSpecializationInfo& specialization)>;
+
+    ShaderVariants() = default;
+    ShaderVariants(std::vector<specConstant> constants, buildFunction build);
+
+    variantKey defaults() const;
+    void set(variantKey& key, const std::string& name, uint32_t value) const;
+    uint32_t value(const variantKey& key, const std::string& name) const;
+
+    VkPipeline get(const variantKey& key);   // compiled once per value set
+    void destroy(VkDevice device, const VkAllocationCallbacks* allocator);
+
+    uint32_t variantCount() const { return static_cast<uint32_t>(pipelines.size()); }
+    uint64_t lookups() const { return lookupCount; }
+private:
+    struct keyHash
+    {
+        size_t operator()(const variantKey& key) const;
+    };
+    size_t indexOf(const std::string& name) const;
+private:
+    std::vector<specConstant> constants;
+    std::vector<VkSpecializationMapEntry> entries;
+    buildFunction build;
+    std::unordered_map<variantKey, VkPipeline, keyHash> pipelines;
+    uint64_t lookupCount = 0;
+};
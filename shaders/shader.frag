@@ -1,9 +1,20 @@
 #version 450
 
+// specialization constants, see ShaderVariants
+layout(constant_id = 0) const bool VERTEX_COLOR = true;   // false : flat white
+layout(constant_id = 1) const float COLOR_SCALE = 1.0;
+layout(constant_id = 2) const bool OVERDRAW = false;      // additive heatmap, see buildScenePipeline
+
 layout(location = 0) in vec3 fragColor;
 
 layout(location = 0) out vec4 outColor;
 
 void main() {
-    outColor = vec4(fragColor, 1.0);
+    if (OVERDRAW) {
+        // red saturates after 8 layers, green after 32, blue after 128 : red -> yellow -> white
+        outColor = vec4(1.0 / 8.0, 1.0 / 32.0, 1.0 / 128.0, 1.0 / 128.0);
+        return;
+    }
+    vec3 color = VERTEX_COLOR ? fragColor : vec3(1.0);
+    outColor = vec4(color * COLOR_SCALE, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,250 @@
+#include "simd_math.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/* simd_bench : SIMD 数学内核微基准
+ * Runs every kernel of every supported path on one thread over the same SoA
+ * data and prints objects / second / core, the speedup against the scalar
+ * path and the largest difference to the scalar result as JSON.
+ */
+
+struct simdBenchOptions
+{
+    uint32_t objects = 16384;
+    double seconds = 0.25;     // per kernel and path
+};
+
+struct soaMatrices
+{
+    std::vector<float> storage;
+    mat4SoA view{};
+    explicit soaMatrices(uint32_t count) : storage(static_cast<size_t>(count) * 16) {
+        for (int e = 0; e < 16; ++e) {
+            view.m[e] = storage.data() + static_cast<size_t>(e) * count;
+        }
+    }
+};
+
+struct benchData
+{
+    uint32_t count;
+    mat4 viewProj;
+    frustum planes;
+    soaMatrices local, parent, world;
+    std::vector<float> x, y, z, radius, ex, ey, ez;
+    std::vector<uint32_t> visible;
+
+    explicit benchData(uint32_t c)
+        : count(c), viewProj{}, planes{}, local(c), parent(c), world(c),
+          x(c), y(c), z(c), radius(c), ex(c), ey(c), ez(c), visible(c) {
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<float> unit(-1.f, 1.f);
+        for (uint32_t i = 0; i < count; ++i) {
+            for (int e = 0; e < 16; ++e) {
+                local.view.m[e][i] = unit(rng);
+                parent.view.m[e][i] = unit(rng);
+            }
+            // objects spread around the camera, roughly half of them inside the frustum
+            x[i] = unit(rng) * 100.f;
+            y[i] = unit(rng) * 100.f;
+            z[i] = unit(rng) * 100.f;
+            radius[i] = (unit(rng) + 1.f) * 2.f;
+            ex[i] = radius[i] * 0.6f;
+            ey[i] = radius[i] * 0.5f;
+            ez[i] = radius[i] * 0.4f;
+        }
+        // perspective (90 degrees, z in [0, 1], near 0.1, far 150) looking down -z
+        const float n = 0.1f, f = 150.f;
+        viewProj = {};
+        viewProj.m[0] = 1.f;
+        viewProj.m[5] = -1.f;
+        viewProj.m[10] = f / (n - f);
+        viewProj.m[11] = -1.f;
+        viewProj.m[14] = n * f / (n - f);
+        planes = extractFrustum(viewProj);
+    }
+
+    sphereSoA spheres() const { return {x.data(), y.data(), z.data(), radius.data()}; }
+    aabbSoA boxes() const { return {x.data(), y.data(), z.data(), ex.data(), ey.data(), ez.data()}; }
+};
+
+// repeat `work` until `seconds` passed, return objects / second
+template <typename Work>
+static double measure(uint32_t objects, double seconds, Work&& work) {
+    using clock = std::chrono::steady_clock;
+    work(); // warm caches
+    uint64_t iterations = 0;
+    auto start = clock::now();
+    double elapsed = 0.0;
+    do {
+        for (int repeat = 0; repeat < 8; ++repeat) {
+            work();
+        }
+        iterations += 8;
+        elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    } while (elapsed < seconds);
+    return static_cast<double>(iterations) * objects / elapsed;
+}
+
+static float maxDifference(const soaMatrices& a, const soaMatrices& b) {
+    float difference = 0.f;
+    for (size_t i = 0; i < a.storage.size(); ++i) {
+        difference = std::max(difference, std::abs(a.storage[i] - b.storage[i]));
+    }
+    return difference;
+}
+
+static std::string runKernels(const simdKernels& kernels, benchData& data, const simdBenchOptions& options,
+                              const std::vector<double>& scalarRates, std::vector<double>& rates) {
+    const uint32_t count = data.count;
+    soaMatrices reference(count);
+    const simdKernels& scalar = simdKernelsScalar();
+    sphereSoA spheres = data.spheres();
+    aabbSoA boxes = data.boxes();
+    uint32_t visibleSpheres = 0, visibleBoxes = 0;
+
+    rates.clear();
+    rates.push_back(measure(count, options.seconds, [&] {
+        kernels.transformBatch(data.viewProj, data.local.view, data.world.view, 0, count);
+    }));
+    scalar.transformBatch(data.viewProj, data.local.view, reference.view, 0, count);
+    float transformError = maxDifference(data.world, reference);
+
+    rates.push_back(measure(count, options.seconds, [&] {
+        kernels.multiplyBatch(data.parent.view, data.local.view, data.world.view, 0, count);
+    }));
+    scalar.multiplyBatch(data.parent.view, data.local.view, reference.view, 0, count);
+    float multiplyError = maxDifference(data.world, reference);
+
+    rates.push_back(measure(count, options.seconds, [&] {
+        visibleSpheres = kernels.cullSpheres(data.planes, spheres, 0, count, data.visible.data());
+    }));
+    uint32_t scalarSpheres = scalar.cullSpheres(data.planes, spheres, 0, count, data.visible.data());
+
+    rates.push_back(measure(count, options.seconds, [&] {
+        visibleBoxes = kernels.cullAabbs(data.planes, boxes, 0, count, data.visible.data());
+    }));
+    uint32_t scalarBoxes = scalar.cullAabbs(data.planes, boxes, 0, count, data.visible.data());
+
+    static const char* names[] = {"transform_batch", "multiply_batch", "cull_spheres", "cull_aabbs"};
+    std::ostringstream json;
+    json << "{\"path\": \"" << kernels.name << "\", \"kernels\": {";
+    for (size_t k = 0; k < rates.size(); ++k) {
+        double speedup = scalarRates.empty() ? 1.0 : rates[k] / scalarRates[k];
+        json << (k ? ", " : "") << "\"" << names[k] << "\": {\"objects_per_second_per_core\": "
+             << static_cast<uint64_t>(rates[k]) << ", \"speedup_vs_scalar\": " << speedup << "}";
+    }
+    json << "}, \"max_error\": {\"transform_batch\": " << transformError << ", \"multiply_batch\": " << multiplyError
+         << "}, \"visible\": {\"spheres\": " << visibleSpheres << ", \"aabbs\": " << visibleBoxes
+         << ", \"scalar_spheres\": " << scalarSpheres << ", \"scalar_aabbs\": " << scalarBoxes << "}}";
+    return json.str();
+}
+
+// independent reference : the planes of the bench perspective written out in world space
+// (90 degrees, looking down -z), the sphere is visible if no plane is further away than its radius
+static uint32_t referenceSpheres(const benchData& data, std::vector<uint32_t>& visible) {
+    const float s = 1.f / std::sqrt(2.f);
+    const float planes[6][4] = {
+        { s, 0.f, -s, 0.f}, {-s, 0.f, -s, 0.f},     // left, right : |x| <= -z
+        {0.f,  s, -s, 0.f}, {0.f, -s, -s, 0.f},     // bottom, top : |y| <= -z
+        {0.f, 0.f, -1.f, -0.1f},                    // near : -z >= 0.1
+        {0.f, 0.f, 1.f, 150.f},                     // far : -z <= 150
+    };
+    visible.clear();
+    for (uint32_t i = 0; i < data.count; ++i) {
+        bool inside = true;
+        for (const float* p : planes) {
+            inside &= p[0] * data.x[i] + p[1] * data.y[i] + p[2] * data.z[i] + p[3] >= -data.radius[i];
+        }
+        if (inside) visible.push_back(i);
+    }
+    return static_cast<uint32_t>(visible.size());
+}
+
+// every path has to cull exactly the reference set, a sphere a little outside a plane included
+static void checkReference(const simdKernels& kernels, benchData& data) {
+    std::vector<uint32_t> expected;
+    referenceSpheres(data, expected);
+    sphereSoA spheres = data.spheres();
+    uint32_t count = kernels.cullSpheres(data.planes, spheres, 0, data.count, data.visible.data());
+    if (count != expected.size() || !std::equal(expected.begin(), expected.end(), data.visible.begin())) {
+        throw std::runtime_error(std::string("cull_spheres of the ") + kernels.name + " path: " +
+                                 std::to_string(count) + " visible, reference " + std::to_string(expected.size()));
+    }
+
+    // world-space distance 0.85 outside the left plane with radius 1 : visible, 1.15 : culled
+    const float s = 1.f / std::sqrt(2.f);
+    float x[2] = {-10.f - 0.85f * s, -10.f - 1.15f * s};
+    float y[2] = {0.f, 0.f};
+    float z[2] = {-10.f + 0.85f * s, -10.f + 1.15f * s};
+    float radius[2] = {1.f, 1.f};
+    uint32_t visible[2] = {};
+    uint32_t edge = kernels.cullSpheres(data.planes, {x, y, z, radius}, 0, 2, visible);
+    if (edge != 1 || visible[0] != 0) {
+        throw std::runtime_error(std::string("cull_spheres of the ") + kernels.name +
+                                 " path is wrong at the left plane");
+    }
+}
+
+static void printUsage() {
+    std::cout << "usage: simd_bench [--objects N] [--seconds S]" << std::endl;
+}
+
+static simdBenchOptions parseOptions(int argc, char** argv) {
+    simdBenchOptions options{};
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::runtime_error("Missing value for " + arg);
+            }
+            return argv[++i];
+        };
+        if (arg == "--objects") options.objects = std::max(static_cast<uint32_t>(std::stoul(value())), 1u);
+        else if (arg == "--seconds") options.seconds = std::stod(value());
+        else if (arg == "--help" || arg == "-h") {
+            printUsage();
+            std::exit(0);
+        }
+        else throw std::runtime_error("Unknown argument: " + arg);
+    }
+    return options;
+}
+
+int main(int argc, char** argv) {
+    try {
+        simdBenchOptions options = parseOptions(argc, argv);
+        benchData data(options.objects);
+        std::vector<double> scalarRates, rates;
+        std::vector<std::string> results;
+        for (simdLevel level : {simdLevel::Scalar, simdLevel::SSE4, simdLevel::AVX2}) {
+            const simdKernels* kernels = simdKernelsFor(level);
+            if (kernels == nullptr) {
+                continue;
+            }
+            checkReference(*kernels, data);
+            results.push_back(runKernels(*kernels, data, options, scalarRates, rates));
+            if (level == simdLevel::Scalar) {
+                scalarRates = rates;
+            }
+        }
+        std::cout << "{\"objects\": " << options.objects << ", \"dispatch\": \"" << simdDispatch().name
+                  << "\", \"results\": [\n";
+        for (size_t i = 0; i < results.size(); ++i) {
+            std::cout << "  " << results[i] << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        std::cout << "]}" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "simd_bench: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
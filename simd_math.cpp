@@ -0,0 +1,173 @@
+#include "simd_math.hpp"
+#include <cmath>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    #include <intrin.h>
+    #include <immintrin.h>
+#endif
+
+// --- Scalar --- //
+namespace {
+
+void transformBatchScalar(const mat4& a, const mat4SoA& b, const mat4SoA& out, uint32_t first, uint32_t last) {
+    for (uint32_t i = first; i < last; ++i) {
+        for (int col = 0; col < 4; ++col) {
+            float b0 = b.m[col * 4 + 0][i], b1 = b.m[col * 4 + 1][i];
+            float b2 = b.m[col * 4 + 2][i], b3 = b.m[col * 4 + 3][i];
+            for (int row = 0; row < 4; ++row) {
+                out.m[col * 4 + row][i] = a.m[row] * b0 + a.m[4 + row] * b1 + a.m[8 + row] * b2 + a.m[12 + row] * b3;
+            }
+        }
+    }
+}
+
+void multiplyBatchScalar(const mat4SoA& a, const mat4SoA& b, const mat4SoA& out, uint32_t first, uint32_t last) {
+    for (uint32_t i = first; i < last; ++i) {
+        for (int col = 0; col < 4; ++col) {
+            float b0 = b.m[col * 4 + 0][i], b1 = b.m[col * 4 + 1][i];
+            float b2 = b.m[col * 4 + 2][i], b3 = b.m[col * 4 + 3][i];
+            for (int row = 0; row < 4; ++row) {
+                out.m[col * 4 + row][i] = a.m[row][i] * b0 + a.m[4 + row][i] * b1 +
+                                          a.m[8 + row][i] * b2 + a.m[12 + row][i] * b3;
+            }
+        }
+    }
+}
+
+// branchless compaction : always write, advance only when visible
+uint32_t cullSpheresScalar(const frustum& f, const sphereSoA& spheres, uint32_t first, uint32_t last, uint32_t* visible) {
+    uint32_t count = 0;
+    for (uint32_t i = first; i < last; ++i) {
+        bool inside = true;
+        for (const float* p : f.planes) {
+            float distance = p[0] * spheres.x[i] + p[1] * spheres.y[i] + p[2] * spheres.z[i] + p[3];
+            inside &= distance >= -spheres.radius[i];
+        }
+        visible[count] = i;
+        count += inside ? 1 : 0;
+    }
+    return count;
+}
+
+uint32_t cullAabbsScalar(const frustum& f, const aabbSoA& boxes, uint32_t first, uint32_t last, uint32_t* visible) {
+    uint32_t count = 0;
+    for (uint32_t i = first; i < last; ++i) {
+        bool inside = true;
+        for (const float* p : f.planes) {
+            float distance = p[0] * boxes.centerX[i] + p[1] * boxes.centerY[i] + p[2] * boxes.centerZ[i] + p[3];
+            float radius = (p[0] < 0.f ? -p[0] : p[0]) * boxes.extentX[i] +
+                           (p[1] < 0.f ? -p[1] : p[1]) * boxes.extentY[i] +
+                           (p[2] < 0.f ? -p[2] : p[2]) * boxes.extentZ[i];
+            inside &= distance >= -radius;
+        }
+        visible[count] = i;
+        count += inside ? 1 : 0;
+    }
+    return count;
+}
+
+const simdKernels scalarKernels = {
+    simdLevel::Scalar, "scalar",
+    transformBatchScalar, multiplyBatchScalar, cullSpheresScalar, cullAabbsScalar,
+};
+
+// --- CPU detection --- //
+bool cpuSupportsAVX2() {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int info[4];
+    __cpuid(info, 1);
+    bool fma = (info[2] & (1 << 12)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    if (!fma || !osxsave || (_xgetbv(0) & 0x6) != 0x6) {
+        return false; // the OS doesn't save ymm registers
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return false;
+#endif
+}
+
+bool cpuSupportsSSE4() {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    return __builtin_cpu_supports("sse4.1");
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 19)) != 0;
+#else
+    return false;
+#endif
+}
+
+} // namespace
+
+const simdKernels& simdKernelsScalar() {
+    return scalarKernels;
+}
+
+// --- Dispatch --- //
+simdLevel simdSupportedLevel() {
+    static const simdLevel level = [] {
+        if (simdKernelsAVX2() != nullptr && cpuSupportsAVX2()) return simdLevel::AVX2;
+        if (simdKernelsSSE4() != nullptr && cpuSupportsSSE4()) return simdLevel::SSE4;
+        return simdLevel::Scalar;
+    }();
+    return level;
+}
+
+const simdKernels* simdKernelsFor(simdLevel level) {
+    if (level > simdSupportedLevel()) {
+        return nullptr;
+    }
+    switch (level) {
+    case simdLevel::AVX2: return simdKernelsAVX2();
+    case simdLevel::SSE4: return simdKernelsSSE4();
+    case simdLevel::Scalar: break;
+    }
+    return &scalarKernels;
+}
+
+const simdKernels& simdDispatch() {
+    static const simdKernels& kernels = *simdKernelsFor(simdSupportedLevel());
+    return kernels;
+}
+
+// --- Helpers --- //
+mat4 multiply(const mat4& a, const mat4& b) {
+    mat4 result{};
+    for (int col = 0; col < 4; ++col) {
+        for (int row = 0; row < 4; ++row) {
+            float sum = 0.f;
+            for (int k = 0; k < 4; ++k) {
+                sum += a.m[k * 4 + row] * b.m[col * 4 + k];
+            }
+            result.m[col * 4 + row] = sum;
+        }
+    }
+    return result;
+}
+
+// Gribb / Hartmann plane extraction from the rows of viewProj, near plane is z >= 0
+frustum extractFrustum(const mat4& viewProj) {
+    auto row = [&](int r, int c) { return viewProj.m[c * 4 + r]; };
+    frustum f{};
+    for (int c = 0; c < 4; ++c) {
+        f.planes[0][c] = row(3, c) + row(0, c);  // left
+        f.planes[1][c] = row(3, c) - row(0, c);  // right
+        f.planes[2][c] = row(3, c) + row(1, c);  // bottom
+        f.planes[3][c] = row(3, c) - row(1, c);  // top
+        f.planes[4][c] = row(2, c);              // near
+        f.planes[5][c] = row(3, c) - row(2, c);  // far
+    }
+    // Gribb / Hartmann planes are scaled by |n|, the distances have to be world units
+    for (auto& plane : f.planes) {
+        float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+        if (length > 0.f) {
+            for (float& value : plane) value /= length;
+        }
+    }
+    return f;
+}
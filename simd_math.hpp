@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+
+/* Batched math kernels over structure-of-arrays object data.
+ * Every kernel works on the object range [first, last) so callers can split
+ * the work across threads; one SIMD lane = one object. simdDispatch() picks
+ * the widest path the CPU supports (AVX2 + FMA, SSE4.1, scalar) once, at
+ * first use. Matrices are column-major like GLSL: element (row, col) lives in
+ * m[col * 4 + row].
+ */
+
+enum class simdLevel : uint8_t { Scalar, SSE4, AVX2 };
+
+struct mat4
+{
+    float m[16];
+};
+
+// element e of object i is m[e][i]
+struct mat4SoA
+{
+    float* m[16];
+};
+
+struct sphereSoA
+{
+    const float* x;
+    const float* y;
+    const float* z;
+    const float* radius;
+};
+
+struct aabbSoA
+{
+    const float* centerX;
+    const float* centerY;
+    const float* centerZ;
+    const float* extentX;   // half size
+    const float* extentY;
+    const float* extentZ;
+};
+
+// planes (a, b, c, d) with a*x + b*y + c*z + d >= 0 inside, |(a, b, c)| == 1 : the sphere test
+// compares the signed distance against the radius
+struct frustum
+{
+    float planes[6][4];
+};
+
+struct simdKernels
+{
+    simdLevel level;
+    const char* name;
+    // out[i] = a * b[i], out may alias b
+    void (*transformBatch)(const mat4& a, const mat4SoA& b, const mat4SoA& out, uint32_t first, uint32_t last);
+    // out[i] = a[i] * b[i], out may alias b but not a
+    void (*multiplyBatch)(const mat4SoA& a, const mat4SoA& b, const mat4SoA& out, uint32_t first, uint32_t last);
+    // write the indices of visible objects in increasing order, return how many were written.
+    // `visible` needs room for last - first indices.
+    uint32_t (*cullSpheres)(const frustum& f, const sphereSoA& spheres, uint32_t first, uint32_t last, uint32_t* visible);
+    uint32_t (*cullAabbs)(const frustum& f, const aabbSoA& boxes, uint32_t first, uint32_t last, uint32_t* visible);
+};
+
+const simdKernels& simdDispatch();                  // best supported path
+const simdKernels* simdKernelsFor(simdLevel level); // nullptr if unsupported on this CPU / build
+simdLevel simdSupportedLevel();
+
+// Vulkan clip space (z in [0, 1]), viewProj column-major
+frustum extractFrustum(const mat4& viewProj);
+mat4 multiply(const mat4& a, const mat4& b);
+
+// --- Per ISA tables, defined in simd_math_<isa>.cpp --- //
+const simdKernels& simdKernelsScalar();
+const simdKernels* simdKernelsSSE4();   // nullptr when not compiled for x86
+const simdKernels* simdKernelsAVX2();
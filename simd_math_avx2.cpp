@@ -0,0 +1,176 @@
+#include "simd_math.hpp"
+
+// Compiled with AVX2 + FMA enabled (see CMakeLists.txt), only called after the CPU check.
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <array>
+#include <immintrin.h>
+
+namespace {
+
+// mask of visible lanes -> permutation moving them to the front, plus their count
+struct compactEntry
+{
+    alignas(32) uint32_t lanes[8];
+    uint32_t count;
+};
+
+constexpr std::array<compactEntry, 256> makeCompactTable() {
+    std::array<compactEntry, 256> table{};
+    for (uint32_t mask = 0; mask < 256; ++mask) {
+        uint32_t count = 0;
+        for (uint32_t lane = 0; lane < 8; ++lane) {
+            if (mask & (1u << lane)) {
+                table[mask].lanes[count++] = lane;
+            }
+        }
+        table[mask].count = count;
+    }
+    return table;
+}
+
+constexpr std::array<compactEntry, 256> compactTable = makeCompactTable();
+
+inline uint32_t compact(__m256 inside, __m256i indices, uint32_t* visible) {
+    int mask = _mm256_movemask_ps(inside);
+    const compactEntry& entry = compactTable[mask];
+    __m256i permutation = _mm256_load_si256(reinterpret_cast<const __m256i*>(entry.lanes));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(visible), _mm256_permutevar8x32_epi32(indices, permutation));
+    return entry.count;
+}
+
+void transformBatchAVX2(const mat4& a, const mat4SoA& b, const mat4SoA& out, uint32_t first, uint32_t last) {
+    __m256 columns[16];
+    for (int e = 0; e < 16; ++e) {
+        columns[e] = _mm256_set1_ps(a.m[e]);
+    }
+    uint32_t i = first;
+    for (; i + 8 <= last; i += 8) {
+        for (int col = 0; col < 4; ++col) {
+            __m256 b0 = _mm256_loadu_ps(b.m[col * 4 + 0] + i);
+            __m256 b1 = _mm256_loadu_ps(b.m[col * 4 + 1] + i);
+            __m256 b2 = _mm256_loadu_ps(b.m[col * 4 + 2] + i);
+            __m256 b3 = _mm256_loadu_ps(b.m[col * 4 + 3] + i);
+            for (int row = 0; row < 4; ++row) {
+                __m256 sum = _mm256_mul_ps(columns[row], b0);
+                sum = _mm256_fmadd_ps(columns[4 + row], b1, sum);
+                sum = _mm256_fmadd_ps(columns[8 + row], b2, sum);
+                sum = _mm256_fmadd_ps(columns[12 + row], b3, sum);
+                _mm256_storeu_ps(out.m[col * 4 + row] + i, sum);
+            }
+        }
+    }
+    simdKernelsScalar().transformBatch(a, b, out, i, last);
+}
+
+void multiplyBatchAVX2(const mat4SoA& a, const mat4SoA& b, const mat4SoA& out, uint32_t first, uint32_t last) {
+    uint32_t i = first;
+    for (; i + 8 <= last; i += 8) {
+        __m256 left[16];
+        for (int e = 0; e < 16; ++e) {
+            left[e] = _mm256_loadu_ps(a.m[e] + i);
+        }
+        for (int col = 0; col < 4; ++col) {
+            __m256 b0 = _mm256_loadu_ps(b.m[col * 4 + 0] + i);
+            __m256 b1 = _mm256_loadu_ps(b.m[col * 4 + 1] + i);
+            __m256 b2 = _mm256_loadu_ps(b.m[col * 4 + 2] + i);
+            __m256 b3 = _mm256_loadu_ps(b.m[col * 4 + 3] + i);
+            for (int row = 0; row < 4; ++row) {
+                __m256 sum = _mm256_mul_ps(left[row], b0);
+                sum = _mm256_fmadd_ps(left[4 + row], b1, sum);
+                sum = _mm256_fmadd_ps(left[8 + row], b2, sum);
+                sum = _mm256_fmadd_ps(left[12 + row], b3, sum);
+                _mm256_storeu_ps(out.m[col * 4 + row] + i, sum);
+            }
+        }
+    }
+    simdKernelsScalar().multiplyBatch(a, b, out, i, last);
+}
+
+uint32_t cullSpheresAVX2(const frustum& f, const sphereSoA& spheres, uint32_t first, uint32_t last, uint32_t* visible) {
+    __m256 planes[6][4];
+    for (int p = 0; p < 6; ++p) {
+        for (int c = 0; c < 4; ++c) {
+            planes[p][c] = _mm256_set1_ps(f.planes[p][c]);
+        }
+    }
+    const __m256 zero = _mm256_setzero_ps();
+    __m256i indices = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(first)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    const __m256i step = _mm256_set1_epi32(8);
+    uint32_t count = 0;
+    uint32_t i = first;
+    for (; i + 8 <= last; i += 8) {
+        __m256 x = _mm256_loadu_ps(spheres.x + i);
+        __m256 y = _mm256_loadu_ps(spheres.y + i);
+        __m256 z = _mm256_loadu_ps(spheres.z + i);
+        __m256 negRadius = _mm256_sub_ps(zero, _mm256_loadu_ps(spheres.radius + i));
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int p = 0; p < 6; ++p) {
+            __m256 distance = _mm256_fmadd_ps(planes[p][0], x,
+                              _mm256_fmadd_ps(planes[p][1], y,
+                              _mm256_fmadd_ps(planes[p][2], z, planes[p][3])));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negRadius, _CMP_GE_OQ));
+        }
+        count += compact(inside, indices, visible + count);
+        indices = _mm256_add_epi32(indices, step);
+    }
+    return count + simdKernelsScalar().cullSpheres(f, spheres, i, last, visible + count);
+}
+
+uint32_t cullAabbsAVX2(const frustum& f, const aabbSoA& boxes, uint32_t first, uint32_t last, uint32_t* visible) {
+    __m256 planes[6][4];
+    __m256 absPlanes[6][3];
+    const __m256 signMask = _mm256_set1_ps(-0.f);
+    for (int p = 0; p < 6; ++p) {
+        for (int c = 0; c < 4; ++c) {
+            planes[p][c] = _mm256_set1_ps(f.planes[p][c]);
+        }
+        for (int c = 0; c < 3; ++c) {
+            absPlanes[p][c] = _mm256_andnot_ps(signMask, planes[p][c]);
+        }
+    }
+    const __m256 zero = _mm256_setzero_ps();
+    __m256i indices = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(first)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    const __m256i step = _mm256_set1_epi32(8);
+    uint32_t count = 0;
+    uint32_t i = first;
+    for (; i + 8 <= last; i += 8) {
+        __m256 cx = _mm256_loadu_ps(boxes.centerX + i);
+        __m256 cy = _mm256_loadu_ps(boxes.centerY + i);
+        __m256 cz = _mm256_loadu_ps(boxes.centerZ + i);
+        __m256 ex = _mm256_loadu_ps(boxes.extentX + i);
+        __m256 ey = _mm256_loadu_ps(boxes.extentY + i);
+        __m256 ez = _mm256_loadu_ps(boxes.extentZ + i);
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int p = 0; p < 6; ++p) {
+            __m256 distance = _mm256_fmadd_ps(planes[p][0], cx,
+                              _mm256_fmadd_ps(planes[p][1], cy,
+                              _mm256_fmadd_ps(planes[p][2], cz, planes[p][3])));
+            __m256 radius = _mm256_fmadd_ps(absPlanes[p][0], ex,
+                            _mm256_fmadd_ps(absPlanes[p][1], ey,
+                            _mm256_mul_ps(absPlanes[p][2], ez)));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, _mm256_sub_ps(zero, radius), _CMP_GE_OQ));
+        }
+        count += compact(inside, indices, visible + count);
+        indices = _mm256_add_epi32(indices, step);
+    }
+    return count + simdKernelsScalar().cullAabbs(f, boxes, i, last, visible + count);
+}
+
+const simdKernels avx2Kernels = {
+    simdLevel::AVX2, "avx2",
+    transformBatchAVX2, multiplyBatchAVX2, cullSpheresAVX2, cullAabbsAVX2,
+};
+
+} // namespace
+
+const simdKernels* simdKernelsAVX2() {
+    return &avx2Kernels;
+}
+
+#else
+
+const simdKernels* simdKernelsAVX2() {
+    return nullptr;
+}
+
+#endif
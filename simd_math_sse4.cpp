@@ -0,0 +1,175 @@
+#include "simd_math.hpp"
+
+// Compiled with SSE4.1 enabled (see CMakeLists.txt), only called after the CPU check.
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <array>
+#include <smmintrin.h>
+
+namespace {
+
+// mask of visible lanes -> byte shuffle moving them to the front, plus their count
+struct compactEntry
+{
+    alignas(16) uint8_t bytes[16];
+    uint32_t count;
+};
+
+constexpr std::array<compactEntry, 16> makeCompactTable() {
+    std::array<compactEntry, 16> table{};
+    for (uint32_t mask = 0; mask < 16; ++mask) {
+        uint32_t count = 0;
+        for (uint32_t lane = 0; lane < 4; ++lane) {
+            if (mask & (1u << lane)) {
+                for (uint32_t byte = 0; byte < 4; ++byte) {
+                    table[mask].bytes[count * 4 + byte] = static_cast<uint8_t>(lane * 4 + byte);
+                }
+                ++count;
+            }
+        }
+        for (uint32_t byte = count * 4; byte < 16; ++byte) {
+            table[mask].bytes[byte] = 0x80; // zero the unused lanes
+        }
+        table[mask].count = count;
+    }
+    return table;
+}
+
+constexpr std::array<compactEntry, 16> compactTable = makeCompactTable();
+
+inline uint32_t compact(__m128 inside, __m128i indices, uint32_t* visible) {
+    int mask = _mm_movemask_ps(inside);
+    const compactEntry& entry = compactTable[mask];
+    __m128i shuffle = _mm_load_si128(reinterpret_cast<const __m128i*>(entry.bytes));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(visible), _mm_shuffle_epi8(indices, shuffle));
+    return entry.count;
+}
+
+void transformBatchSSE4(const mat4& a, const mat4SoA& b, const mat4SoA& out, uint32_t first, uint32_t last) {
+    __m128 columns[16];
+    for (int e = 0; e < 16; ++e) {
+        columns[e] = _mm_set1_ps(a.m[e]);
+    }
+    uint32_t i = first;
+    for (; i + 4 <= last; i += 4) {
+        for (int col = 0; col < 4; ++col) {
+            __m128 b0 = _mm_loadu_ps(b.m[col * 4 + 0] + i);
+            __m128 b1 = _mm_loadu_ps(b.m[col * 4 + 1] + i);
+            __m128 b2 = _mm_loadu_ps(b.m[col * 4 + 2] + i);
+            __m128 b3 = _mm_loadu_ps(b.m[col * 4 + 3] + i);
+            for (int row = 0; row < 4; ++row) {
+                __m128 sum = _mm_add_ps(_mm_add_ps(_mm_mul_ps(columns[row], b0), _mm_mul_ps(columns[4 + row], b1)),
+                                        _mm_add_ps(_mm_mul_ps(columns[8 + row], b2), _mm_mul_ps(columns[12 + row], b3)));
+                _mm_storeu_ps(out.m[col * 4 + row] + i, sum);
+            }
+        }
+    }
+    simdKernelsScalar().transformBatch(a, b, out, i, last);
+}
+
+void multiplyBatchSSE4(const mat4SoA& a, const mat4SoA& b, const mat4SoA& out, uint32_t first, uint32_t last) {
+    uint32_t i = first;
+    for (; i + 4 <= last; i += 4) {
+        __m128 left[16];
+        for (int e = 0; e < 16; ++e) {
+            left[e] = _mm_loadu_ps(a.m[e] + i);
+        }
+        for (int col = 0; col < 4; ++col) {
+            __m128 b0 = _mm_loadu_ps(b.m[col * 4 + 0] + i);
+            __m128 b1 = _mm_loadu_ps(b.m[col * 4 + 1] + i);
+            __m128 b2 = _mm_loadu_ps(b.m[col * 4 + 2] + i);
+            __m128 b3 = _mm_loadu_ps(b.m[col * 4 + 3] + i);
+            for (int row = 0; row < 4; ++row) {
+                __m128 sum = _mm_add_ps(_mm_add_ps(_mm_mul_ps(left[row], b0), _mm_mul_ps(left[4 + row], b1)),
+                                        _mm_add_ps(_mm_mul_ps(left[8 + row], b2), _mm_mul_ps(left[12 + row], b3)));
+                _mm_storeu_ps(out.m[col * 4 + row] + i, sum);
+            }
+        }
+    }
+    simdKernelsScalar().multiplyBatch(a, b, out, i, last);
+}
+
+uint32_t cullSpheresSSE4(const frustum& f, const sphereSoA& spheres, uint32_t first, uint32_t last, uint32_t* visible) {
+    __m128 planes[6][4];
+    for (int p = 0; p < 6; ++p) {
+        for (int c = 0; c < 4; ++c) {
+            planes[p][c] = _mm_set1_ps(f.planes[p][c]);
+        }
+    }
+    const __m128 zero = _mm_setzero_ps();
+    __m128i indices = _mm_add_epi32(_mm_set1_epi32(static_cast<int>(first)), _mm_setr_epi32(0, 1, 2, 3));
+    const __m128i step = _mm_set1_epi32(4);
+    uint32_t count = 0;
+    uint32_t i = first;
+    for (; i + 4 <= last; i += 4) {
+        __m128 x = _mm_loadu_ps(spheres.x + i);
+        __m128 y = _mm_loadu_ps(spheres.y + i);
+        __m128 z = _mm_loadu_ps(spheres.z + i);
+        __m128 negRadius = _mm_sub_ps(zero, _mm_loadu_ps(spheres.radius + i));
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int p = 0; p < 6; ++p) {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planes[p][0], x), _mm_mul_ps(planes[p][1], y)),
+                                         _mm_add_ps(_mm_mul_ps(planes[p][2], z), planes[p][3]));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negRadius));
+        }
+        count += compact(inside, indices, visible + count);
+        indices = _mm_add_epi32(indices, step);
+    }
+    return count + simdKernelsScalar().cullSpheres(f, spheres, i, last, visible + count);
+}
+
+uint32_t cullAabbsSSE4(const frustum& f, const aabbSoA& boxes, uint32_t first, uint32_t last, uint32_t* visible) {
+    __m128 planes[6][4];
+    __m128 absPlanes[6][3];
+    const __m128 signMask = _mm_set1_ps(-0.f);
+    for (int p = 0; p < 6; ++p) {
+        for (int c = 0; c < 4; ++c) {
+            planes[p][c] = _mm_set1_ps(f.planes[p][c]);
+        }
+        for (int c = 0; c < 3; ++c) {
+            absPlanes[p][c] = _mm_andnot_ps(signMask, planes[p][c]);
+        }
+    }
+    const __m128 zero = _mm_setzero_ps();
+    __m128i indices = _mm_add_epi32(_mm_set1_epi32(static_cast<int>(first)), _mm_setr_epi32(0, 1, 2, 3));
+    const __m128i step = _mm_set1_epi32(4);
+    uint32_t count = 0;
+    uint32_t i = first;
+    for (; i + 4 <= last; i += 4) {
+        __m128 cx = _mm_loadu_ps(boxes.centerX + i);
+        __m128 cy = _mm_loadu_ps(boxes.centerY + i);
+        __m128 cz = _mm_loadu_ps(boxes.centerZ + i);
+        __m128 ex = _mm_loadu_ps(boxes.extentX + i);
+        __m128 ey = _mm_loadu_ps(boxes.extentY + i);
+        __m128 ez = _mm_loadu_ps(boxes.extentZ + i);
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int p = 0; p < 6; ++p) {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planes[p][0], cx), _mm_mul_ps(planes[p][1], cy)),
+                                         _mm_add_ps(_mm_mul_ps(planes[p][2], cz), planes[p][3]));
+            __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(absPlanes[p][0], ex), _mm_mul_ps(absPlanes[p][1], ey)),
+                                       _mm_mul_ps(absPlanes[p][2], ez));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, _mm_sub_ps(zero, radius)));
+        }
+        count += compact(inside, indices, visible + count);
+        indices = _mm_add_epi32(indices, step);
+    }
+    return count + simdKernelsScalar().cullAabbs(f, boxes, i, last, visible + count);
+}
+
+const simdKernels sse4Kernels = {
+    simdLevel::SSE4, "sse4",
+    transformBatchSSE4, multiplyBatchSSE4, cullSpheresSSE4, cullAabbsSSE4,
+};
+
+} // namespace
+
+const simdKernels* simdKernelsSSE4() {
+    return &sse4Kernels;
+}
+
+#else
+
+const simdKernels* simdKernelsSSE4() {
+    return nullptr;
+}
+
+#endif
@@ -1,15 +1,28 @@
 #include "test_vulkan.hpp"
+#include "vk_dispatch.hpp"
 #include <cstddef>
 #include <cstdint>
 #include <limits>
 #include <set>
 #include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <cstring>
 #include <fstream>
+#include <chrono>
 #include <stdexcept>
 
 std::vector<char> test::readFile(const std::string& filename) {
+    // 预读批次优先，其次资源包，包里没有时读取散文件
+    auto preloaded = preloadedAssets.find(filename);
+    if (preloaded != preloadedAssets.end()) {
+        std::vector<char> data = std::move(preloaded->second);
+        preloadedAssets.erase(preloaded);
+        return data;
+    }
+    if (const assetPackEntry* entry = assets.find(filename)) {
+        return assets.read(*entry, &jobs);
+    }
     std::ifstream file(filename, std::ios::binary | std::ios::ate);
     // ios::ate 从文件末尾开始读取，通过获取末尾指针确定文件与缓冲区大小。
     if (!file.is_open()) {
@@ -23,18 +36,41 @@ std::vector<char> test::readFile(const std::string& filename) {
     return buffer;
 }
 
+// the startup assets as one AssetPack::read batch : sorted, merged io_uring reads, blocks decoded on the jobs
+void test::preloadAssets(const std::vector<const char*>& names) {
+    std::vector<assetRead> reads;
+    for (const char* name : names) {
+        const assetPackEntry* entry = assets.find(name);
+        if (entry == nullptr) {
+            continue; // loose file, readFile falls back to it
+        }
+        std::vector<char>& data = preloadedAssets[name];   // node based, the buffer doesn't move
+        data.resize(static_cast<size_t>(entry->size));
+        reads.push_back({entry, data.data()});
+    }
+    if (!reads.empty()) {
+        assets.read(reads.data(), reads.size(), &jobs);
+    }
+}
+
 // --- Constructor --- //
 test::test() 
 :
     test({1280, 1080, "vulkan"})
 {}
 
-test::test(windowInfo window_info)
+test::test(windowInfo window_info, renderSettings render_settings)
 :
     w_info(window_info),
-    window(nullptr)
+    settings(render_settings),
+    jobs(render_settings.workerThreads < 0 ? JobSystem::defaultWorkerCount()
+                                           : static_cast<uint32_t>(render_settings.workerThreads)),
+    window(nullptr),
+    device(VK_NULL_HANDLE)
 {
+    loadVulkanLoader();     // 加载Vulkan入口，glfw 也用同一个 loader
     initWindow();
+    initStepDone("initWindow");
     initVulkan();
 }
 
@@ -42,6 +78,14 @@ test::test(windowInfo window_info)
 // --- Init --- //
 void test::initWindow()
 {
+    if (settings.headless) {
+        pacer.configure(settings.pacing, 0.0, false);
+        return; // 无窗口模式：渲染到离屏图像
+    }
+
+#if GLFW_VERSION_MAJOR > 3 || (GLFW_VERSION_MAJOR == 3 && GLFW_VERSION_MINOR >= 4)
+    glfwInitVulkanLoader(vkd.vkGetInstanceProcAddr);
+#endif
     if (glfwInit()==GLFW_FALSE)
     {
         throw std::runtime_error("Failed to init glfw!");
@@ -57,32 +101,118 @@ void test::initWindow()
     {
         throw std::runtime_error("Failed to create window!");
     }
+    setWindowCallbacks();
+
+    // 刷新率决定 just-in-time 输入的截止时间
+    GLFWmonitor* monitor = glfwGetPrimaryMonitor();
+    const GLFWvidmode* mode = monitor != nullptr ? glfwGetVideoMode(monitor) : nullptr;
+    pacer.configure(settings.pacing, mode != nullptr ? mode->refreshRate : 0.0, settings.vsync);
+}
+
+// 任何输入或窗口变化都重新绘制，静止时主循环阻塞在事件上
+void test::setWindowCallbacks()
+{
+    glfwSetWindowUserPointer(window, this);
+    glfwSetWindowRefreshCallback(window, [](GLFWwindow* w) {
+        static_cast<test*>(glfwGetWindowUserPointer(w))->requestRedraw();
+    });
+    glfwSetFramebufferSizeCallback(window, [](GLFWwindow* w, int, int) {
+        static_cast<test*>(glfwGetWindowUserPointer(w))->requestRedraw();
+    });
+    glfwSetWindowIconifyCallback(window, [](GLFWwindow* w, int) {
+        static_cast<test*>(glfwGetWindowUserPointer(w))->requestRedraw();
+    });
+    glfwSetWindowFocusCallback(window, [](GLFWwindow* w, int) {
+        static_cast<test*>(glfwGetWindowUserPointer(w))->requestRedraw();
+    });
+    glfwSetKeyCallback(window, [](GLFWwindow* w, int, int, int, int) {
+        static_cast<test*>(glfwGetWindowUserPointer(w))->requestRedraw();
+    });
+    glfwSetCursorPosCallback(window, [](GLFWwindow* w, double, double) {
+        static_cast<test*>(glfwGetWindowUserPointer(w))->requestRedraw();
+    });
+    glfwSetMouseButtonCallback(window, [](GLFWwindow* w, int, int, int) {
+        static_cast<test*>(glfwGetWindowUserPointer(w))->requestRedraw();
+    });
+    glfwSetScrollCallback(window, [](GLFWwindow* w, double, double) {
+        static_cast<test*>(glfwGetWindowUserPointer(w))->requestRedraw();
+    });
+}
+
+// null_bench 按步骤统计初始化耗时与堆分配
+void test::initStepDone(const char* step)
+{
+    if (settings.initStep) settings.initStep(step);
 }
 
 void test::initVulkan()
 {
+    if (!settings.assetPack.empty()) {
+        assets.open(settings.assetPack);
+        std::vector<const char*> startup = {"shader.vert.spv", "shader.frag.spv"};
+        if (settings.computePost) {
+            startup.push_back("tonemap.comp.spv");
+            startup.push_back("blur.comp.spv");
+        }
+        preloadAssets(startup);
+        initStepDone("openAssetPack");
+    }
     createInstance();
+    initStepDone("createInstance");
     setupDebugMessenger();
+    initStepDone("setupDebugMessenger");
     createSurface();
+    initStepDone("createSurface");
     pickupPhysicalDevice();
+    initStepDone("pickupPhysicalDevice");
     createLogicalDevice();
-    createSwapChain();
+    initStepDone("createLogicalDevice");
+    if (settings.headless) {
+        createOffscreenTargets();
+        initStepDone("createOffscreenTargets");
+    } else {
+        createSwapChain();
+        initStepDone("createSwapChain");
+    }
     createImageViews();
+    initStepDone("createImageViews");
+    createComputePost();
+    initStepDone("createComputePost");
     createRenderPass();
+    initStepDone("createRenderPass");
     createGraphicsPipeline();
+    initStepDone("createGraphicsPipeline");
     createFramebuffers();
+    initStepDone("createFramebuffers");
+    createFrameCapture();
+    initStepDone("createFrameCapture");
+    createInstanceBuffers();
+    initStepDone("createInstanceBuffers");
+    createRenderGraph();
+    initStepDone("createRenderGraph");
     createCommandPool();
+    initStepDone("createCommandPool");
     createCommandBuffer();
+    initStepDone("createCommandBuffer");
+    createCommandCache();
+    initStepDone("createCommandCache");
     createSyncObjects();
+    initStepDone("createSyncObjects");
+    if (settings.gpuTiming) {
+        createTimestampQueries();
+        initStepDone("createTimestampQueries");
+    }
+    createPipelineStatistics();
+    initStepDone("createPipelineStatistics");
 }
 
 // --- Debug Utils Messenger --- //
 void test::destoryDebugUtilsMessenger(
     VkInstance c_instance, 
     VkDebugUtilsMessengerEXT c_debugMessenger, 
-    VkAllocationCallbacks* c_allocation
+    const VkAllocationCallbacks* c_allocation
 ) {
-    auto func = (PFN_vkDestroyDebugUtilsMessengerEXT) vkGetInstanceProcAddr(c_instance, "vkDestroyDebugUtilsMessengerEXT");
+    auto func = vkd.vkDestroyDebugUtilsMessengerEXT;    // null without VK_EXT_debug_utils
     if (func != nullptr)
     {
         func(c_instance, c_debugMessenger, c_allocation);
@@ -109,10 +239,13 @@ void test::createInstance()
     appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
     // request Vulkan enxtention required by GLFW
     // 请求GLFW所需的Vulkan扩展
-    uint32_t glfwExtensionCount;
-    const char **glfwExtensions;
-    glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
-    std::vector<const char*> Extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    std::vector<const char*> Extensions;
+    if (!settings.headless) {
+        uint32_t glfwExtensionCount;
+        const char **glfwExtensions;
+        glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+        Extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    }
     if (enabledValidationLayer)
     {
         Extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
@@ -137,21 +270,22 @@ void test::createInstance()
         createInfo.ppEnabledLayerNames = nullptr;
     }
     VkResult results;
-    if ((results = vkCreateInstance(&createInfo, nullptr, &instance)) != VK_SUCCESS)
+    if ((results = vkd.vkCreateInstance(&createInfo, hostAllocator.callbacks(), &instance)) != VK_SUCCESS)
     {
         switch (results)
         {
         case VK_ERROR_INCOMPATIBLE_DRIVER:
-            std::cout << "Driver unsupported!" << std::endl;
+            std::cerr << "Driver unsupported!" << std::endl;
             break;
         case VK_ERROR_EXTENSION_NOT_PRESENT:
-            std::cout << "VkExtension unsupported!" << std::endl;
+            std::cerr << "VkExtension unsupported!" << std::endl;
             break;
         default:
-            std::cout << "Unknown error!" << std::endl;
+            std::cerr << "Unknown error!" << std::endl;
         }
         throw std::runtime_error("Failed to create instance!");
     }
+    loadVulkanInstance(instance);
 }
 
 //检查验证层支持
@@ -159,9 +293,9 @@ bool test::checkValidationLayerSupport()
 {
     // Get avaliable layers
     uint32_t avaliableLayerCount;
-    vkEnumerateInstanceLayerProperties(&avaliableLayerCount, nullptr);
+    vkd.vkEnumerateInstanceLayerProperties(&avaliableLayerCount, nullptr);
     std::vector<VkLayerProperties> avaliableLayerProperties(avaliableLayerCount);
-    vkEnumerateInstanceLayerProperties(&avaliableLayerCount, avaliableLayerProperties.data());
+    vkd.vkEnumerateInstanceLayerProperties(&avaliableLayerCount, avaliableLayerProperties.data());
     /* Check requested layers with avaliable layers
      * If all requested layers are found, return true
      * else return false
@@ -188,12 +322,12 @@ bool test::checkValidationLayerSupport()
 
 void test::pickupPhysicalDevice() {
     uint32_t deviceCount;
-    vkEnumeratePhysicalDevices(instance, &deviceCount, nullptr);
+    vkd.vkEnumeratePhysicalDevices(instance, &deviceCount, nullptr);
     if (deviceCount == 0) {
         throw std::runtime_error("Failed to enumerate physical devices!");
     }
     std::vector<VkPhysicalDevice> devices(deviceCount);
-    vkEnumeratePhysicalDevices(instance, &deviceCount, devices.data());
+    vkd.vkEnumeratePhysicalDevices(instance, &deviceCount, devices.data());
     // check device suitability, choose
     for (const auto& physicalDevice : devices) {
         if (isDeviceSuitable(physicalDevice)) {
@@ -209,9 +343,9 @@ void test::pickupPhysicalDevice() {
 bool test::isDeviceSuitable(VkPhysicalDevice c_device) {
     VkPhysicalDeviceProperties deviceProperties;
     VkPhysicalDeviceFeatures deviceFeatures;
-    vkGetPhysicalDeviceProperties(c_device, &deviceProperties);
-    vkGetPhysicalDeviceFeatures(c_device, &deviceFeatures);
-    std::cout << "Found suitable device: "
+    vkd.vkGetPhysicalDeviceProperties(c_device, &deviceProperties);
+    vkd.vkGetPhysicalDeviceFeatures(c_device, &deviceFeatures);
+    std::cerr << "Found suitable device: "
               << deviceProperties.deviceType << " | "
               << deviceProperties.deviceID   << " | "
               << deviceProperties.deviceName << " | "
@@ -220,18 +354,30 @@ bool test::isDeviceSuitable(VkPhysicalDevice c_device) {
     q_Family = findQueueFamilyIndex(c_device);
     bool deviceExtensionSupported = checkDeviceExtensionSupported(c_device);
     bool SwapChainAdequate = false;
-    if (deviceExtensionSupported) {
+    if (deviceExtensionSupported && !settings.headless) {
         SwapChainDetails detail = querySwapChainSupport(c_device);
         SwapChainAdequate = !detail.formats.empty() && !detail.modes.empty();
     }
     // check queue family of the device
     // Choose device if all requirements are met
+    if (settings.headless) {
+        // headless accepts any device (e.g. lavapipe), no surface to present to
+        if (q_Family.isComplete()) {
+            std::cerr << "Choice device id " << deviceProperties.deviceID << std::endl;
+            physicalDeviceName = deviceProperties.deviceName;
+            timestampPeriod = deviceProperties.limits.timestampPeriod;
+            return true;
+        }
+        return false;
+    }
     if (deviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU &&
                                         deviceFeatures.geometryShader &&
                                         q_Family.isComplete() &&
                                         deviceExtensionSupported &&
                                         SwapChainAdequate) {
-        std::cout << "Choice device id " << deviceProperties.deviceID << std::endl;
+        std::cerr << "Choice device id " << deviceProperties.deviceID << std::endl;
+        physicalDeviceName = deviceProperties.deviceName;
+        timestampPeriod = deviceProperties.limits.timestampPeriod;
         return true;
     }
     return false;
@@ -239,7 +385,12 @@ bool test::isDeviceSuitable(VkPhysicalDevice c_device) {
 }
 
 void test::createLogicalDevice() {
+    // graphics 族必然支持计算，没有独立计算族时计算提交到图形队列
+    computeQueueFamily = q_Family.computeQueueFamily.value_or(q_Family.graphicsQueueFamily.value());
     std::set<uint32_t> indices = {q_Family.graphicsQueueFamily.value(), q_Family.presentQueueFamily.value()};
+    if (settings.computePost) {
+        indices.insert(computeQueueFamily);
+    }
     float queuePriority = 1.f;
     std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
     for (uint32_t index : indices) {
@@ -251,29 +402,83 @@ void test::createLogicalDevice() {
         queueCreateInfos.push_back(queueCreateInfo);
     }
     VkPhysicalDeviceFeatures features{};
+    if (settings.statisticsGroups > 0) {
+        VkPhysicalDeviceFeatures supported;
+        vkd.vkGetPhysicalDeviceFeatures(device, &supported);
+        pipelineStatisticsSupported = supported.pipelineStatisticsQuery == VK_TRUE;
+        features.pipelineStatisticsQuery = supported.pipelineStatisticsQuery;
+    }
+    std::vector<const char*> extensions = requiredDeviceExtensions();
+    for (const char* extension : optionalDeviceExtensions) {
+        if (isDeviceExtensionAvailable(device, extension)) {
+            extensions.push_back(extension);
+            if (strcmp(extension, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0) {
+                memoryBudgetEnabled = true;
+            }
+        }
+    }
     VkDeviceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
     createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
     createInfo.pQueueCreateInfos = queueCreateInfos.data(); // TODO : set queue create info
     createInfo.pEnabledFeatures = &features;
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-    createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+    createInfo.ppEnabledExtensionNames = extensions.data();
     
-    if (vkCreateDevice(device, &createInfo, nullptr, &logicDevice) != VK_SUCCESS) {
+    if (vkd.vkCreateDevice(device, &createInfo, hostAllocator.callbacks(), &logicDevice) != VK_SUCCESS) {
         throw std::runtime_error("Failed to create logical device");
     }
-    vkGetDeviceQueue(logicDevice, q_Family.graphicsQueueFamily.value(), 0, &graphicsQueue);
-    vkGetDeviceQueue(logicDevice, q_Family.presentQueueFamily.value(), 0, &presentQueue);
+    loadVulkanDevice(logicDevice);  // 设备级函数直接进入驱动，不经过 loader
+    vkd.vkGetDeviceQueue(logicDevice, q_Family.graphicsQueueFamily.value(), 0, &graphicsQueue);
+    vkd.vkGetDeviceQueue(logicDevice, q_Family.presentQueueFamily.value(), 0, &presentQueue);
+    computeQueue = graphicsQueue;
+    if (settings.computePost && computeQueueFamily != q_Family.graphicsQueueFamily.value()) {
+        vkd.vkGetDeviceQueue(logicDevice, computeQueueFamily, 0, &computeQueue);
+    }
+
+    // 显存预算监控，超出阈值时通知订阅者释放资源
+    memoryBudget.init(device, memoryBudgetEnabled);
+    if (!memoryBudgetEnabled) {
+        std::cerr << "VK_EXT_memory_budget unsupported, VRAM budget tracking disabled" << std::endl;
+    }
+    memoryBudget.addListener([](const memoryPressureEvent& event) {
+        if (event.current == event.previous) return;
+        static const char* levels[] = {"normal", "warning", "critical"};
+        std::cerr << "Memory heap " << event.heapIndex << " pressure: "
+                  << levels[static_cast<int>(event.current)] << " ("
+                  << event.usage / (1024 * 1024) << " / " << event.budget / (1024 * 1024) << " MiB)" << std::endl;
+    });
+}
+
+bool test::isDeviceExtensionAvailable(VkPhysicalDevice c_device, const char* extensionName) {
+    uint32_t deviceExtensionCount;
+    vkd.vkEnumerateDeviceExtensionProperties(c_device, nullptr, &deviceExtensionCount, nullptr);
+    std::vector<VkExtensionProperties> deviceExtensionsP(deviceExtensionCount);
+    vkd.vkEnumerateDeviceExtensionProperties(c_device, nullptr, &deviceExtensionCount, deviceExtensionsP.data());
+    for (const auto& Extension : deviceExtensionsP) {
+        if (strcmp(Extension.extensionName, extensionName) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<const char*> test::requiredDeviceExtensions() {
+    if (settings.headless) {
+        return {}; // no swap chain
+    }
+    return deviceExtensions;
 }
 
 bool test::checkDeviceExtensionSupported(VkPhysicalDevice c_device) 
 {
+    std::vector<const char*> required = requiredDeviceExtensions();
     uint32_t deviceExtensionCount;
-    vkEnumerateDeviceExtensionProperties(c_device, nullptr, &deviceExtensionCount, nullptr);
+    vkd.vkEnumerateDeviceExtensionProperties(c_device, nullptr, &deviceExtensionCount, nullptr);
     std::vector<VkExtensionProperties> deviceExtensionsP(deviceExtensionCount);
-    vkEnumerateDeviceExtensionProperties(c_device, nullptr, &deviceExtensionCount, deviceExtensionsP.data());
+    vkd.vkEnumerateDeviceExtensionProperties(c_device, nullptr, &deviceExtensionCount, deviceExtensionsP.data());
 
-    std::set<std::string> requiredExtensions(deviceExtensions.begin(), deviceExtensions.end());
+    std::set<std::string> requiredExtensions(required.begin(), required.end());
     for (const auto& Extension : deviceExtensionsP) {
         requiredExtensions.erase(Extension.extensionName);
     }
@@ -282,25 +487,39 @@ bool test::checkDeviceExtensionSupported(VkPhysicalDevice c_device)
 
 queueFamily test::findQueueFamilyIndex(VkPhysicalDevice c_device) {
     uint32_t queueFamiliesCount;
-    vkGetPhysicalDeviceQueueFamilyProperties(c_device, &queueFamiliesCount, nullptr);
+    vkd.vkGetPhysicalDeviceQueueFamilyProperties(c_device, &queueFamiliesCount, nullptr);
     std::vector<VkQueueFamilyProperties> queueFamilies(queueFamiliesCount);        
-    vkGetPhysicalDeviceQueueFamilyProperties(c_device, &queueFamiliesCount, queueFamilies.data());
+    vkd.vkGetPhysicalDeviceQueueFamilyProperties(c_device, &queueFamiliesCount, queueFamilies.data());
 
-    int index = 0;
+    /* 队列族选择：
+     * graphics + present 优先使用同一个族，交换链图像无需 CONCURRENT 共享；
+     * 计算优先使用不带 graphics 的独立族（异步计算），与图形队列并行执行。
+     */
     queueFamily foundQueueFamily;
-    for (const auto& QF : queueFamilies) {
-        if (QF.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+    bool sharedFamily = false;
+    for (uint32_t index = 0; index < queueFamiliesCount; ++index) {
+        const VkQueueFamilyProperties& QF = queueFamilies[index];
+        bool graphics = (QF.queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0;
+        VkBool32 presentSupported = false;
+        if (settings.headless) {
+            presentSupported = graphics; // never presents
+        } else {
+            vkd.vkGetPhysicalDeviceSurfaceSupportKHR(c_device, index, surface, &presentSupported);
+        }
+        if (graphics && presentSupported && !sharedFamily) {
+            sharedFamily = true;
             foundQueueFamily.graphicsQueueFamily = index;
+            foundQueueFamily.presentQueueFamily = index;
         }
-        VkBool32 presentSupported = false;
-        vkGetPhysicalDeviceSurfaceSupportKHR(c_device, index, surface, &presentSupported);
-        if (presentSupported) {
+        if (graphics && !foundQueueFamily.graphicsQueueFamily.has_value()) {
+            foundQueueFamily.graphicsQueueFamily = index;
+        }
+        if (presentSupported && !foundQueueFamily.presentQueueFamily.has_value()) {
             foundQueueFamily.presentQueueFamily = index;
         }
-        if (foundQueueFamily.isComplete()) {
-            break;
+        if ((QF.queueFlags & VK_QUEUE_COMPUTE_BIT) && !graphics && !foundQueueFamily.computeQueueFamily.has_value()) {
+            foundQueueFamily.computeQueueFamily = index;
         }
-        ++index;
     }
     return foundQueueFamily;
 }
@@ -316,17 +535,17 @@ SwapChainDetails test::querySwapChainSupport(VkPhysicalDevice c_device)
 
 VkSurfaceCapabilitiesKHR test::GetSurfaceCap(VkPhysicalDevice c_device) {
     VkSurfaceCapabilitiesKHR SurCap;
-    vkGetPhysicalDeviceSurfaceCapabilitiesKHR(c_device, surface, &SurCap);
+    vkd.vkGetPhysicalDeviceSurfaceCapabilitiesKHR(c_device, surface, &SurCap);
     return SurCap;
 }
 
 std::vector<VkSurfaceFormatKHR> test::GetSurfaceFmt(VkPhysicalDevice c_device) {
     std::vector<VkSurfaceFormatKHR> SurFmt{};
     uint32_t FmtCount;
-    vkGetPhysicalDeviceSurfaceFormatsKHR(c_device, surface, &FmtCount, nullptr);
+    vkd.vkGetPhysicalDeviceSurfaceFormatsKHR(c_device, surface, &FmtCount, nullptr);
     if (FmtCount != 0) {
         SurFmt.resize(FmtCount);
-        vkGetPhysicalDeviceSurfaceFormatsKHR(c_device, surface, &FmtCount, SurFmt.data());
+        vkd.vkGetPhysicalDeviceSurfaceFormatsKHR(c_device, surface, &FmtCount, SurFmt.data());
     }
     return SurFmt;
 }
@@ -334,10 +553,10 @@ std::vector<VkSurfaceFormatKHR> test::GetSurfaceFmt(VkPhysicalDevice c_device) {
 std::vector<VkPresentModeKHR> test::GetSurfacePM(VkPhysicalDevice c_device) {
     std::vector<VkPresentModeKHR> PModes{};
     uint32_t PModeCount;
-    vkGetPhysicalDeviceSurfacePresentModesKHR(c_device, surface, &PModeCount, nullptr);
+    vkd.vkGetPhysicalDeviceSurfacePresentModesKHR(c_device, surface, &PModeCount, nullptr);
     if (PModeCount != 0) {
         PModes.resize(PModeCount);
-        vkGetPhysicalDeviceSurfacePresentModesKHR(c_device, surface, &PModeCount, PModes.data());
+        vkd.vkGetPhysicalDeviceSurfacePresentModesKHR(c_device, surface, &PModeCount, PModes.data());
     }
     return PModes;
 }
@@ -355,6 +574,13 @@ VkSurfaceFormatKHR test::chooseSurfaceFmt(const SwapChainDetails& details) {
 
 VkPresentModeKHR test::choosePresentMode(const SwapChainDetails& details) {
     const std::vector<VkPresentModeKHR>& availablePresentModes = details.modes;
+    if (!settings.vsync) {
+        for (const auto& availablePresentMode : availablePresentModes) {
+            if (availablePresentMode == VK_PRESENT_MODE_IMMEDIATE_KHR) {
+                return availablePresentMode;
+            }
+        }
+    }
     for (const auto& availablePresentMode : availablePresentModes) {
         if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR) {
             return availablePresentMode;
@@ -407,6 +633,21 @@ void test::createSwapChain() {
     createInfo.imageExtent = extent;
     createInfo.imageArrayLayers = 1;
     createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    if (!settings.capturePath.empty()) {
+        // 帧捕获需要从交换链图像复制
+        if ((details.cap.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) == 0) {
+            throw std::runtime_error("Swap chain images can't be copied, frame capture unsupported!");
+        }
+        createInfo.imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    }
+    if (settings.computePost) {
+        // 后处理结果通过 blit（格式不支持时退回复制）写入交换链图像
+        if ((details.cap.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT) == 0) {
+            throw std::runtime_error("Swap chain images can't be transfer destinations, compute post unsupported!");
+        }
+        postComposite = ComputePost::chooseComposite(device, surfaceFormat.format);
+        createInfo.imageUsage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    }
 
     queueFamily q_F = findQueueFamilyIndex(device);
     uint32_t queueFamilyIndices[] = {q_F.graphicsQueueFamily.value(), q_F.presentQueueFamily.value()};
@@ -422,10 +663,11 @@ void test::createSwapChain() {
     }
     createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR; // 窗口Alpha通道处理 ：不透明
     createInfo.preTransform = details.cap.currentTransform;
+    createInfo.presentMode = presentMode;
     createInfo.clipped = VK_TRUE;
     createInfo.oldSwapchain = VK_NULL_HANDLE; // TODO
 
-    if (vkCreateSwapchainKHR(logicDevice, &createInfo, nullptr, &swapChain) != VK_SUCCESS) {
+    if (vkd.vkCreateSwapchainKHR(logicDevice, &createInfo, hostAllocator.callbacks(), &swapChain) != VK_SUCCESS) {
         throw std::runtime_error("Failed to create swap chain!");
     }
 
@@ -435,12 +677,63 @@ void test::createSwapChain() {
     swapChainExtent = extent;
 }
 
+// 无窗口模式下用普通图像代替交换链图像
+void test::createOffscreenTargets() {
+    swapChainImageFormat = VK_FORMAT_B8G8R8A8_SRGB;
+    swapChainExtent = {static_cast<uint32_t>(w_info.width), static_cast<uint32_t>(w_info.height)};
+    if (settings.computePost) {
+        postComposite = ComputePost::chooseComposite(device, swapChainImageFormat);
+    }
+    swapChainImages.resize(settings.offscreenImageCount);
+    offscreenMemory.resize(settings.offscreenImageCount);
+    for (uint32_t index = 0; index < settings.offscreenImageCount; ++index) {
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.format = swapChainImageFormat;
+        imageInfo.extent = {swapChainExtent.width, swapChainExtent.height, 1};
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+                          VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        if (vkd.vkCreateImage(logicDevice, &imageInfo, hostAllocator.callbacks(), &swapChainImages[index]) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create offscreen image!");
+        }
+
+        VkMemoryRequirements memRequirements;
+        vkd.vkGetImageMemoryRequirements(logicDevice, swapChainImages[index], &memRequirements);
+        VkMemoryAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.allocationSize = memRequirements.size;
+        allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        if (vkd.vkAllocateMemory(logicDevice, &allocInfo, hostAllocator.callbacks(), &offscreenMemory[index]) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to allocate offscreen image memory!");
+        }
+        vkd.vkBindImageMemory(logicDevice, swapChainImages[index], offscreenMemory[index], 0);
+    }
+}
+
+uint32_t test::findMemoryType(uint32_t typeBits, VkMemoryPropertyFlags properties) {
+    VkPhysicalDeviceMemoryProperties memProperties;
+    vkd.vkGetPhysicalDeviceMemoryProperties(device, &memProperties);
+    for (uint32_t i = 0; i < memProperties.memoryTypeCount; ++i) {
+        if ((typeBits & (1u << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+            return i;
+        }
+    }
+    throw std::runtime_error("Failed to find suitable memory type!");
+}
+
 void test::getSwapChainImages() {
     uint32_t imageCount;
-    vkGetSwapchainImagesKHR(logicDevice, swapChain, &imageCount, nullptr);
+    vkd.vkGetSwapchainImagesKHR(logicDevice, swapChain, &imageCount, nullptr);
     if (imageCount != 0) {
         swapChainImages.resize(imageCount);
-        vkGetSwapchainImagesKHR(logicDevice, swapChain, &imageCount, swapChainImages.data());
+        vkd.vkGetSwapchainImagesKHR(logicDevice, swapChain, &imageCount, swapChainImages.data());
     }
 }
 
@@ -461,7 +754,7 @@ void test::createImageViews() {
         createInfo.subresourceRange.levelCount = 1;
         createInfo.subresourceRange.baseArrayLayer = 0;
         createInfo.subresourceRange.layerCount = 1;
-        if (vkCreateImageView(logicDevice, &createInfo, nullptr, &imageViews[index]) != VK_SUCCESS) {
+        if (vkd.vkCreateImageView(logicDevice, &createInfo, hostAllocator.callbacks(), &imageViews[index]) != VK_SUCCESS) {
             throw std::runtime_error("Failed to create image view!");
         }
     }
@@ -469,14 +762,16 @@ void test::createImageViews() {
 
 void test::createRenderPass() {
     VkAttachmentDescription colorAttachment{};
-    colorAttachment.format = swapChainImageFormat;
+    // computePost : the scene is rendered into an HDR image, the swap chain only receives the blit
+    colorAttachment.format = settings.computePost ? ComputePost::sceneFormat : swapChainImageFormat;
     colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
     colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
     colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
     colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    // 布局转换由 RenderGraph 的 barrier 完成，渲染通道内保持 COLOR_ATTACHMENT_OPTIMAL
+    colorAttachment.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
     VkAttachmentReference colorAttachmentRef{};
     colorAttachmentRef.attachment = 0;
@@ -487,24 +782,16 @@ void test::createRenderPass() {
     subpass.colorAttachmentCount = 1;
     subpass.pColorAttachments = &colorAttachmentRef;
 
-    VkSubpassDependency dependency{};
-    dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-    dependency.dstSubpass = 0;
-    dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    dependency.srcAccessMask = 0;
-    dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-
     VkRenderPassCreateInfo renderPassInfo{};
     renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
     renderPassInfo.attachmentCount = 1;
     renderPassInfo.pAttachments = &colorAttachment;
     renderPassInfo.subpassCount = 1;
     renderPassInfo.pSubpasses = &subpass;
-    renderPassInfo.dependencyCount = 1;
-    renderPassInfo.pDependencies = &dependency;
+    renderPassInfo.dependencyCount = 0; // 外部依赖由 RenderGraph 生成
+    renderPassInfo.pDependencies = nullptr;
 
-    if (vkCreateRenderPass(logicDevice, &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS) {
+    if (vkd.vkCreateRenderPass(logicDevice, &renderPassInfo, hostAllocator.callbacks(), &renderPass) != VK_SUCCESS) {
         throw std::runtime_error("Failed to create render pass!");
     }
 }
@@ -515,28 +802,64 @@ VkShaderModule test::createShaderModule(const std::vector<char>& code) {
     createInfo.codeSize = code.size();
     createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
     VkShaderModule shaderModule;
-    if (vkCreateShaderModule(logicDevice, &createInfo, nullptr, &shaderModule) != VK_SUCCESS) {
+    if (vkd.vkCreateShaderModule(logicDevice, &createInfo, hostAllocator.callbacks(), &shaderModule) != VK_SUCCESS) {
         throw std::runtime_error("Failed to create shader module!");
     }
     return shaderModule;
 }
 
 void test::createGraphicsPipeline() {
-    auto vertShaderCode = readFile("shader.vert.spv");
-    auto fragShaderCode = readFile("shader.frag.spv");
-    VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
-    VkShaderModule fragShaderModule = createShaderModule(fragShaderCode);
+    // 模块保留到清理时：变体可能在之后首次使用时才编译
+    sceneVertModule = createShaderModule(readFile("shader.vert.spv"));
+    sceneFragModule = createShaderModule(readFile("shader.frag.spv"));
+
+    // 管线布局
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 0;
+    pipelineLayoutInfo.pSetLayouts = nullptr;
+    pipelineLayoutInfo.pushConstantRangeCount = 0;
+    pipelineLayoutInfo.pPushConstantRanges = nullptr;
 
+    if (vkd.vkCreatePipelineLayout(logicDevice, &pipelineLayoutInfo, hostAllocator.callbacks(), &pipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create pipeline layout!");
+    }
+
+    // 特化常量变体：每组取值只编译一次
+    sceneVariants = ShaderVariants({
+        {"VERTEX_COLOR", 0, VK_TRUE},        // false : flat colour, the varying is folded away
+        {"COLOR_SCALE", 1, specFloat(1.f)},
+        {"OVERDRAW", 2, VK_FALSE},           // debug heatmap, also switches to additive blending
+    }, [this](const variantKey& key, const VkSpecializationInfo& specialization) {
+        return buildScenePipeline(key, specialization);
+    });
+
+    // "many pipelines" 场景：每个管线是 COLOR_SCALE 不同的变体，绘制时轮流绑定
+    uint32_t pipelineCount = std::max(settings.pipelineCount, 1u);
+    graphicsPipelines.clear();
+    for (uint32_t i = 0; i < pipelineCount; ++i) {
+        variantKey key = sceneVariants.defaults();
+        sceneVariants.set(key, "OVERDRAW", settings.overdraw ? VK_TRUE : VK_FALSE);
+        if (pipelineCount > 1) {
+            sceneVariants.set(key, "COLOR_SCALE", specFloat(1.f - 0.5f * i / pipelineCount));
+        }
+        graphicsPipelines.push_back(sceneVariants.get(key));
+    }
+}
+
+VkPipeline test::buildScenePipeline(const variantKey& key, const VkSpecializationInfo& specialization) {
     // 着色器阶段创建
     VkPipelineShaderStageCreateInfo vertShaderStageInfo{};  
     vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
     vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-    vertShaderStageInfo.module = vertShaderModule;
+    vertShaderStageInfo.module = sceneVertModule;
+    vertShaderStageInfo.pSpecializationInfo = &specialization;
     vertShaderStageInfo.pName = "main";
     VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
     fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
     fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-    fragShaderStageInfo.module = fragShaderModule;
+    fragShaderStageInfo.module = sceneFragModule;
+    fragShaderStageInfo.pSpecializationInfo = &specialization;
     fragShaderStageInfo.pName = "main";
     VkPipelineShaderStageCreateInfo shaderStages[] = {vertShaderStageInfo, fragShaderStageInfo};
     
@@ -637,6 +960,13 @@ void test::createGraphicsPipeline() {
     colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
     colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
     colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+    if (sceneVariants.value(key, "OVERDRAW")) {
+        // 叠加计数：每个片元累加固定增量，重叠越多越亮
+        colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+        colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
+        colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+        colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    }
     VkPipelineColorBlendStateCreateInfo colorBlending{};
     colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
     colorBlending.logicOpEnable = VK_FALSE;
@@ -648,18 +978,6 @@ void test::createGraphicsPipeline() {
     colorBlending.blendConstants[2] = 0.f;
     colorBlending.blendConstants[3] = 0.f;
     
-    // 管线布局
-    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount = 0;
-    pipelineLayoutInfo.pSetLayouts = nullptr;
-    pipelineLayoutInfo.pushConstantRangeCount = 0;
-    pipelineLayoutInfo.pPushConstantRanges = nullptr;
-
-    if (vkCreatePipelineLayout(logicDevice, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
-        throw std::runtime_error("Failed to create pipeline layout!");
-    }
-
     VkGraphicsPipelineCreateInfo pipelineInfo{};
     pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
     pipelineInfo.stageCount = 2;
@@ -678,19 +996,25 @@ void test::createGraphicsPipeline() {
     pipelineInfo.basePipelineHandle = VK_NULL_HANDLE; // Optional
     pipelineInfo.basePipelineIndex = -1; // Optional
 
-    if (vkCreateGraphicsPipelines(logicDevice, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS) {
-        throw std::runtime_error("Failed to create graphics pipelines!");
+    VkPipeline pipeline;
+    if (vkd.vkCreateGraphicsPipelines(logicDevice, VK_NULL_HANDLE, 1, &pipelineInfo, hostAllocator.callbacks(), &pipeline) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create graphics pipeline!");
     }
-
-    vkDestroyShaderModule(logicDevice, vertShaderModule, nullptr);
-    vkDestroyShaderModule(logicDevice, fragShaderModule, nullptr);
+    return pipeline;
 }
 
 void test::createFramebuffers() {
-    swapChainFramebuffers.resize(imageViews.size());
-    for (size_t i = 0; i < imageViews.size(); ++i) {
+    std::vector<VkImageView> targets = imageViews;
+    if (settings.computePost) {
+        targets.clear();
+        for (uint32_t slot = 0; slot < computePost.slots(); ++slot) {
+            targets.push_back(computePost.sceneView(slot));
+        }
+    }
+    swapChainFramebuffers.resize(targets.size());
+    for (size_t i = 0; i < targets.size(); ++i) {
         VkImageView attachments[] = {
-            imageViews[i]
+            targets[i]
         };
 
         VkFramebufferCreateInfo framebufferInfo{};
@@ -702,23 +1026,244 @@ void test::createFramebuffers() {
         framebufferInfo.height = swapChainExtent.height;
         framebufferInfo.layers = 1;
 
-        if (vkCreateFramebuffer(logicDevice, &framebufferInfo, nullptr, &swapChainFramebuffers[i]) != VK_SUCCESS) {
+        if (vkd.vkCreateFramebuffer(logicDevice, &framebufferInfo, hostAllocator.callbacks(), &swapChainFramebuffers[i]) != VK_SUCCESS) {
             throw std::runtime_error("Failed to create framebuffer!");
         }
     }
 }
 
+// --- Frame Capture --- //
+void test::createFrameCapture() {
+    if (settings.capturePath.empty()) return;
+    frameCapture.init(device, logicDevice, hostAllocator.callbacks(), swapChainExtent, swapChainImageFormat,
+                      settings.captureDepth, settings.capturePath,
+                      settings.captureY4M ? captureFormat::Y4M : captureFormat::Raw);
+}
+
+// --- Compute Post --- //
+void test::createComputePost() {
+    if (!settings.computePost) return;
+    computePost.init(device, logicDevice, hostAllocator.callbacks(), swapChainExtent,
+                     q_Family.graphicsQueueFamily.value(), computeQueueFamily, MAX_FRAMES_IN_FLIGHT, postComposite,
+                     readFile("tonemap.comp.spv"), readFile("blur.comp.spv"));
+    std::cerr << "Compute post on queue family " << computeQueueFamily
+              << (computePost.ownershipTransfer() ? " (async, ownership transfer)" : " (graphics queue)")
+              << (postComposite == compositeMode::Blit ? ", blit" : ", copy") << " to the swap chain" << std::endl;
+}
+
+// --- Scene Instances --- //
+void test::createInstanceBuffers() {
+    if (settings.sceneCapacity == 0) return;
+    instanceBuffers.init(device, logicDevice, hostAllocator.callbacks(), sceneStore.frameSlots(), settings.sceneCapacity);
+}
+
+// 流水线第一阶段：更新回调 -> 层级变换 -> 视锥剔除，draw 列表同时构建，都在 worker 线程上运行
+void test::startScenePrepare(uint64_t frame) {
+    scenePrepare.clear();
+    sceneCullPrepared = false;
+    if (settings.sceneCapacity > 0) {
+        jobId update = scenePrepare.add([this, frame] {
+            if (sceneUpdate) sceneUpdate(sceneStore, frame);
+        });
+        jobId transforms = scenePrepare.add([this] { sceneStore.update(&jobs); }, {update});
+        if (sceneViewSet) {
+            frustum planes = extractFrustum(sceneView);
+            scenePrepare.add([this, planes] { cullScene(planes); }, {transforms});
+            sceneCullPrepared = true;
+        }
+    }
+    // the draw list doesn't read the scene, it builds next to the update
+    drawQueuePrepared = !settings.commandCache || drawListDirty;
+    if (drawQueuePrepared) {
+        drawListDirty = false;
+        scenePrepare.add([this] { buildDrawQueue(preparedDrawQueue); });
+    }
+    jobs.submit(scenePrepare);
+    scenePrepareStarted = true;
+}
+
+// 包围球 = world 平移 + 最大轴缩放，分块并行 SIMD 剔除，再按块顺序拼接
+void test::cullScene(const frustum& planes) {
+    constexpr uint32_t grain = 4096;
+    const uint32_t count = sceneStore.size();
+    cullVisible.clear();
+    if (count == 0) {
+        return;
+    }
+    const mat4SoA& world = sceneStore.worldTransforms();
+    const simdKernels& kernels = simdDispatch();
+    cullRadius.resize(count);
+    cullIndices.resize(count);
+    cullCounts.assign((count + grain - 1) / grain, 0);
+    jobs.parallelFor(count, grain, [&](uint32_t first, uint32_t last) {
+        for (uint32_t i = first; i < last; ++i) {
+            float scale = 0.f;
+            for (int column = 0; column < 3; ++column) {
+                float x = world.m[column * 4][i], y = world.m[column * 4 + 1][i], z = world.m[column * 4 + 2][i];
+                scale = std::max(scale, x * x + y * y + z * z);
+            }
+            cullRadius[i] = settings.sceneBoundsRadius * std::sqrt(scale);
+        }
+        sphereSoA spheres{world.m[12], world.m[13], world.m[14], cullRadius.data()};
+        cullCounts[first / grain] = kernels.cullSpheres(planes, spheres, first, last, cullIndices.data() + first);
+    });
+    // without workers the whole range is one call, its indices are all in the first chunk's place
+    for (uint32_t chunk = 0; chunk < cullCounts.size(); ++chunk) {
+        auto begin = cullIndices.begin() + static_cast<std::ptrdiff_t>(chunk) * grain;
+        cullVisible.insert(cullVisible.end(), begin, begin + cullCounts[chunk]);
+    }
+}
+
+// the prepare jobs are done : what they built becomes this frame's
+void test::finishScenePrepare() {
+    if (drawQueuePrepared) {
+        std::swap(drawQueue, preparedDrawQueue);
+        ++drawVersion;
+        drawQueuePrepared = false;
+    }
+    if (sceneCullPrepared) {
+        sceneVisible.swap(cullVisible);
+        sceneCullPrepared = false;
+    }
+}
+
+// --- Draw Queue --- //
+// 重建并排序：相同管线的 draw 排在一起；prepare job，写入的是下一帧的队列
+void test::buildDrawQueue(DrawQueue& queue) {
+    queue.clear();
+    uint32_t pipelineCount = static_cast<uint32_t>(graphicsPipelines.size());
+    drawPacket packet{};
+    packet.vertexCount = 3;
+    packet.instanceCount = settings.instanceCount;
+    for (uint32_t draw = 0; draw < settings.drawCount; ++draw) {
+        // submission order cycles the pipelines; depth keeps it within each pipeline
+        float depth = static_cast<float>(draw) / std::max(settings.drawCount, 1u);
+        queue.push(makeSortKey(0, draw % pipelineCount, noDescriptorSet, depth), packet);
+    }
+    if (settings.sortDraws) {
+        queue.sort(&jobs);
+    }
+}
+
+// sorted packets, binds only where the state changes; inline or into a cached secondary buffer
+void test::recordMainPass(VkCommandBuffer commandBuffer) {
+    mainPassRecordedThisFrame = true;
+    drawBindings bindings{};
+    bindings.pipelines = graphicsPipelines.data();
+    bindings.pipelineCount = static_cast<uint32_t>(graphicsPipelines.size());
+    bindings.layout = pipelineLayout;
+    drawQueue.beginRecording();
+
+    // draws are split evenly into the statistics groups
+    uint32_t draws = drawQueue.size();
+    uint32_t groups = pipelineStatistics.enabled() ? static_cast<uint32_t>(pipelineStatistics.results().size()) : 0;
+    if (groups == 0) {
+        drawQueue.record(commandBuffer, 0, draws, bindings);
+    }
+    for (uint32_t group = 0; group < groups; ++group) {
+        pipelineStatistics.begin(commandBuffer, group);
+        drawQueue.record(commandBuffer, group * draws / groups, (group + 1) * draws / groups, bindings);
+        pipelineStatistics.end(commandBuffer, group);
+    }
+}
+
+// --- Render Graph --- //
+void test::createRenderGraph() {
+    // swap chain image is usable once imageAvaliableSemaphore is signaled at COLOR_ATTACHMENT_OUTPUT
+    // headless images have no present layout, they are left ready for readback instead
+    // computePost : the swap chain image is only written by the composite blit / copy (TRANSFER stage)
+    backbuffer = frameGraph.importImage("backbuffer", VK_IMAGE_ASPECT_COLOR_BIT,
+                                        settings.computePost ? VK_PIPELINE_STAGE_TRANSFER_BIT
+                                                             : VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                                        settings.headless ? RGAccess::TransferSrc : RGAccess::Present);
+    RGResource target = backbuffer;
+    if (settings.computePost) {
+        // the scene is handed to the compute queue at the end of the frame
+        sceneColor = frameGraph.importImage("sceneColor", VK_IMAGE_ASPECT_COLOR_BIT,
+                                            VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, RGAccess::ComputeStorageRead);
+        if (computePost.ownershipTransfer()) {
+            frameGraph.releaseToQueue(sceneColor, q_Family.graphicsQueueFamily.value(), computeQueueFamily);
+        }
+        target = sceneColor;
+    }
+
+    // scene first : it doesn't depend on the compute queue, so it overlaps last frame's post chain
+    frameGraph.addPass("main", {{target, RGAccess::ColorAttachment}},
+        [this](VkCommandBuffer commandBuffer, const RenderGraph&) {
+            VkRenderPassBeginInfo renderPassInfo{};
+            renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+            renderPassInfo.renderPass = renderPass;
+            renderPassInfo.framebuffer = swapChainFramebuffers[settings.computePost ? postSlot : currentImageIndex];
+            renderPassInfo.renderArea.offset = {0, 0};
+            renderPassInfo.renderArea.extent = swapChainExtent;
+
+            VkClearValue clearColor = {{{0.f, 0.f, 0.f, 1.f}}};
+            renderPassInfo.clearValueCount = 1;
+            renderPassInfo.pClearValues = &clearColor;
+
+            if (!mainPassCache.enabled()) {
+                vkd.vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+                recordMainPass(commandBuffer);
+                vkd.vkCmdEndRenderPass(commandBuffer);
+                return;
+            }
+            // 缓存的二级命令缓冲：只有 key 变化时才重新录制
+            commandCacheKey key{};
+            key.pipelines = hashHandles(graphicsPipelines.data(), graphicsPipelines.size(), hashHandles(&pipelineLayout, 1));
+            key.framebuffer = renderPassInfo.framebuffer;
+            key.extent = swapChainExtent;
+            key.drawListVersion = drawVersion;
+            VkCommandBuffer pass = mainPassCache.get(settings.computePost ? postSlot : currentImageIndex, key, renderPass, 0,
+                [this](VkCommandBuffer secondary) { recordMainPass(secondary); });
+            vkd.vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+            vkd.vkCmdExecuteCommands(commandBuffer, 1, &pass);
+            vkd.vkCmdEndRenderPass(commandBuffer);
+        });
+
+    if (settings.computePost) {
+        // last frame's post result, the submit waits for it at the TRANSFER stage
+        frameGraph.addPass("composite", {{backbuffer, RGAccess::TransferDst}},
+            [this](VkCommandBuffer commandBuffer, const RenderGraph& graph) {
+                if (frameCounter == 0) {
+                    VkClearColorValue black = {{0.f, 0.f, 0.f, 1.f}};
+                    VkImageSubresourceRange range{VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+                    vkd.vkCmdClearColorImage(commandBuffer, graph.image(backbuffer), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                             &black, 1, &range);
+                    return;
+                }
+                uint32_t previousSlot = (postSlot + computePost.slots() - 1) % computePost.slots();
+                computePost.recordComposite(commandBuffer, previousSlot, graph.image(backbuffer));
+            });
+    }
+
+    if (frameCapture.enabled()) {
+        // side effect pass : never culled, copies the finished image into a readback buffer
+        frameGraph.addPass("capture", {{backbuffer, RGAccess::TransferSrc}},
+            [this](VkCommandBuffer commandBuffer, const RenderGraph& graph) {
+                frameCapture.recordCopy(commandBuffer, graph.image(backbuffer), frameCounter);
+            }, true);
+    }
+
+    frameGraph.compile(device, logicDevice, hostAllocator.callbacks());
+}
+
 void test::createCommandPool() {
     VkCommandPoolCreateInfo poolInfo{};
     poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
     poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
     poolInfo.queueFamilyIndex = q_Family.graphicsQueueFamily.value();
 
-    if (vkCreateCommandPool(logicDevice, &poolInfo, nullptr, &commandPool) != VK_SUCCESS) {
+    if (vkd.vkCreateCommandPool(logicDevice, &poolInfo, hostAllocator.callbacks(), &commandPool) != VK_SUCCESS) {
         throw std::runtime_error("failed to create command pool!");
     }
 }
 
+void test::createCommandCache() {
+    if (!settings.commandCache) return;
+    mainPassCache.init(logicDevice, hostAllocator.callbacks(), q_Family.graphicsQueueFamily.value(),
+                       static_cast<uint32_t>(swapChainFramebuffers.size()));
+}
+
 void test::createCommandBuffer() {
     VkCommandBufferAllocateInfo allocInfo{};
     allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -726,41 +1271,114 @@ void test::createCommandBuffer() {
     allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
     allocInfo.commandBufferCount = 1;
 
-    if (vkAllocateCommandBuffers(logicDevice, &allocInfo, &commandBuffer)) {
+    if (vkd.vkAllocateCommandBuffers(logicDevice, &allocInfo, &commandBuffer)) {
         throw std::runtime_error("failed to allocate command buffers!");
     }
 }
 
+// --- Dispatch cost --- //
+dispatchCost test::measureDispatch(uint32_t calls) {
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = commandPool;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = 1;
+    VkCommandBuffer scratch;
+    if (vkd.vkAllocateCommandBuffers(logicDevice, &allocInfo, &scratch) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate command buffers!");
+    }
+
+    // same commands as the pipelines scenario : a bind and a draw per pair
+    auto record = [&](PFN_vkCmdBindPipeline bindPipeline, PFN_vkCmdDraw draw) {
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        if (vkd.vkBeginCommandBuffer(scratch, &beginInfo) != VK_SUCCESS) {
+            throw std::runtime_error("failed to begin recording command buffer!");
+        }
+        VkRenderPassBeginInfo renderPassInfo{};
+        renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        renderPassInfo.renderPass = renderPass;
+        renderPassInfo.framebuffer = swapChainFramebuffers[0];
+        renderPassInfo.renderArea.extent = swapChainExtent;
+        VkClearValue clearColor = {{{0.f, 0.f, 0.f, 1.f}}};
+        renderPassInfo.clearValueCount = 1;
+        renderPassInfo.pClearValues = &clearColor;
+        vkd.vkCmdBeginRenderPass(scratch, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < calls / 2; ++i) {
+            bindPipeline(scratch, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipelines[i % graphicsPipelines.size()]);
+            draw(scratch, 3, 1, 0, 0);
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+        vkd.vkCmdEndRenderPass(scratch);
+        vkd.vkEndCommandBuffer(scratch);
+        vkd.vkResetCommandBuffer(scratch, 0);
+        return ns / std::max(2u, calls / 2 * 2);
+    };
+
+    // alternating rounds, best of each : the first recording also pays for the buffer growth
+    dispatchCost cost{};
+    cost.directNs = std::numeric_limits<double>::max();
+    for (int round = 0; round < 3; ++round) {
+#ifndef VK_NO_PROTOTYPES
+        double trampoline = record(vkCmdBindPipeline, vkCmdDraw);
+        cost.trampolineNs = cost.trampolineNs < 0.0 ? trampoline : std::min(cost.trampolineNs, trampoline);
+#endif
+        cost.directNs = std::min(cost.directNs, record(vkd.vkCmdBindPipeline, vkd.vkCmdDraw));
+    }
+    vkd.vkFreeCommandBuffers(logicDevice, commandPool, 1, &scratch);
+    return cost;
+}
+
 void test::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex) {
+    mainPassRecordedThisFrame = false;
     VkCommandBufferBeginInfo beginInfo{};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     beginInfo.flags = 0; // Optional
     beginInfo.pInheritanceInfo = nullptr;
 
-    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+    if (vkd.vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
         throw std::runtime_error("failed to begin recording command buffer!");
     }
 
-    VkRenderPassBeginInfo renderPassInfo{};
-    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    renderPassInfo.renderPass = renderPass;
-    renderPassInfo.framebuffer = swapChainFramebuffers[imageIndex];
-    renderPassInfo.renderArea.offset = {0, 0};
-    renderPassInfo.renderArea.extent = swapChainExtent;
-
-    VkClearValue clearColor = {{{0.f, 0.f, 0.f, 1.f}}};
-    renderPassInfo.clearValueCount = 1;
-    renderPassInfo.pClearValues = &clearColor;
-
-    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+    if (timestampPool != VK_NULL_HANDLE) {
+        vkd.vkCmdResetQueryPool(commandBuffer, timestampPool, 0, 2);
+        vkd.vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestampPool, 0);
+    }
+    if (pipelineStatistics.enabled()) {
+        pipelineStatistics.reset(commandBuffer);
+    }
 
-    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,graphicsPipeline);
+    // frame N was prepared while frame N - 1 was recorded, nothing ran ahead of the first frame
+    if (!scenePrepareStarted) {
+        startScenePrepare(frameCounter);
+    }
+    jobs.wait(scenePrepare);
+    finishScenePrepare();
+    if (settings.sceneCapacity > 0) {
+        // changed instances only, copied before any pass reads them
+        instanceBuffers.record(commandBuffer, static_cast<uint32_t>(frameCounter % sceneStore.frameSlots()), sceneStore);
+    }
+    // the scene and the spare draw queue are free again : prepare frame N + 1 during the rest of recording,
+    // submit and present
+    startScenePrepare(frameCounter + 1);
+
+    // barriers + passes are recorded by the render graph
+    currentImageIndex = imageIndex;
+    frameGraph.bindImport(backbuffer, swapChainImages[imageIndex], imageViews[imageIndex]);
+    if (settings.computePost) {
+        frameGraph.bindImport(sceneColor, computePost.sceneImage(postSlot), computePost.sceneView(postSlot));
+    }
+    frameGraph.execute(commandBuffer);
 
-    vkCmdDraw(commandBuffer, 3, 1, 0, 0);
-    
-    vkCmdEndRenderPass(commandBuffer);
+    if (timestampPool != VK_NULL_HANDLE) {
+        vkd.vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, timestampPool, 1);
+    }
 
-    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+    if (vkd.vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
         throw std::runtime_error("failed to record command buffer");
     }
 }
@@ -771,50 +1389,150 @@ void test::createSyncObjects() {
     VkFenceCreateInfo fenceInfo{};
     fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
     fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-    if (vkCreateSemaphore(logicDevice, &semaphoreInfo, nullptr, &imageAvaliableSemaphore) != VK_SUCCESS ||
-        vkCreateSemaphore(logicDevice, &semaphoreInfo, nullptr, &renderFinishedSemaphore) != VK_SUCCESS ||
-        vkCreateFence(logicDevice, &fenceInfo, nullptr, &inFlightFence) != VK_SUCCESS) {
+    if (vkd.vkCreateSemaphore(logicDevice, &semaphoreInfo, hostAllocator.callbacks(), &imageAvaliableSemaphore) != VK_SUCCESS ||
+            vkd.vkCreateSemaphore(logicDevice, &semaphoreInfo, hostAllocator.callbacks(), &renderFinishedSemaphore) != VK_SUCCESS ||
+            vkd.vkCreateFence(logicDevice, &fenceInfo, hostAllocator.callbacks(), &inFlightFence) != VK_SUCCESS) {
         throw std::runtime_error("failed to create semaphores!");
     }
 }
 
+void test::createTimestampQueries() {
+    uint32_t queueFamiliesCount;
+    vkd.vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamiliesCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamiliesCount);
+    vkd.vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamiliesCount, queueFamilies.data());
+    if (queueFamilies[q_Family.graphicsQueueFamily.value()].timestampValidBits == 0) {
+        std::cerr << "Timestamps unsupported on graphics queue, GPU timing disabled" << std::endl;
+        return;
+    }
+
+    VkQueryPoolCreateInfo queryPoolInfo{};
+    queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    queryPoolInfo.queryCount = 2; // frame begin / end
+    if (vkd.vkCreateQueryPool(logicDevice, &queryPoolInfo, hostAllocator.callbacks(), &timestampPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create timestamp query pool!");
+    }
+}
+
+void test::createPipelineStatistics() {
+    if (settings.statisticsGroups == 0) return;
+    if (!pipelineStatisticsSupported) {
+        std::cerr << "pipelineStatisticsQuery unsupported, pipeline statistics disabled" << std::endl;
+        return;
+    }
+    // 每组一个查询，组名记录覆盖的 draw 范围
+    uint32_t groupCount = std::min(settings.statisticsGroups, std::max(settings.drawCount, 1u));
+    std::vector<std::string> names;
+    for (uint32_t group = 0; group < groupCount; ++group) {
+        names.push_back("draws " + std::to_string(group * settings.drawCount / groupCount) + "-" +
+                        std::to_string((group + 1) * settings.drawCount / groupCount));
+    }
+    pipelineStatistics.init(logicDevice, hostAllocator.callbacks(), names);
+}
+
+// 上一帧已经通过 fence，时间戳结果无需等待
+void test::collectGpuTiming() {
+    if (timestampPool == VK_NULL_HANDLE || frameCounter == 0) {
+        return;
+    }
+    uint64_t timestamps[2] = {};
+    if (vkd.vkGetQueryPoolResults(logicDevice, timestampPool, 0, 2, sizeof(timestamps), timestamps,
+                                  sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS) {
+        gpuFrameTime = static_cast<double>(timestamps[1] - timestamps[0]) * timestampPeriod / 1e6;
+    }
+}
+
 void test::drawFrame() {
-    vkWaitForFences(logicDevice, 1, &inFlightFence, VK_TRUE, UINT64_MAX);
-    vkResetFences(logicDevice, 1, &inFlightFence);
+    vkd.vkWaitForFences(logicDevice, 1, &inFlightFence, VK_TRUE, UINT64_MAX);
+    hostAllocator.beginFrame(); // 命令作用域的驱动内存按帧回收
+    memoryBudget.poll();
+    collectGpuTiming();
+    if (pipelineStatistics.enabled()) {
+        pipelineStatistics.collect();
+    }
+    if (frameCapture.enabled() && frameCounter > 0) {
+        frameCapture.frameCompleted(frameCounter - 1); // hand the readback to the writer thread
+    }
+    vkd.vkResetFences(logicDevice, 1, &inFlightFence);
     uint32_t imageIndex;
-    vkAcquireNextImageKHR(logicDevice, swapChain, UINT64_MAX, imageAvaliableSemaphore, VK_NULL_HANDLE, &imageIndex);
-    vkResetCommandBuffer(commandBuffer, 0);
+    if (settings.headless) {
+        imageIndex = static_cast<uint32_t>(frameCounter % swapChainImages.size());
+    } else {
+        vkd.vkAcquireNextImageKHR(logicDevice, swapChain, UINT64_MAX, imageAvaliableSemaphore, VK_NULL_HANDLE, &imageIndex);
+    }
+    postSlot = settings.computePost ? static_cast<uint32_t>(frameCounter % computePost.slots()) : 0;
+    vkd.vkResetCommandBuffer(commandBuffer, 0);
     recordCommandBuffer(commandBuffer, imageIndex);
 
     VkSubmitInfo submitInfo{};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
-    VkSemaphore waitSemaphores[] ={imageAvaliableSemaphore};
-    VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-    submitInfo.waitSemaphoreCount = 1;
-    submitInfo.pWaitSemaphores = waitSemaphores;
-    submitInfo.pWaitDstStageMask = waitStages;
+    std::vector<VkSemaphore> waitSemaphores;
+    std::vector<VkPipelineStageFlags> waitStages;
+    std::vector<VkSemaphore> signalSemaphores;
+    if (!settings.headless) {
+        waitSemaphores.push_back(imageAvaliableSemaphore);
+        waitStages.push_back(settings.computePost ? VK_PIPELINE_STAGE_TRANSFER_BIT
+                                                  : VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+        signalSemaphores.push_back(renderFinishedSemaphore);
+    }
+    if (settings.computePost) {
+        if (frameCounter > 0) {
+            // only the composite blit waits for the compute queue, the scene pass runs ahead
+            uint32_t previousSlot = (postSlot + computePost.slots() - 1) % computePost.slots();
+            waitSemaphores.push_back(computePost.postReady(previousSlot));
+            waitStages.push_back(VK_PIPELINE_STAGE_TRANSFER_BIT);
+        }
+        signalSemaphores.push_back(computePost.sceneReady(postSlot));
+    }
+    submitInfo.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size());
+    submitInfo.pWaitSemaphores = waitSemaphores.data();
+    submitInfo.pWaitDstStageMask = waitStages.data();
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &commandBuffer;
-
-    VkSemaphore signalSemaphores[] = {renderFinishedSemaphore};
-    submitInfo.signalSemaphoreCount = 1;
-    submitInfo.pSignalSemaphores = signalSemaphores;
-    if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, inFlightFence) != VK_SUCCESS) {
+    submitInfo.signalSemaphoreCount = static_cast<uint32_t>(signalSemaphores.size());
+    submitInfo.pSignalSemaphores = signalSemaphores.data();
+    if (vkd.vkQueueSubmit(graphicsQueue, 1, &submitInfo, inFlightFence) != VK_SUCCESS) {
         throw std::runtime_error("failed to submit draw command buffer!");
     }
 
+    if (settings.computePost) {
+        // the post chain of this frame runs while the next frame renders its scene
+        VkSemaphore sceneReady = computePost.sceneReady(postSlot);
+        VkSemaphore postReady = computePost.postReady(postSlot);
+        VkCommandBuffer postCommands = computePost.commandBuffer(postSlot);
+        VkPipelineStageFlags computeStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+        VkSubmitInfo computeSubmit{};
+        computeSubmit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        computeSubmit.waitSemaphoreCount = 1;
+        computeSubmit.pWaitSemaphores = &sceneReady;
+        computeSubmit.pWaitDstStageMask = &computeStage;
+        computeSubmit.commandBufferCount = 1;
+        computeSubmit.pCommandBuffers = &postCommands;
+        computeSubmit.signalSemaphoreCount = 1;
+        computeSubmit.pSignalSemaphores = &postReady;
+        if (vkd.vkQueueSubmit(computeQueue, 1, &computeSubmit, VK_NULL_HANDLE) != VK_SUCCESS) {
+            throw std::runtime_error("failed to submit compute command buffer!");
+        }
+    }
+    ++frameCounter;
+
+    if (settings.headless) {
+        return;
+    }
+
     VkPresentInfoKHR presentInfo{};
     presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
     presentInfo.waitSemaphoreCount = 1;
-    presentInfo.pWaitSemaphores = signalSemaphores;
+    presentInfo.pWaitSemaphores = &renderFinishedSemaphore;
     VkSwapchainKHR swapChains[] = {swapChain};
     presentInfo.swapchainCount = 1;
     presentInfo.pSwapchains = swapChains;
     presentInfo.pImageIndices = &imageIndex;
     presentInfo.pResults = nullptr;
 
-    vkQueuePresentKHR(presentQueue, &presentInfo);
+    vkd.vkQueuePresentKHR(presentQueue, &presentInfo);
 }
 
 
@@ -835,15 +1553,88 @@ VKAPI_ATTR VkBool32 VKAPI_CALL test::debugCallback(
 
 // --- Main loop --- //
 
-void test::mainLoop()
+void test::mainLoop(double seconds)
 {
-    while (!glfwWindowShouldClose(window))
+    using clock = std::chrono::steady_clock;
+    const auto start = clock::now();
+    auto remaining = [&]() {
+        return seconds - std::chrono::duration<double>(clock::now() - start).count();
+    };
+    while (!glfwWindowShouldClose(window) && (seconds <= 0.0 || remaining() > 0.0))
     {
-        glfwPollEvents();
-        drawFrame();
+        // 最小化或静止画面：不渲染，阻塞等待事件而不是空转
+        if (!canRender() || (settings.pacing.waitWhenIdle && !needsRedraw())) {
+            double timeout = settings.pacing.idleTimeout;
+            if (seconds > 0.0) {
+                timeout = std::max(0.0, std::min(timeout, remaining()));
+            }
+            pacer.idleWait();
+            glfwWaitEventsTimeout(timeout);
+            continue;
+        }
+        pacedFrame();
     }
 
-    vkDeviceWaitIdle(logicDevice);
+    vkd.vkDeviceWaitIdle(logicDevice);
+}
+
+void test::renderFrame()
+{
+    pacedFrame();
+}
+
+void test::pacedFrame()
+{
+    pacer.waitForFrameStart();
+    if (window != nullptr) {
+        glfwPollEvents();   // input sampled as late as the pacer allows
+        pacer.inputSampled();
+    }
+    if (!canRender()) {
+        return;
+    }
+    pacer.frameBegin();
+    drawFrame();
+    pacer.frameEnd();
+    if (redrawFrames > 0) {
+        --redrawFrames;
+    }
+}
+
+void test::requestRedraw()
+{
+    // computePost presents the previous frame's post result, the change shows up one frame later
+    redrawFrames = std::max<uint32_t>(redrawFrames, settings.computePost ? 2 : 1);
+}
+
+bool test::canRender()
+{
+    if (window == nullptr) {
+        return true;
+    }
+    if (glfwGetWindowAttrib(window, GLFW_ICONIFIED)) {
+        return false;
+    }
+    int width = 0, height = 0;
+    glfwGetFramebufferSize(window, &width, &height);
+    return width > 0 && height > 0;
+}
+
+// animated scenes and captures draw every frame
+bool test::needsRedraw() const
+{
+    return redrawFrames > 0 || sceneUpdate || frameCapture.enabled();
+}
+
+bool test::windowClosed()
+{
+    return window != nullptr && glfwWindowShouldClose(window);
+}
+
+void test::waitIdle()
+{
+    jobs.wait(scenePrepare);
+    vkd.vkDeviceWaitIdle(logicDevice);
 }
 
 void test::setupDebugMessenger()
@@ -853,7 +1644,7 @@ void test::setupDebugMessenger()
     VkDebugUtilsMessengerCreateInfoEXT createInfo;
     populateDebugMessengerCreateInfo(createInfo);
 
-    if (createDebugUtilsMessenger(instance, &createInfo, nullptr, &debugMessenger) != VK_SUCCESS)
+    if (createDebugUtilsMessenger(instance, &createInfo, hostAllocator.callbacks(), &debugMessenger) != VK_SUCCESS)
     {
         throw std::runtime_error("Failed to create debug utils messenger!");
     }
@@ -878,10 +1669,10 @@ void test::populateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT&
 VkResult test::createDebugUtilsMessenger(
     VkInstance c_instance, 
     VkDebugUtilsMessengerCreateInfoEXT* c_createInfo, 
-    VkAllocationCallbacks* c_allocation, 
+    const VkAllocationCallbacks* c_allocation, 
     VkDebugUtilsMessengerEXT* c_debugMessenger
 ) {
-    auto func = (PFN_vkCreateDebugUtilsMessengerEXT) vkGetInstanceProcAddr(c_instance, "vkCreateDebugUtilsMessengerEXT");
+    auto func = vkd.vkCreateDebugUtilsMessengerEXT;
     if (func == nullptr)
     {
         return VK_ERROR_EXTENSION_NOT_PRESENT;
@@ -893,8 +1684,10 @@ VkResult test::createDebugUtilsMessenger(
 
 void test::createSurface()
 {
+    if (settings.headless) return;
+
     //using GLFW surface
-    if (glfwCreateWindowSurface(instance, window, nullptr, &surface) != VK_SUCCESS) {
+    if (glfwCreateWindowSurface(instance, window, hostAllocator.callbacks(), &surface) != VK_SUCCESS) {
         throw std::runtime_error("Failed to Create Surface_KHR!");
     }
 }
@@ -902,41 +1695,83 @@ void test::createSurface()
 // --- Cleanup --- //
 void test::cleanupWindow()
 {
+    if (window == nullptr) return; // headless, glfw never initialized
     glfwDestroyWindow(window);
     glfwTerminate();
 }
 
 void test::cleanupVulkan()
 {
-    vkDestroySemaphore(logicDevice, imageAvaliableSemaphore, nullptr);
-    vkDestroySemaphore(logicDevice, renderFinishedSemaphore, nullptr);
-    vkDestroyFence(logicDevice, inFlightFence, nullptr);
+    // the prepare jobs reference the scene; runs from the destructor, a failed update is dropped here
+    try {
+        jobs.wait(scenePrepare);
+    } catch (const std::exception& e) {
+        std::cerr << "Scene prepare failed: " << e.what() << std::endl;
+    }
+    if (frameCapture.enabled()) {
+        vkd.vkDeviceWaitIdle(logicDevice);
+        frameCapture.shutdown();
+    }
+
+    vkd.vkDestroySemaphore(logicDevice, imageAvaliableSemaphore, hostAllocator.callbacks());
+    vkd.vkDestroySemaphore(logicDevice, renderFinishedSemaphore, hostAllocator.callbacks());
+    vkd.vkDestroyFence(logicDevice, inFlightFence, hostAllocator.callbacks());
+    if (timestampPool != VK_NULL_HANDLE) {
+        vkd.vkDestroyQueryPool(logicDevice, timestampPool, hostAllocator.callbacks());
+    }
+    pipelineStatistics.destroy();
+
+    mainPassCache.destroy();
+    vkd.vkDestroyCommandPool(logicDevice, commandPool, hostAllocator.callbacks());
 
-    vkDestroyCommandPool(logicDevice, commandPool, nullptr);
+    frameGraph.destroy(logicDevice);
+    if (settings.computePost) {
+        vkd.vkDeviceWaitIdle(logicDevice);
+        computePost.destroy();
+    }
+    if (settings.sceneCapacity > 0) {
+        vkd.vkDeviceWaitIdle(logicDevice);
+        instanceBuffers.destroy();
+    }
 
     for (auto framebuffer : swapChainFramebuffers) {
-        vkDestroyFramebuffer(logicDevice, framebuffer, nullptr);
+        vkd.vkDestroyFramebuffer(logicDevice, framebuffer, hostAllocator.callbacks());
     }
 
-    vkDestroyPipeline(logicDevice, graphicsPipeline, nullptr);
-    vkDestroyPipelineLayout(logicDevice, pipelineLayout, nullptr);
+    sceneVariants.destroy(logicDevice, hostAllocator.callbacks()); // owns graphicsPipelines
+    vkd.vkDestroyShaderModule(logicDevice, sceneVertModule, hostAllocator.callbacks());
+    vkd.vkDestroyShaderModule(logicDevice, sceneFragModule, hostAllocator.callbacks());
+    vkd.vkDestroyPipelineLayout(logicDevice, pipelineLayout, hostAllocator.callbacks());
 
-    vkDestroyRenderPass(logicDevice, renderPass, nullptr);
+    vkd.vkDestroyRenderPass(logicDevice, renderPass, hostAllocator.callbacks());
 
     for (auto imageView : imageViews) {
-        vkDestroyImageView(logicDevice, imageView, nullptr);
+        vkd.vkDestroyImageView(logicDevice, imageView, hostAllocator.callbacks());
     }
 
-    vkDestroySwapchainKHR(logicDevice, swapChain, nullptr);
-    vkDestroyDevice(logicDevice, nullptr);
+    if (settings.headless) {
+        for (size_t i = 0; i < swapChainImages.size(); ++i) {
+            vkd.vkDestroyImage(logicDevice, swapChainImages[i], hostAllocator.callbacks());
+            vkd.vkFreeMemory(logicDevice, offscreenMemory[i], hostAllocator.callbacks());
+        }
+    } else {
+        vkd.vkDestroySwapchainKHR(logicDevice, swapChain, hostAllocator.callbacks());
+    }
+    vkd.vkDestroyDevice(logicDevice, hostAllocator.callbacks());
 
     if (enabledValidationLayer)
     {
-        destoryDebugUtilsMessenger(instance, debugMessenger, nullptr);
+        destoryDebugUtilsMessenger(instance, debugMessenger, hostAllocator.callbacks());
+    }
+
+    if (!settings.headless) {
+        vkd.vkDestroySurfaceKHR(instance, surface, hostAllocator.callbacks());
     }
+    vkd.vkDestroyInstance(instance, hostAllocator.callbacks());
+    unloadVulkan();
 
-    vkDestroySurfaceKHR(instance, surface, nullptr);
-    vkDestroyInstance(instance, nullptr);
+    // every driver host allocation should be gone by now
+    hostAllocator.reportLeaks(std::cerr);
 }
 
 void test::cleanupAll()
@@ -2,15 +2,36 @@
 #include <sys/stat.h>
 #include <vector>
 #include <optional>
+#include <functional>
+#include <unordered_map>
 
 #define GLFW_INCLUDE_VULKAN // include Vulkan by include glfw with vulkan
 #include <glfw/glfw3.h>
 #include <glfw/glfw3native.h>
 
+#include "render_graph.hpp"
+#include "frame_capture.hpp"
+#include "host_allocator.hpp"
+#include "memory_budget.hpp"
+#include "compute_post.hpp"
+#include "scene_store.hpp"
+#include "instance_buffer.hpp"
+#include "job_system.hpp"
+#include "shader_variants.hpp"
+#include "pipeline_stats.hpp"
+#include "frame_pacer.hpp"
+#include "draw_queue.hpp"
+#include "command_cache.hpp"
+#include "asset_pack.hpp"
+
 const std::vector<const char*> deviceExtensions = {
     VK_KHR_SWAPCHAIN_EXTENSION_NAME
 }; // enumerate required Device Extensions
 
+const std::vector<const char*> optionalDeviceExtensions = {
+    VK_EXT_MEMORY_BUDGET_EXTENSION_NAME
+}; // enabled when the device supports them
+
 const int MAX_FRAMES_IN_FLIGHT = 2;
 
 #ifdef NDEBUG
@@ -31,10 +52,44 @@ struct windowInfo
     const std::string title;
 };
 
+// Options used by vulkan_bench scenarios, defaults reproduce the plain triangle window
+struct renderSettings
+{
+    bool headless = false;          // render into offscreen images, no window / surface / present
+    uint32_t offscreenImageCount = 3;
+    bool vsync = true;              // false: prefer IMMEDIATE / MAILBOX present mode
+    uint32_t drawCount = 1;         // vkCmdDraw calls per frame
+    uint32_t instanceCount = 1;     // instances per draw
+    uint32_t pipelineCount = 1;     // pipelines cycled between draws
+    bool gpuTiming = false;         // timestamp queries around the frame
+    std::string capturePath;        // non-empty : read every frame back into this file
+    bool captureY4M = false;        // Y4M (4:4:4) instead of raw BGRA
+    uint32_t captureDepth = 3;      // readback buffers in flight
+    bool computePost = false;       // tonemap + blur on the async compute queue, one frame of latency
+    uint32_t sceneCapacity = 0;     // > 0 : per frame instance buffers for up to this many scene objects
+    float sceneBoundsRadius = 1.f;  // bounding sphere of a scene object before its world scale, culling
+    int workerThreads = -1;         // job system workers, -1 : one per hardware thread minus the main thread
+    uint32_t statisticsGroups = 0;  // > 0 : pipeline statistics queries around this many groups of draws
+    bool overdraw = false;          // debug : additive overdraw heatmap instead of the scene colours
+    framePacing pacing;             // fps cap, idle waits and just-in-time input of the main loop
+    bool sortDraws = true;          // radix sort the draw packets by state before recording
+    bool commandCache = true;       // re-record the main pass only when its pipelines / target / draws change
+    std::string assetPack = "assets.pak";   // read before loose files, empty : loose files only
+    std::function<void(const char* step)> initStep; // called after each init step (null_bench)
+};
+
+// ns per vkCmd* call, recorded through the loader trampoline / the vkd table
+struct dispatchCost
+{
+    double trampolineNs = -1.0;     // < 0 : no link-time loader (RENDERER_DYNAMIC_LOADER)
+    double directNs = 0.0;
+};
+
 struct queueFamily
 {
     std::optional<uint32_t> graphicsQueueFamily;
     std::optional<uint32_t> presentQueueFamily;
+    std::optional<uint32_t> computeQueueFamily;   // dedicated (no graphics) family, if the device has one
     bool isComplete() {
         return graphicsQueueFamily.has_value() &&
                 presentQueueFamily.has_value();
@@ -51,30 +106,71 @@ class test
 {
 public:
     test();
-    test(windowInfo window_info);
+    test(windowInfo window_info, renderSettings render_settings = {});
     ~test();
 public:
-    void mainLoop();
+    void mainLoop(double seconds = 0.0);    // seconds > 0 : return after that long (vulkan_bench)
+    void renderFrame();             // one paced main loop iteration without idle waits, used by vulkan_bench
+    void requestRedraw();           // something visible changed, the idle main loop draws again
+    bool windowClosed();
+    void waitIdle();
+    double lastGpuFrameTime() const { return gpuFrameTime; } // ms, < 0 if unavailable
+    const std::string& deviceName() const { return physicalDeviceName; }
+    captureStats captureStatistics() { return frameCapture.stats(); }
+    // streaming / cache systems subscribe here to evict under VRAM pressure
+    MemoryBudgetMonitor& memoryMonitor() { return memoryBudget; }
+    // objects added here are uploaded to the instance buffers, only what changed each frame
+    SceneStore& scene() { return sceneStore; }
+    const instanceUploadStats& instanceUploads() const { return instanceBuffers.lastUpload(); }
+    // runs on the job system one frame ahead : called for frame N + 1 while frame N is recorded and submitted
+    void setSceneUpdate(std::function<void(SceneStore& scene, uint64_t frame)> update) { sceneUpdate = std::move(update); }
+    // the scene is culled against this in the prepare jobs (column-major, Vulkan clip space), unset : no culling
+    void setSceneView(const mat4& viewProj) { sceneView = viewProj; sceneViewSet = true; }
+    // dense instance indices inside the scene view for the frame being recorded
+    const std::vector<uint32_t>& visibleSceneInstances() const { return sceneVisible; }
+    JobSystem& jobSystem() { return jobs; }
+    // per draw group, previous frame; empty without statisticsGroups or device support
+    const std::vector<drawGroupStats>& drawStatistics() const { return pipelineStatistics.results(); }
+    const pacerStats& pacingStatistics() const { return pacer.stats(); }
+    // binds issued / skipped and sort time of the last recording of the main pass
+    const drawQueueStats& drawQueueStatistics() const { return drawQueue.stats(); }
+    // the main pass was recorded in the last frame, false when the command cache reused it (its binds are older)
+    bool mainPassRecorded() const { return mainPassRecordedThisFrame; }
+    // the draw list is rebuilt (and the cached passes re-recorded) on the next frame
+    void invalidateDrawList() { drawListDirty = true; }
+    uint64_t drawListVersion() const { return drawVersion; }
+    const commandCacheStats& commandCacheStatistics() const { return mainPassCache.stats(); }
+    // level loads batch their reads here : AssetPack::read(reads, count, &jobSystem())
+    AssetPack& assetPack() { return assets; }
+    // records `calls` bind / draw calls into a scratch command buffer (never submitted) both ways
+    dispatchCost measureDispatch(uint32_t calls);
 private:
     void initWindow();
+    void setWindowCallbacks();
+    bool canRender();               // false while minimized or the framebuffer is empty
+    bool needsRedraw() const;
+    void pacedFrame();
     void initVulkan();
+    void initStepDone(const char* step);
     bool checkValidationLayerSupport();
     void createInstance();
     void setupDebugMessenger();
     void populateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT& debugUtilsMessenger);
     VkResult createDebugUtilsMessenger(VkInstance c_instance, 
                                           VkDebugUtilsMessengerCreateInfoEXT* c_createInfo, 
-                                          VkAllocationCallbacks* c_allocation, 
+                                          const VkAllocationCallbacks* c_allocation, 
                                           VkDebugUtilsMessengerEXT* c_debugMessenger);
     void destoryDebugUtilsMessenger(VkInstance c_instance, 
                                        VkDebugUtilsMessengerEXT c_debugMessenger, 
-                                       VkAllocationCallbacks* c_allocation);
+                                       const VkAllocationCallbacks* c_allocation);
     void pickupPhysicalDevice();
     void createSurface();
     bool isDeviceSuitable(VkPhysicalDevice c_device);
     queueFamily findQueueFamilyIndex(VkPhysicalDevice c_device);
     void createLogicalDevice();
+    std::vector<const char*> requiredDeviceExtensions();
     bool checkDeviceExtensionSupported(VkPhysicalDevice c_device);
+    bool isDeviceExtensionAvailable(VkPhysicalDevice c_device, const char* extensionName);
     SwapChainDetails querySwapChainSupport(VkPhysicalDevice c_device);
     VkSurfaceCapabilitiesKHR GetSurfaceCap(VkPhysicalDevice c_device);
     std::vector<VkSurfaceFormatKHR> GetSurfaceFmt(VkPhysicalDevice c_device);
@@ -83,19 +179,36 @@ private:
     VkPresentModeKHR choosePresentMode(const SwapChainDetails& details);
     VkExtent2D chooseExtent2D(const SwapChainDetails& details);
     void createSwapChain();
+    void createOffscreenTargets();
+    uint32_t findMemoryType(uint32_t typeBits, VkMemoryPropertyFlags properties);
     void getSwapChainImages();
     void createImageViews();
     void createRenderPass();
     VkShaderModule createShaderModule(const std::vector<char>& code);
     void createGraphicsPipeline();
+    VkPipeline buildScenePipeline(const variantKey& key, const VkSpecializationInfo& specialization);
     void createFramebuffers();
+    void createFrameCapture();
+    void createComputePost();
+    void createInstanceBuffers();
+    void buildDrawQueue(DrawQueue& queue);
+    void recordMainPass(VkCommandBuffer commandBuffer);
+    void createCommandCache();
+    void startScenePrepare(uint64_t frame);
+    void cullScene(const frustum& planes);
+    void finishScenePrepare();
+    void createRenderGraph();
     void createCommandPool();
     void createCommandBuffer();
     void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex);
     void createSyncObjects();
+    void createTimestampQueries();
+    void createPipelineStatistics();
+    void collectGpuTiming();
     void drawFrame();
 private:
-    static std::vector<char> readFile(const std::string& filename);
+    std::vector<char> readFile(const std::string& filename);   // preloaded, the asset pack, else the loose file
+    void preloadAssets(const std::vector<const char*>& names);
 private:
     static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback(
         VkDebugUtilsMessageSeverityFlagBitsEXT messageServerity,
@@ -110,6 +223,9 @@ private:
     void cleanupVulkan();
 private:
     windowInfo w_info;
+    renderSettings settings;
+    JobSystem jobs;
+    HostAllocator hostAllocator;    // VkAllocationCallbacks for every vkCreate* / vkDestroy*
     GLFWwindow *window;
     VkInstance instance;
     VkDebugUtilsMessengerEXT debugMessenger;
@@ -119,20 +235,68 @@ private:
     VkSwapchainKHR swapChain;
     VkQueue graphicsQueue;
     VkQueue presentQueue;
+    VkQueue computeQueue;           // == graphicsQueue without a dedicated compute family
+    uint32_t computeQueueFamily;
     VkFormat swapChainImageFormat;
     VkExtent2D swapChainExtent;
     VkRenderPass renderPass;
     VkPipelineLayout pipelineLayout;
-    VkPipeline graphicsPipeline;
+    std::vector<VkPipeline> graphicsPipelines;     // owned by sceneVariants
+    VkShaderModule sceneVertModule;
+    VkShaderModule sceneFragModule;
+    ShaderVariants sceneVariants;
     VkCommandPool commandPool;
     VkCommandBuffer commandBuffer;
     VkSemaphore imageAvaliableSemaphore;
     VkSemaphore renderFinishedSemaphore;
     VkFence inFlightFence;
+    VkQueryPool timestampPool = VK_NULL_HANDLE;
+    float timestampPeriod = 1.f;
+    double gpuFrameTime = -1.0;
+    PipelineStatistics pipelineStatistics;
+    bool pipelineStatisticsSupported = false;
+    uint64_t frameCounter = 0;
+    std::string physicalDeviceName;
 private:
     std::vector<VkImage> swapChainImages;
     std::vector<VkImageView> imageViews;
-    std::vector<VkFramebuffer> swapChainFramebuffers;    
+    std::vector<VkFramebuffer> swapChainFramebuffers;    // per post slot when computePost
+    std::vector<VkDeviceMemory> offscreenMemory; // headless only
+private:
+    RenderGraph frameGraph;
+    RGResource backbuffer;
+    RGResource sceneColor;          // computePost only
+    ComputePost computePost;
+    compositeMode postComposite = compositeMode::Blit;  // chosen from the swap chain format
+    uint32_t postSlot = 0;
+    SceneStore sceneStore{MAX_FRAMES_IN_FLIGHT};
+    InstanceBuffers instanceBuffers;    // sceneCapacity > 0 only
+    std::function<void(SceneStore&, uint64_t)> sceneUpdate;
+    JobGraph scenePrepare;              // update, transforms, culling and draw list of the next frame
+    bool scenePrepareStarted = false;
+    mat4 sceneView{};
+    bool sceneViewSet = false;
+    bool sceneCullPrepared = false;
+    std::vector<float> cullRadius;      // prepare jobs : bounding spheres, visible indices and counts per chunk
+    std::vector<uint32_t> cullIndices;
+    std::vector<uint32_t> cullCounts;
+    std::vector<uint32_t> cullVisible;  // written by the prepare jobs, swapped in once they are done
+    std::vector<uint32_t> sceneVisible;
+    DrawQueue drawQueue;                // recorded this frame
+    DrawQueue preparedDrawQueue;        // built by the prepare jobs when dirty, every frame without the command cache
+    bool drawQueuePrepared = false;
+    bool drawListDirty = true;
+    uint64_t drawVersion = 0;
+    bool mainPassRecordedThisFrame = false;
+    CommandCache mainPassCache;         // one secondary buffer per framebuffer
+    FramePacer pacer;
+    AssetPack assets;                   // not open without the pack file
+    std::unordered_map<std::string, std::vector<char>> preloadedAssets;   // startup batch, taken by readFile
+    uint32_t redrawFrames = 2;          // frames still to draw before the loop goes idle
+    FrameCapture frameCapture;
+    MemoryBudgetMonitor memoryBudget;
+    bool memoryBudgetEnabled = false;
+    uint32_t currentImageIndex = 0;
 private:
     queueFamily q_Family;
 };
\ No newline at end of file
@@ -0,0 +1,82 @@
+#include "vk_dispatch.hpp"
+#include <stdexcept>
+
+#ifdef VK_NO_PROTOTYPES
+    #ifdef _WIN32
+        #include <windows.h>
+    #else
+        #include <dlfcn.h>
+    #endif
+#endif
+
+vulkanDispatch vkd{};
+
+namespace {
+
+#ifdef VK_NO_PROTOTYPES
+void* loaderLibrary = nullptr;
+
+PFN_vkGetInstanceProcAddr openLoader() {
+#ifdef _WIN32
+    HMODULE library = LoadLibraryA("vulkan-1.dll");
+    if (library == nullptr) return nullptr;
+    loaderLibrary = library;
+    return reinterpret_cast<PFN_vkGetInstanceProcAddr>(GetProcAddress(library, "vkGetInstanceProcAddr"));
+#else
+    void* library = dlopen("libvulkan.so.1", RTLD_NOW | RTLD_LOCAL);
+    if (library == nullptr) library = dlopen("libvulkan.so", RTLD_NOW | RTLD_LOCAL);
+    if (library == nullptr) return nullptr;
+    loaderLibrary = library;
+    return reinterpret_cast<PFN_vkGetInstanceProcAddr>(dlsym(library, "vkGetInstanceProcAddr"));
+#endif
+}
+#endif
+
+} // namespace
+
+void loadVulkanLoader() {
+#ifdef VK_NO_PROTOTYPES
+    if (vkd.vkGetInstanceProcAddr == nullptr) {
+        vkd.vkGetInstanceProcAddr = openLoader();
+    }
+#else
+    vkd.vkGetInstanceProcAddr = vkGetInstanceProcAddr;  // the linked loader
+#endif
+    if (vkd.vkGetInstanceProcAddr == nullptr) {
+        throw std::runtime_error("Vulkan loader not found!");
+    }
+#define VK_LOAD_GLOBAL(name) vkd.name = reinterpret_cast<PFN_##name>(vkd.vkGetInstanceProcAddr(VK_NULL_HANDLE, #name));
+    VK_GLOBAL_FUNCTIONS(VK_LOAD_GLOBAL)
+#undef VK_LOAD_GLOBAL
+}
+
+// extension functions the instance doesn't enable stay null
+void loadVulkanInstance(VkInstance instance) {
+#define VK_LOAD_INSTANCE(name) vkd.name = reinterpret_cast<PFN_##name>(vkd.vkGetInstanceProcAddr(instance, #name));
+    VK_INSTANCE_FUNCTIONS(VK_LOAD_INSTANCE)
+#undef VK_LOAD_INSTANCE
+}
+
+void loadVulkanDevice(VkDevice device) {
+#define VK_LOAD_DEVICE(name) vkd.name = reinterpret_cast<PFN_##name>(vkd.vkGetDeviceProcAddr(device, #name));
+    VK_DEVICE_FUNCTIONS(VK_LOAD_DEVICE)
+#undef VK_LOAD_DEVICE
+}
+
+void unloadVulkan() {
+    PFN_vkGetInstanceProcAddr getInstanceProcAddr = vkd.vkGetInstanceProcAddr;
+    vkd = {};
+#ifdef VK_NO_PROTOTYPES
+    if (loaderLibrary != nullptr) {
+    #ifdef _WIN32
+        FreeLibrary(static_cast<HMODULE>(loaderLibrary));
+    #else
+        dlclose(loaderLibrary);
+    #endif
+        loaderLibrary = nullptr;
+    }
+    (void)getInstanceProcAddr;
+#else
+    vkd.vkGetInstanceProcAddr = getInstanceProcAddr;    // linked, stays valid
+#endif
+}
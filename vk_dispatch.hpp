@@ -0,0 +1,131 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+/* Vulkan dispatch table.
+ * Every Vulkan call of the renderer goes through `vkd`. Device functions are
+ * loaded with vkGetDeviceProcAddr and point straight into the driver, which
+ * skips the loader's per-call trampoline. The lists below are the single
+ * source of truth : a function used by the renderer has to be listed here.
+ *
+ * Built with VK_NO_PROTOTYPES (CMake option RENDERER_DYNAMIC_LOADER), the
+ * loader is opened at runtime (libvulkan.so.1 / vulkan-1.dll) instead of
+ * being linked, only vkGetInstanceProcAddr is looked up in it.
+ */
+
+// before an instance exists
+#define VK_GLOBAL_FUNCTIONS(X) \
+    X(vkCreateInstance) \
+    X(vkEnumerateInstanceLayerProperties)
+
+#define VK_INSTANCE_FUNCTIONS(X) \
+    X(vkDestroyInstance) \
+    X(vkEnumeratePhysicalDevices) \
+    X(vkGetPhysicalDeviceProperties) \
+    X(vkGetPhysicalDeviceFeatures) \
+    X(vkGetPhysicalDeviceQueueFamilyProperties) \
+    X(vkGetPhysicalDeviceMemoryProperties) \
+    X(vkGetPhysicalDeviceMemoryProperties2) \
+    X(vkGetPhysicalDeviceFormatProperties) \
+    X(vkEnumerateDeviceExtensionProperties) \
+    X(vkCreateDevice) \
+    X(vkGetDeviceProcAddr) \
+    X(vkDestroySurfaceKHR) \
+    X(vkGetPhysicalDeviceSurfaceSupportKHR) \
+    X(vkGetPhysicalDeviceSurfaceCapabilitiesKHR) \
+    X(vkGetPhysicalDeviceSurfaceFormatsKHR) \
+    X(vkGetPhysicalDeviceSurfacePresentModesKHR) \
+    X(vkCreateDebugUtilsMessengerEXT) \
+    X(vkDestroyDebugUtilsMessengerEXT)
+
+#define VK_DEVICE_FUNCTIONS(X) \
+    X(vkDestroyDevice) \
+    X(vkGetDeviceQueue) \
+    X(vkDeviceWaitIdle) \
+    X(vkCreateSwapchainKHR) \
+    X(vkDestroySwapchainKHR) \
+    X(vkGetSwapchainImagesKHR) \
+    X(vkAcquireNextImageKHR) \
+    X(vkQueuePresentKHR) \
+    X(vkQueueSubmit) \
+    X(vkAllocateMemory) \
+    X(vkFreeMemory) \
+    X(vkMapMemory) \
+    X(vkUnmapMemory) \
+    X(vkInvalidateMappedMemoryRanges) \
+    X(vkCreateBuffer) \
+    X(vkDestroyBuffer) \
+    X(vkGetBufferMemoryRequirements) \
+    X(vkBindBufferMemory) \
+    X(vkCreateImage) \
+    X(vkDestroyImage) \
+    X(vkGetImageMemoryRequirements) \
+    X(vkBindImageMemory) \
+    X(vkCreateImageView) \
+    X(vkDestroyImageView) \
+    X(vkCreateShaderModule) \
+    X(vkDestroyShaderModule) \
+    X(vkCreatePipelineLayout) \
+    X(vkDestroyPipelineLayout) \
+    X(vkCreateGraphicsPipelines) \
+    X(vkCreateComputePipelines) \
+    X(vkDestroyPipeline) \
+    X(vkCreateRenderPass) \
+    X(vkDestroyRenderPass) \
+    X(vkCreateFramebuffer) \
+    X(vkDestroyFramebuffer) \
+    X(vkCreateDescriptorSetLayout) \
+    X(vkDestroyDescriptorSetLayout) \
+    X(vkCreateDescriptorPool) \
+    X(vkDestroyDescriptorPool) \
+    X(vkAllocateDescriptorSets) \
+    X(vkUpdateDescriptorSets) \
+    X(vkCreateCommandPool) \
+    X(vkDestroyCommandPool) \
+    X(vkAllocateCommandBuffers) \
+    X(vkFreeCommandBuffers) \
+    X(vkBeginCommandBuffer) \
+    X(vkEndCommandBuffer) \
+    X(vkResetCommandBuffer) \
+    X(vkCreateSemaphore) \
+    X(vkDestroySemaphore) \
+    X(vkCreateFence) \
+    X(vkDestroyFence) \
+    X(vkWaitForFences) \
+    X(vkResetFences) \
+    X(vkCreateQueryPool) \
+    X(vkDestroyQueryPool) \
+    X(vkGetQueryPoolResults) \
+    X(vkCmdBeginRenderPass) \
+    X(vkCmdEndRenderPass) \
+    X(vkCmdExecuteCommands) \
+    X(vkCmdBindPipeline) \
+    X(vkCmdBindDescriptorSets) \
+    X(vkCmdDraw) \
+    X(vkCmdDispatch) \
+    X(vkCmdPipelineBarrier) \
+    X(vkCmdCopyBuffer) \
+    X(vkCmdCopyImageToBuffer) \
+    X(vkCmdCopyImage) \
+    X(vkCmdBlitImage) \
+    X(vkCmdClearColorImage) \
+    X(vkCmdResetQueryPool) \
+    X(vkCmdBeginQuery) \
+    X(vkCmdEndQuery) \
+    X(vkCmdWriteTimestamp)
+
+struct vulkanDispatch
+{
+    PFN_vkGetInstanceProcAddr vkGetInstanceProcAddr = nullptr;
+#define VK_DISPATCH_MEMBER(name) PFN_##name name = nullptr;
+    VK_GLOBAL_FUNCTIONS(VK_DISPATCH_MEMBER)
+    VK_INSTANCE_FUNCTIONS(VK_DISPATCH_MEMBER)
+    VK_DEVICE_FUNCTIONS(VK_DISPATCH_MEMBER)
+#undef VK_DISPATCH_MEMBER
+};
+
+extern vulkanDispatch vkd;      // the renderer's instance / device, one at a time
+
+void loadVulkanLoader();                    // global functions; throws if the loader is missing
+void loadVulkanInstance(VkInstance instance);
+void loadVulkanDevice(VkDevice device);     // driver entry points, no trampolines
+void unloadVulkan();                        // after vkDestroyInstance